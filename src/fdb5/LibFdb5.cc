@@ -84,7 +84,7 @@ static unsigned getUserEnvRemoteProtocol() {
         LOG_DEBUG_LIB(LibFdb5) << "fdbRemoteProtocolVersion overidde to version: " << fdbRemoteProtocolVersion
                             << std::endl;
     }
-    return 0;  // no version override
+    return fdbRemoteProtocolVersion;
 }
 
 static bool getUserEnvSkipSanityCheck() {
@@ -113,11 +113,11 @@ RemoteProtocolVersion::RemoteProtocolVersion() {
 }
 
 unsigned int RemoteProtocolVersion::latest() const {
-    return 3;
+    return 4;
 }
 
 unsigned int RemoteProtocolVersion::defaulted() const {
-    return 3;
+    return 4;
 }
 
 unsigned int RemoteProtocolVersion::used() const {
@@ -125,7 +125,8 @@ unsigned int RemoteProtocolVersion::used() const {
 }
 
 std::vector<unsigned int> RemoteProtocolVersion::supported() const {
-    std::vector<unsigned int> versions = {3};
+    // 4: TocFieldLocation carries the field checksum, compression and block size
+    std::vector<unsigned int> versions = {3, 4};
     return versions;
 }
 
@@ -154,6 +155,22 @@ bool RemoteProtocolVersion::check(unsigned int version, bool throwOnFail) {
     return false;
 }
 
+namespace {
+thread_local unsigned int streamedVersion = 0;  //< 0 unless set by a RemoteProtocolVersion::Streamed
+}
+
+unsigned int RemoteProtocolVersion::streamed() {
+    return streamedVersion ? streamedVersion : LibFdb5::instance().remoteProtocolVersion().used();
+}
+
+RemoteProtocolVersion::Streamed::Streamed(unsigned int version) : previous_(streamedVersion) {
+    streamedVersion = version;
+}
+
+RemoteProtocolVersion::Streamed::~Streamed() {
+    streamedVersion = previous_;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace fdb5
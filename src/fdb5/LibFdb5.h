@@ -55,6 +55,20 @@ public:
     /// Checks the serialisation version is supported by the software
     bool check(unsigned int version, bool throwOnFail = true);
 
+    /// The serialisation version the calling thread streams objects with, to and from its remote peer
+    /// This is used(), unless set by a Streamed on a server thread serving a client of another version
+    static unsigned int streamed();
+
+    /// Sets the serialisation version the calling thread streams objects with, for its lifetime
+    class Streamed {
+    public:
+        explicit Streamed(unsigned int version);
+        ~Streamed();
+
+    private:
+        unsigned int previous_;
+    };
+
 private:
     unsigned int used_; //< version to be used for remote protocol
 };
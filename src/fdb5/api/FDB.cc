@@ -13,6 +13,10 @@
  * (Project ID: 671951) www.nextgenio.eu
  */
 
+#include <memory>
+#include <queue>
+#include <vector>
+
 #include "eckit/config/Resource.h"
 #include "eckit/io/DataHandle.h"
 #include "eckit/io/MemoryHandle.h"
@@ -28,6 +32,7 @@
 #include "fdb5/api/helpers/FDBToolRequest.h"
 #include "fdb5/database/Key.h"
 #include "fdb5/io/HandleGatherer.h"
+#include "fdb5/io/StreamingRetrieveHandle.h"
 #include "fdb5/message/MessageDecoder.h"
 #include "fdb5/types/Type.h"
 
@@ -97,9 +102,7 @@ void FDB::archive(const metkit::mars::MarsRequest& request, eckit::DataHandle& h
     }
 }
 
-void FDB::archive(const Key& key, const void* data, size_t length) {
-    eckit::Timer timer;
-    timer.start();
+Key FDB::internalKey(const Key& key) const {
 
     // This is the API entrypoint. Keys supplied by the user may not have type registry info attached (so
     // serialisation won't work properly...)
@@ -118,13 +121,40 @@ void FDB::archive(const Key& key, const void* data, size_t length) {
         keyInternal.unset("stepunits");
     }
 
-    internal_->archive(keyInternal, data, length);
+    return keyInternal;
+}
+
+void FDB::archive(const Key& key, const void* data, size_t length) {
+    eckit::Timer timer;
+    timer.start();
+
+    internal_->archive(internalKey(key), data, length);
     dirty_ = true;
 
     timer.stop();
     stats_.addArchive(length, timer);
 }
 
+void FDB::archive(const std::vector<ArchiveItem>& items) {
+    eckit::Timer timer;
+    timer.start();
+
+    std::vector<ArchiveItem> internalItems;
+    internalItems.reserve(items.size());
+
+    size_t length = 0;
+    for (const ArchiveItem& item : items) {
+        internalItems.emplace_back(internalKey(item.key_), item.data_, item.length_);
+        length += item.length_;
+    }
+
+    internal_->archive(internalItems);
+    dirty_ = true;
+
+    timer.stop();
+    stats_.addArchive(length, timer, items.size());
+}
+
 bool FDB::sorted(const metkit::mars::MarsRequest &request) {
 
     bool sorted = false;
@@ -158,7 +188,7 @@ eckit::DataHandle* FDB::read(const std::vector<eckit::URI>& uris, bool sorted) {
 
     for (const eckit::URI& uri : uris) {
         FieldLocation* loc = FieldLocationFactory::instance().build(uri.scheme(), uri);
-        result.add(loc->dataHandle());
+        result.add(*loc);
         delete loc;
     }
     return result.dataHandle();
@@ -169,10 +199,17 @@ eckit::DataHandle* FDB::read(ListIterator& it, bool sorted) {
     eckit::Timer timer;
     timer.start();
 
+    static bool dedup = eckit::Resource<bool>("fdbDeduplicate;$FDB_DEDUPLICATE_FIELDS", false);
+
+    // Stream the fields in bounded windows rather than gathering them all before the first byte is read
+    static size_t window = eckit::Resource<size_t>("fdbRetrieveWindow;$FDB_RETRIEVE_WINDOW", 0);
+    if (window > 0) {
+        return new StreamingRetrieveHandle(std::move(it), sorted, window, dedup);
+    }
+
     HandleGatherer result(sorted);
     ListElement el;
 
-    static bool dedup = eckit::Resource<bool>("fdbDeduplicate;$FDB_DEDUPLICATE_FIELDS", false);
     if (dedup) {
         if (it.next(el)) {
             // build the request representing the tensor-product of all retrieved fields
@@ -203,17 +240,20 @@ eckit::DataHandle* FDB::read(ListIterator& it, bool sorted) {
             for (size_t i=0; i< cube.size(); i++) {
                 ListElement element;
                 if (cube.find(i, element)) {
-                    result.add(element.location().dataHandle());
+                    result.add(element.location());
                 }
             }
         }
     }
     else {
         while (it.next(el)) {
-            result.add(el.location().dataHandle());
+            result.add(el.location());
         }
     }
-    return result.dataHandle();
+
+    eckit::DataHandle* dh = result.dataHandle();
+    stats_.addReadPlan(result.plan());
+    return dh;
 }
 
 eckit::DataHandle* FDB::retrieve(const metkit::mars::MarsRequest& request) {
@@ -221,10 +261,48 @@ eckit::DataHandle* FDB::retrieve(const metkit::mars::MarsRequest& request) {
     return read(it, sorted(request));
 }
 
+eckit::DataHandle* FDB::retrieve(const std::vector<metkit::mars::MarsRequest>& requests) {
+
+    std::vector<ListIterator> iterators = inspect(requests);
+
+    // Fields are only reordered if every request allows it
+    bool sortAll = !requests.empty();
+    std::queue<APIIterator<ListElement>> lists;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        sortAll = sortAll && sorted(requests[i]);
+        lists.push(std::move(iterators[i]));
+    }
+
+    ListIterator it(new ListAggregateIterator(std::move(lists)));
+    return read(it, sortAll);
+}
+
+std::vector<eckit::DataHandle*> FDB::retrieveEach(const std::vector<metkit::mars::MarsRequest>& requests) {
+
+    std::vector<ListIterator> iterators = inspect(requests);
+
+    std::vector<std::unique_ptr<eckit::DataHandle>> handles;
+    handles.reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        handles.emplace_back(read(iterators[i], sorted(requests[i])));
+    }
+
+    std::vector<eckit::DataHandle*> result;
+    result.reserve(handles.size());
+    for (auto& h : handles) {
+        result.push_back(h.release());
+    }
+    return result;
+}
+
 ListIterator FDB::inspect(const metkit::mars::MarsRequest& request) {
     return internal_->inspect(request);
 }
 
+std::vector<ListIterator> FDB::inspect(const std::vector<metkit::mars::MarsRequest>& requests) {
+    return internal_->inspect(requests);
+}
+
 ListIterator FDB::list(const FDBToolRequest& request, bool deduplicate) {
     return ListIterator(internal_->list(request), deduplicate);
 }
@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <iosfwd>
+#include <vector>
 
 #include "eckit/distributed/Transport.h"
 
@@ -34,6 +35,7 @@
 #include "fdb5/api/helpers/WipeIterator.h"
 #include "fdb5/api/helpers/MoveIterator.h"
 #include "fdb5/config/Config.h"
+#include "fdb5/database/ArchiveItem.h"
 
 namespace eckit {
 namespace message {
@@ -76,6 +78,8 @@ public: // methods
     void archive(const metkit::mars::MarsRequest& request, eckit::DataHandle& handle);
     // disclaimer: this is a low-level API. The provided key and the corresponding data are not checked for consistency
     void archive(const Key& key, const void* data, size_t length);
+    /// Archives a batch of fields, routed and written together. The same disclaimer as above applies
+    void archive(const std::vector<ArchiveItem>& items);
 
     /// Flushes all buffers and closes all data handles into a consistent DB state
     /// @note always safe to call
@@ -89,8 +93,17 @@ public: // methods
 
     eckit::DataHandle* retrieve(const metkit::mars::MarsRequest& request);
 
+    /// Retrieves several requests, planned together so that databases and indexes are selected once for
+    /// the batch, into one handle delivering the fields of each request in turn
+    eckit::DataHandle* retrieve(const std::vector<metkit::mars::MarsRequest>& requests);
+
+    /// As retrieve(requests), but with one handle per request. The caller owns the handles.
+    std::vector<eckit::DataHandle*> retrieveEach(const std::vector<metkit::mars::MarsRequest>& requests);
+
     ListIterator inspect(const metkit::mars::MarsRequest& request);
 
+    std::vector<ListIterator> inspect(const std::vector<metkit::mars::MarsRequest>& requests);
+
     ListIterator list(const FDBToolRequest& request, bool deduplicate=false);
 
     DumpIterator dump(const FDBToolRequest& request, bool simple=false);
@@ -141,6 +154,9 @@ private: // methods
 
     bool sorted(const metkit::mars::MarsRequest &request);
 
+    /// Attaches the type registry to a key supplied by the user, and folds in its stepunits
+    Key internalKey(const Key& key) const;
+
 private: // members
 
     std::unique_ptr<FDBBase> internal_;
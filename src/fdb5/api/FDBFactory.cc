@@ -62,6 +62,21 @@ std::string FDBBase::id() const {
     return ss.str();
 }
 
+void FDBBase::archive(const std::vector<ArchiveItem>& items) {
+    for (const ArchiveItem& item : items) {
+        archive(item.key_, item.data_, item.length_);
+    }
+}
+
+std::vector<ListIterator> FDBBase::inspect(const std::vector<metkit::mars::MarsRequest>& requests) {
+    std::vector<ListIterator> result;
+    result.reserve(requests.size());
+    for (const metkit::mars::MarsRequest& request : requests) {
+        result.emplace_back(inspect(request));
+    }
+    return result;
+}
+
 FDBStats FDBBase::stats() const {
     /// By default we have no additional internal statistics
     return FDBStats();
@@ -20,6 +20,7 @@
 #define fdb5_api_FDBFactory_H
 
 #include <memory>
+#include <vector>
 
 #include "eckit/distributed/Transport.h"
 #include "eckit/utils/Regex.h"
@@ -66,10 +67,16 @@ public: // methods
 
     virtual void archive(const Key& key, const void* data, size_t length) = 0;
 
+    /// Archives a batch of fields. By default they are archived one after the other.
+    virtual void archive(const std::vector<ArchiveItem>& items);
+
     virtual void flush() = 0;
 
     virtual ListIterator inspect(const metkit::mars::MarsRequest& request) = 0;
 
+    /// Inspects several requests at once. By default they are inspected one after the other.
+    virtual std::vector<ListIterator> inspect(const std::vector<metkit::mars::MarsRequest>& requests);
+
     virtual ListIterator list(const FDBToolRequest& request) = 0;
 
     virtual DumpIterator dump(const FDBToolRequest& request, bool simple) = 0;
@@ -40,7 +40,20 @@ FDBStats::FDBStats() :
     elapsedRetrieve_(0),
     sumArchiveTimingSquared_(0),
     sumRetrieveTimingSquared_(0),
-    sumFlushTimingSquared_(0) {}
+    sumFlushTimingSquared_(0),
+    numReadCacheHits_(0),
+    numReadCacheMisses_(0),
+    numReadCacheEvictions_(0),
+    bytesReadCache_(0),
+    numCatalogueCacheHits_(0),
+    numCatalogueCacheMisses_(0),
+    numCatalogueCacheStale_(0),
+    numCatalogueCacheEvictions_(0),
+    numReadsRequestOrdered_(0),
+    numReadsSortedMerged_(0),
+    numReadsParallelStriped_(0),
+    numDuplicatesSkipped_(0),
+    bytesDuplicatesSkipped_(0) {}
 
 
 FDBStats::~FDBStats() {}
@@ -60,6 +73,19 @@ FDBStats& FDBStats::operator+=(const FDBStats& rhs) {
     sumArchiveTimingSquared_ += rhs.sumArchiveTimingSquared_;
     sumRetrieveTimingSquared_ += rhs.sumRetrieveTimingSquared_;
     sumFlushTimingSquared_ += rhs.sumFlushTimingSquared_;
+    numReadCacheHits_ += rhs.numReadCacheHits_;
+    numReadCacheMisses_ += rhs.numReadCacheMisses_;
+    numReadCacheEvictions_ += rhs.numReadCacheEvictions_;
+    bytesReadCache_ += rhs.bytesReadCache_;
+    numCatalogueCacheHits_ += rhs.numCatalogueCacheHits_;
+    numCatalogueCacheMisses_ += rhs.numCatalogueCacheMisses_;
+    numCatalogueCacheStale_ += rhs.numCatalogueCacheStale_;
+    numCatalogueCacheEvictions_ += rhs.numCatalogueCacheEvictions_;
+    numReadsRequestOrdered_ += rhs.numReadsRequestOrdered_;
+    numReadsSortedMerged_ += rhs.numReadsSortedMerged_;
+    numReadsParallelStriped_ += rhs.numReadsParallelStriped_;
+    numDuplicatesSkipped_ += rhs.numDuplicatesSkipped_;
+    bytesDuplicatesSkipped_ += rhs.bytesDuplicatesSkipped_;
     return *this;
 }
 
@@ -115,6 +141,43 @@ void FDBStats::addFlush(eckit::Timer& timer) {
 }
 
 
+void FDBStats::addReadCache(size_t hits, size_t misses, size_t evictions, size_t bytesRead) {
+    numReadCacheHits_ += hits;
+    numReadCacheMisses_ += misses;
+    numReadCacheEvictions_ += evictions;
+    bytesReadCache_ += bytesRead;
+}
+
+
+void FDBStats::addCatalogueCache(size_t hits, size_t misses, size_t stale, size_t evictions) {
+    numCatalogueCacheHits_ += hits;
+    numCatalogueCacheMisses_ += misses;
+    numCatalogueCacheStale_ += stale;
+    numCatalogueCacheEvictions_ += evictions;
+}
+
+
+void FDBStats::addDuplicates(size_t fields, size_t bytes) {
+    numDuplicatesSkipped_ += fields;
+    bytesDuplicatesSkipped_ += bytes;
+}
+
+
+void FDBStats::addReadPlan(const ReadPlanner::Decision& plan) {
+    switch (plan.plan_) {
+        case ReadPlanner::REQUEST_ORDERED:
+            numReadsRequestOrdered_++;
+            break;
+        case ReadPlanner::SORTED_MERGED:
+            numReadsSortedMerged_++;
+            break;
+        case ReadPlanner::PARALLEL_STRIPED:
+            numReadsParallelStriped_++;
+            break;
+    }
+}
+
+
 void FDBStats::report(std::ostream& out, const char* prefix) const {
 
     // Archive statistics
@@ -124,6 +187,11 @@ void FDBStats::report(std::ostream& out, const char* prefix) const {
     reportTimeStats(out, "archive time", numArchive_, elapsedArchive_, sumArchiveTimingSquared_, prefix);
     reportRate(out, "archive rate", bytesArchive_, elapsedArchive_, prefix);
 
+    if (numDuplicatesSkipped_) {
+        reportCount(out, "duplicates skipped", numDuplicatesSkipped_, prefix);
+        reportBytes(out, "bytes of duplicates skipped", bytesDuplicatesSkipped_, prefix);
+    }
+
     // Retrieve statistics
 
     reportCount(out, "num retrieve", numRetrieve_, prefix);
@@ -135,6 +203,32 @@ void FDBStats::report(std::ostream& out, const char* prefix) const {
 
     reportCount(out, "num flush", numFlush_, prefix);
     reportTimeStats(out, "flush time", numFlush_, elapsedFlush_, sumFlushTimingSquared_, prefix);
+
+    // Read plans
+
+    if (numReadsRequestOrdered_ || numReadsSortedMerged_ || numReadsParallelStriped_) {
+        reportCount(out, "reads request-ordered", numReadsRequestOrdered_, prefix);
+        reportCount(out, "reads sorted-merged", numReadsSortedMerged_, prefix);
+        reportCount(out, "reads parallel-striped", numReadsParallelStriped_, prefix);
+    }
+
+    // Read cache statistics
+
+    if (numReadCacheHits_ || numReadCacheMisses_) {
+        reportCount(out, "read cache hits", numReadCacheHits_, prefix);
+        reportCount(out, "read cache misses", numReadCacheMisses_, prefix);
+        reportCount(out, "read cache evictions", numReadCacheEvictions_, prefix);
+        reportBytes(out, "read cache bytes read", bytesReadCache_, prefix);
+    }
+
+    // Catalogue cache statistics
+
+    if (numCatalogueCacheHits_ || numCatalogueCacheMisses_) {
+        reportCount(out, "catalogue cache hits", numCatalogueCacheHits_, prefix);
+        reportCount(out, "catalogue cache misses", numCatalogueCacheMisses_, prefix);
+        reportCount(out, "catalogue cache stale", numCatalogueCacheStale_, prefix);
+        reportCount(out, "catalogue cache evictions", numCatalogueCacheEvictions_, prefix);
+    }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -24,6 +24,8 @@
 
 #include "eckit/log/Statistics.h"
 
+#include "fdb5/io/ReadPlanner.h"
+
 
 namespace fdb5 {
 
@@ -37,10 +39,16 @@ public:
 
     size_t numArchive() const { return numArchive_; }
     size_t numFlush() const { return numFlush_; }
+    size_t numDuplicatesSkipped() const { return numDuplicatesSkipped_; }
+    size_t bytesDuplicatesSkipped() const { return bytesDuplicatesSkipped_; }
 
     void addArchive(size_t length, eckit::Timer& timer, size_t nfields=1);
     void addRetrieve(size_t length, eckit::Timer& timer);
     void addFlush(eckit::Timer& timer);
+    void addReadCache(size_t hits, size_t misses, size_t evictions, size_t bytesRead);
+    void addCatalogueCache(size_t hits, size_t misses, size_t stale, size_t evictions);
+    void addReadPlan(const ReadPlanner::Decision& plan);
+    void addDuplicates(size_t fields, size_t bytes);
 
     void report(std::ostream& out, const char* indent) const;
 
@@ -65,6 +73,23 @@ private: // members
     double sumArchiveTimingSquared_;
     double sumRetrieveTimingSquared_;
     double sumFlushTimingSquared_;
+
+    size_t numReadCacheHits_;
+    size_t numReadCacheMisses_;
+    size_t numReadCacheEvictions_;
+    size_t bytesReadCache_;
+
+    size_t numCatalogueCacheHits_;
+    size_t numCatalogueCacheMisses_;
+    size_t numCatalogueCacheStale_;
+    size_t numCatalogueCacheEvictions_;
+
+    size_t numReadsRequestOrdered_;
+    size_t numReadsSortedMerged_;
+    size_t numReadsParallelStriped_;
+
+    size_t numDuplicatesSkipped_;
+    size_t bytesDuplicatesSkipped_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
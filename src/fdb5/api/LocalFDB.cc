@@ -21,11 +21,13 @@
 #include "fdb5/api/helpers/FDBToolRequest.h"
 #include "fdb5/api/LocalFDB.h"
 #include "fdb5/database/Archiver.h"
+#include "fdb5/database/CatalogueCache.h"
 #include "fdb5/database/DB.h"
 #include "fdb5/database/EntryVisitMechanism.h"
 #include "fdb5/database/Index.h"
 #include "fdb5/database/Inspector.h"
 #include "fdb5/database/Key.h"
+#include "fdb5/io/BlockCache.h"
 #include "fdb5/rules/Schema.h"
 #include "fdb5/LibFdb5.h"
 
@@ -46,14 +48,22 @@ using namespace eckit;
 
 
 namespace fdb5 {
-void LocalFDB::archive(const Key& key, const void* data, size_t length) {
+Archiver& LocalFDB::archiver() {
 
     if (!archiver_) {
         LOG_DEBUG_LIB(LibFdb5) << *this << ": Constructing new archiver" << std::endl;
         archiver_.reset(new Archiver(config_));
     }
 
-    archiver_->archive(key, data, length);
+    return *archiver_;
+}
+
+void LocalFDB::archive(const Key& key, const void* data, size_t length) {
+    archiver().archive(key, data, length);
+}
+
+void LocalFDB::archive(const std::vector<ArchiveItem>& items) {
+    archiver().archive(items);
 }
 
 ListIterator LocalFDB::inspect(const metkit::mars::MarsRequest &request) {
@@ -66,6 +76,16 @@ ListIterator LocalFDB::inspect(const metkit::mars::MarsRequest &request) {
     return inspector_->inspect(request);
 }
 
+std::vector<ListIterator> LocalFDB::inspect(const std::vector<metkit::mars::MarsRequest>& requests) {
+
+    if (!inspector_) {
+        LOG_DEBUG_LIB(LibFdb5) << *this << ": Constructing new retriever" << std::endl;
+        inspector_.reset(new Inspector(config_));
+    }
+
+    return inspector_->inspect(requests);
+}
+
 template<typename VisitorType, typename ... Ts>
 APIIterator<typename VisitorType::ValueType> LocalFDB::queryInternal(const FDBToolRequest& request, Ts ... args) {
 
@@ -129,9 +149,33 @@ AxesIterator LocalFDB::axes(const FDBToolRequest& request, int level) {
     return queryInternal<AxesVisitor>(request, config_, level);
 }
 
+FDBStats LocalFDB::stats() const {
+    FDBStats result;
+    if (BlockCache::instance().enabled()) {
+        BlockCache::Statistics s = BlockCache::instance().takeStatistics();
+        result.addReadCache(s.hits_, s.misses_, s.evictions_, s.bytesRead_);
+    }
+    if (CatalogueCache::instance().enabled()) {
+        CatalogueCache::Statistics s = CatalogueCache::instance().takeStatistics();
+        result.addCatalogueCache(s.hits_, s.misses_, s.stale_, s.evictions_);
+    }
+    if (archiver_) {
+        size_t fields;
+        size_t bytes;
+        archiver_->duplicates(fields, bytes);
+        result.addDuplicates(fields, bytes);
+    }
+    return result;
+}
+
+
 void LocalFDB::flush() {
     if (archiver_) {
         archiver_->flush();
+        // Databases may have been created by this archival
+        if (inspector_) {
+            inspector_->forgetMissingDatabases();
+        }
     }
 }
 
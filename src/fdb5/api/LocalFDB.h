@@ -35,12 +35,16 @@ class LocalFDB : public FDBBase {
 public: // methods
 
     using FDBBase::FDBBase;
-    using FDBBase::stats;
+    FDBStats stats() const override;
 
     void archive(const Key& key, const void* data, size_t length) override;
 
+    void archive(const std::vector<ArchiveItem>& items) override;
+
     ListIterator inspect(const metkit::mars::MarsRequest& request) override;
 
+    std::vector<ListIterator> inspect(const std::vector<metkit::mars::MarsRequest>& requests) override;
+
     ListIterator list(const FDBToolRequest& request) override;
 
     DumpIterator dump(const FDBToolRequest& request, bool simple) override;
@@ -67,6 +71,8 @@ private: // methods
 
     void print(std::ostream& s) const override;
 
+    Archiver& archiver();
+
     template <typename VisitorType, typename ... Ts>
     APIIterator<typename VisitorType::ValueType> queryInternal(const FDBToolRequest& request, Ts ... args);
 
@@ -215,7 +215,7 @@ bool SelectFDB::matches(const Key &key, const SelectMap &select, bool requireMis
         const std::string& k(kv.first);
         const eckit::Regex& re(kv.second);
 
-        eckit::StringDict::const_iterator i = key.find(k);
+        Key::const_iterator i = key.find(k);
         if (i == key.end()) {
             if (requireMissing) return false;
         } else if (!re.match(i->second)) {
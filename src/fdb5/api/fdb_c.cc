@@ -170,7 +170,9 @@ struct fdb_datareader_t {
 public:
     long open() {
         ASSERT(dh_);
-        return dh_->openForRead();
+        long size = dh_->openForRead();
+        // A handle that cannot know its length before it is read reports it as negative
+        return size < 0 ? -1 : size;
     }
     void close() {
         ASSERT(dh_);
@@ -355,6 +357,25 @@ int fdb_archive_multiple(fdb_handle_t* fdb, fdb_request_t* req, const char* data
     });
 }
 
+int fdb_archive_batch(fdb_handle_t* fdb, fdb_key_t** keys, const char** data, const size_t* lengths, size_t count) {
+    return wrapApiFunction([fdb, keys, data, lengths, count] {
+        ASSERT(fdb);
+        ASSERT(keys);
+        ASSERT(data);
+        ASSERT(lengths);
+
+        std::vector<ArchiveItem> items;
+        items.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT(keys[i]);
+            ASSERT(data[i]);
+            items.emplace_back(*keys[i], data[i], lengths[i]);
+        }
+
+        fdb->archive(items);
+    });
+}
+
 int fdb_list(fdb_handle_t* fdb, const fdb_request_t* req, fdb_listiterator_t** it, bool duplicates) {
     return wrapApiFunction([fdb, req, it, duplicates] {
         ASSERT(fdb);
@@ -376,6 +397,20 @@ int fdb_retrieve(fdb_handle_t* fdb, fdb_request_t* req, fdb_datareader_t* dr) {
         dr->set(fdb->retrieve(req->request()));
     });
 }
+int fdb_retrieve_multiple(fdb_handle_t* fdb, fdb_request_t** reqs, size_t count, fdb_datareader_t* dr) {
+    return wrapApiFunction([fdb, reqs, count, dr] {
+        ASSERT(fdb);
+        ASSERT(reqs || count == 0);
+        ASSERT(dr);
+        std::vector<metkit::mars::MarsRequest> requests;
+        requests.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT(reqs[i]);
+            requests.push_back(reqs[i]->request());
+        }
+        dr->set(fdb->retrieve(requests));
+    });
+}
 int fdb_flush(fdb_handle_t* fdb) {
     return wrapApiFunction([fdb] {
         ASSERT(fdb);
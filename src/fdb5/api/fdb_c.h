@@ -247,7 +247,8 @@ int fdb_new_datareader(fdb_datareader_t** dr);
 
 /** Open a DataReader for data reading.
  * \param dr DataReader instance
- * \param size size of the opened DataReader
+ * \param size size of the opened DataReader, or -1 if it is not known until all the data has been read
+ * (when the retrieved fields are streamed, see fdbRetrieveWindow)
  * \returns Return code (#FdbErrorValues)
  */
 int fdb_datareader_open(fdb_datareader_t* dr, long* size);
@@ -329,6 +330,17 @@ int fdb_archive(fdb_handle_t* fdb, fdb_key_t* key, const char* data, size_t leng
  */
 int fdb_archive_multiple(fdb_handle_t* fdb, fdb_request_t* req, const char* data, size_t length);
 
+/** Archives a batch of fields to a FDB instance, routed and written together.
+ * \warning this is a low-level API. The provided keys and the corresponding data are not checked for consistency
+ * \param fdb FDB instance.
+ * \param keys Array of Keys used for indexing and archiving the data
+ * \param data Array of pointers to the binary data to archive with the corresponding #keys
+ * \param lengths Array of sizes of the data to archive with the corresponding #keys
+ * \param count Number of fields in #keys, #data and #lengths
+ * \returns Return code (#FdbErrorValues)
+ */
+int fdb_archive_batch(fdb_handle_t* fdb, fdb_key_t** keys, const char** data, const size_t* lengths, size_t count);
+
 /** List all available data whose metadata matches a given user request.
  * \param fdb FDB instance.
  * \param req User Request
@@ -346,6 +358,15 @@ int fdb_list(fdb_handle_t* fdb, const fdb_request_t* req, fdb_listiterator_t** i
  */
 int fdb_retrieve(fdb_handle_t* fdb, fdb_request_t* req, fdb_datareader_t* dr);
 
+/** Return all available data matching any of several user requests, planned together so that databases and indexes are selected once for the batch.
+ * \param fdb FDB instance.
+ * \param reqs Array of user Requests
+ * \param count Number of Requests in #reqs
+ * \param dr DataReader than can be used to read the extracted data, request after request
+ * \returns Return code (#FdbErrorValues)
+ */
+int fdb_retrieve_multiple(fdb_handle_t* fdb, fdb_request_t** reqs, size_t count, fdb_datareader_t* dr);
+
 /** Force flushing of all write operations
  * \param key FDB instance
  * \returns Return code (#FdbErrorValues)
@@ -0,0 +1,50 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ArchiveItem.h
+/// @date   Oct 2026
+
+#ifndef fdb5_ArchiveItem_H
+#define fdb5_ArchiveItem_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "fdb5/database/Key.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A field archived as part of a batch. The data are not copied, and must stay valid until the archive call returns
+
+struct ArchiveItem {
+
+    ArchiveItem(const Key& key, const void* data, size_t length) :
+        key_(key), data_(data), length_(length), hasChecksum_(false), checksum_(0) {}
+
+    /// Records the CRC-32C of the data, once computed, so that the store need not compute it again
+    void checksum(uint32_t crc) {
+        checksum_    = crc;
+        hasChecksum_ = true;
+    }
+
+    Key key_;
+    const void* data_;
+    size_t length_;
+    bool hasChecksum_;
+    uint32_t checksum_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/database/ArchiveWorker.h"
+
+#include <algorithm>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+
+#include "fdb5/database/DB.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ArchiveWorker::ArchiveWorker(size_t queueLength) :
+    queueLength_(std::max(queueLength, size_t(1))),
+    busy_(false),
+    stop_(false),
+    db_(nullptr),
+    thread_([this] { run(); }) {}
+
+ArchiveWorker::~ArchiveWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+
+    if (error_) {
+        eckit::Log::error() << "ArchiveWorker stopped with an unreported error" << std::endl;
+    }
+}
+
+void ArchiveWorker::archive(DB& db, const Key& index, const Key& datum, const void* data, size_t length) {
+
+    std::unique_ptr<Item> item(new Item{&db, index, datum, eckit::Buffer(reinterpret_cast<const char*>(data), length)});
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    rethrow();
+
+    cv_.wait(lock, [this] { return queue_.size() < queueLength_; });
+    queue_.emplace_back(std::move(item));
+
+    lock.unlock();
+    cv_.notify_all();
+}
+
+void ArchiveWorker::drain() {
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return queue_.empty() && !busy_; });
+
+    db_ = nullptr;
+    index_ = Key();
+
+    rethrow();
+}
+
+void ArchiveWorker::rethrow() {
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ArchiveWorker::run() {
+
+    for (;;) {
+
+        std::unique_ptr<Item> item;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            item = std::move(queue_.front());
+            queue_.pop_front();
+            busy_ = true;
+        }
+        cv_.notify_all();
+
+        try {
+            if (item->db_ != db_ || item->index_ != index_) {
+                item->db_->selectIndex(item->index_);
+                db_ = item->db_;
+                index_ = item->index_;
+            }
+            item->db_->archive(item->datum_, item->data_.data(), item->data_.size());
+        }
+        catch (...) {
+            // Reported to the caller by its next archive() or drain(). Later fields are still archived
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+            db_ = nullptr;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+        }
+        cv_.notify_all();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
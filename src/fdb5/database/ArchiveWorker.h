@@ -0,0 +1,94 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ArchiveWorker.h
+/// @date   Oct 2026
+
+#ifndef fdb5_ArchiveWorker_H
+#define fdb5_ArchiveWorker_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/memory/NonCopyable.h"
+
+#include "fdb5/database/Key.h"
+
+namespace fdb5 {
+
+class DB;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A thread archiving fields, already routed to their database and index, in the order they were queued.
+/// The Archiver gives each database to a single worker, so that a database is only ever written by one thread.
+
+class ArchiveWorker : private eckit::NonCopyable {
+
+public: // methods
+
+    ArchiveWorker(size_t queueLength);
+
+    /// Archives what is queued, then stops the thread. Errors not yet reported are lost
+    ~ArchiveWorker();
+
+    /// Queues a copy of the data, waiting for room if the queue is full. The copies held are bounded by the queue
+    /// length plus the field being archived, so (queueLength + 1) times the largest field archived, per worker.
+    /// @throws the error raised by an earlier field, if not reported yet
+    void archive(DB& db, const Key& index, const Key& datum, const void* data, size_t length);
+
+    /// Waits until every queued field is archived. Once it returns, and until the next field is queued,
+    /// the databases of this worker may be used from the calling thread.
+    /// @throws the first error raised since the last report
+    void drain();
+
+private: // types
+
+    struct Item {
+        DB* db_;
+        Key index_;
+        Key datum_;
+        eckit::Buffer data_;
+    };
+
+private: // methods
+
+    void run();
+    void rethrow();
+
+private: // members
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    std::deque<std::unique_ptr<Item>> queue_;
+    size_t queueLength_;
+
+    bool busy_;
+    bool stop_;
+    std::exception_ptr error_;
+
+    // Index last selected by this worker. Forgotten by drain(), as the caller may then select another one
+    DB* db_;
+    Key index_;
+
+    std::thread thread_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
@@ -11,11 +11,18 @@
 
 #include "fdb5/database/Archiver.h"
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+
 #include "eckit/config/Resource.h"
 
 #include "fdb5/LibFdb5.h"
 #include "fdb5/database/ArchiveVisitor.h"
+#include "fdb5/database/ArchiveWorker.h"
 #include "fdb5/database/BaseArchiveVisitor.h"
+#include "fdb5/database/DBCloser.h"
 #include "fdb5/rules/Schema.h"
 #include "fdb5/rules/Rule.h"
 
@@ -23,28 +30,219 @@ namespace fdb5 {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+/// The fields of a batch, grouped by database and index in order of first appearance
+struct ArchiveBatch {
+
+    struct Group {
+        Key db_;
+        Key index_;
+        std::vector<ArchiveItem> fields_;
+    };
+
+    void add(const Key& datum, const ArchiveItem& item) {
+        auto ins = lookup_.emplace(std::make_pair(db_, index_), groups_.size());
+        if (ins.second) {
+            groups_.push_back(Group{db_, index_, {}});
+        }
+        groups_[ins.first->second].fields_.emplace_back(datum, item.data_, item.length_);
+    }
+
+    // Database and index selected for the field being expanded
+    Key db_;
+    Key index_;
+
+    std::vector<Group> groups_;
+    std::map<std::pair<Key, Key>, size_t> lookup_;
+};
+
+/// Expands a field of a batch, opening its database so that the expansion can continue with its schema, but
+/// deferring the selection of the index and the archival of the data to the batch
+class BatchArchiveVisitor : public BaseArchiveVisitor {
+
+public: // methods
+
+    BatchArchiveVisitor(Archiver& owner, const ArchiveItem& item, ArchiveBatch& batch) :
+        BaseArchiveVisitor(owner, item.key_),
+        item_(item),
+        batch_(batch) {}
+
+protected: // methods
+
+    bool selectDatabase(const Key& key, const Key& full) override {
+        batch_.db_ = key;
+        return BaseArchiveVisitor::selectDatabase(key, full);
+    }
+
+    bool selectIndex(const Key& key, const Key&) override {
+        batch_.index_ = key;
+        return true;
+    }
+
+    bool selectDatum(const Key& key, const Key& full) override {
+        checkMissingKeys(full);
+        batch_.add(key, item_);
+        return true;
+    }
+
+    void print(std::ostream& out) const override {
+        out << "BatchArchiveVisitor[size=" << item_.length_ << "]";
+    }
+
+private: // members
+
+    const ArchiveItem& item_;
+    ArchiveBatch& batch_;
+};
+
+/// Expands a field for the archive workers. The database is opened from the calling thread, so that the expansion can
+/// continue with its schema; the worker owning it then selects the index and archives the data.
+/// The database and index of the field are those last selected by the expansion, in Archiver::prev_
+class WorkerArchiveVisitor : public BaseArchiveVisitor {
+
+public: // methods
+
+    WorkerArchiveVisitor(Archiver& owner, const Key& field, size_t length, Key& datum) :
+        BaseArchiveVisitor(owner, field),
+        length_(length),
+        datum_(datum) {}
+
+protected: // methods
+
+    bool selectDatabase(const Key& key, const Key&) override {
+        openDatabase(key);
+        return true;
+    }
+
+    bool selectIndex(const Key&, const Key&) override {
+        return true;
+    }
+
+    bool selectDatum(const Key& key, const Key& full) override {
+        checkMissingKeys(full);
+        datum_ = key;
+        return true;
+    }
+
+    void print(std::ostream& out) const override {
+        out << "WorkerArchiveVisitor[size=" << length_ << "]";
+    }
+
+private: // members
+
+    size_t length_;
+    Key& datum_;
+};
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 
 Archiver::Archiver(const Config& dbConfig) :
     dbConfig_(dbConfig),
-    current_(nullptr) {
+    current_(nullptr),
+    duplicates_(0),
+    duplicateBytes_(0) {
+
+    static size_t fdbArchiveThreads = eckit::Resource<size_t>("fdbArchiveThreads;$FDB_ARCHIVE_THREADS", 0);
+    // Each worker holds a copy of up to fdbArchiveQueueLength fields, plus the one being archived
+    static size_t fdbArchiveQueueLength = eckit::Resource<size_t>("fdbArchiveQueueLength;$FDB_ARCHIVE_QUEUE_LENGTH", 64);
+
+    for (size_t i = 0; i < fdbArchiveThreads; ++i) {
+        workers_.emplace_back(new ArchiveWorker(fdbArchiveQueueLength));
+    }
+
+    static bool fdbCloseDBsInBackground = eckit::Resource<bool>("fdbCloseDBsInBackground;$FDB_CLOSE_DBS_IN_BACKGROUND", false);
+
+    if (fdbCloseDBsInBackground) {
+        closer_.reset(new DBCloser());
+    }
 }
 
 Archiver::~Archiver() {
 
     flush(); // certify that all sessions are flushed before closing them
 
-    databases_.clear(); //< explicitly delete the DBs before schemas are destroyed
+    workers_.clear(); //< stop the workers before the DBs they write to are deleted
+    closer_.reset();
+
+    databases_.clear();
+    lru_.clear(); //< explicitly delete the DBs before schemas are destroyed
 }
 
 void Archiver::archive(const Key &key, const void* data, size_t len) {
-    ArchiveVisitor visitor(*this, key, data, len);
-    archive(key, visitor);
+
+    if (workers_.empty()) {
+        ArchiveVisitor visitor(*this, key, data, len);
+        archive(key, visitor);
+        return;
+    }
+
+    Key datum;
+    WorkerArchiveVisitor visitor(*this, key, len, datum);
+    expand(key, visitor);
+
+    ASSERT(current_);
+    worker(prev_[0]).archive(*current_, prev_[1], datum, data, len);
+}
+
+void Archiver::archive(const std::vector<ArchiveItem>& items) {
+
+    // The workers already archive a database at a time, in order
+    if (!workers_.empty()) {
+        for (const ArchiveItem& item : items) {
+            archive(item.key_, item.data_, item.length_);
+        }
+        return;
+    }
+
+    ArchiveBatch batch;
+
+    // Forget the previous selections, so that the first field records its database and index in the batch
+    prev_.assign(3, Key());
+
+    for (const ArchiveItem& item : items) {
+        BatchArchiveVisitor visitor(*this, item, batch);
+        expand(item.key_, visitor);
+    }
+
+    // Write a database at a time, and an index at a time within it
+    std::map<Key, size_t> rank;
+    for (const ArchiveBatch::Group& group : batch.groups_) {
+        rank.emplace(group.db_, rank.size());
+    }
+    std::stable_sort(batch.groups_.begin(), batch.groups_.end(),
+                     [&rank](const ArchiveBatch::Group& a, const ArchiveBatch::Group& b) {
+                         return rank.at(a.db_) < rank.at(b.db_);
+                     });
+
+    for (const ArchiveBatch::Group& group : batch.groups_) {
+        DB& db = database(group.db_);
+        db.selectIndex(group.index_);
+        db.archive(group.fields_);
+    }
+
+    // The index now selected in each database is not the one the visitors last saw
+    prev_.assign(3, Key());
+    current_ = nullptr;
 }
 
 void Archiver::archive(const Key &key, BaseArchiveVisitor& visitor) {
 
+    if (!workers_.empty()) {
+        // The visitor uses the databases from this thread: wait for the workers, and make it select the index again
+        drain();
+        prev_.assign(3, Key());
+    }
+
+    expand(key, visitor);
+}
+
+void Archiver::expand(const Key &key, BaseArchiveVisitor& visitor) {
+
     visitor.rule(nullptr);
-    
 
     dbConfig_.schema().expand(key, visitor);
 
@@ -59,8 +257,16 @@ void Archiver::archive(const Key &key, BaseArchiveVisitor& visitor) {
 }
 
 void Archiver::flush() {
-    for (store_t::iterator i = databases_.begin(); i != databases_.end(); ++i) {
-        i->second.second->flush();
+
+    drain();
+
+    for (lru_t::iterator i = lru_.begin(); i != lru_.end(); ++i) {
+        i->second->flush();
+    }
+
+    // Databases evicted are only consistent once closed
+    if (closer_) {
+        closer_->drain();
     }
 }
 
@@ -70,30 +276,31 @@ DB& Archiver::database(const Key &key) {
     store_t::iterator i = databases_.find(key);
 
     if (i != databases_.end() ) {
-        DB& db = *(i->second.second);
-        i->second.first = ::time(0);
-        return db;
-    }
-
-    static size_t fdbMaxNbDBsOpen = eckit::Resource<size_t>("fdbMaxNbDBsOpen", 64);
-
-    if (databases_.size() >= fdbMaxNbDBsOpen) {
-        bool found = false;
-        time_t oldest = ::time(0) + 24 * 60 * 60;
-        Key oldK;
-        for (store_t::iterator i = databases_.begin(); i != databases_.end(); ++i) {
-            if (i->second.first <= oldest) {
-                found = true;
-                oldK = i->first;
-                oldest = i->second.first;
-            }
-        }
-        if (found) {
-            eckit::Log::info() << "Closing database " << *databases_[oldK].second << std::endl;
-            databases_.erase(oldK);
+        lru_.splice(lru_.begin(), lru_, i->second);
+        return *(i->second->second);
+    }
+
+    static size_t fdbMaxNbDBsOpen = eckit::Resource<size_t>("fdbMaxNbDBsOpen;$FDB_MAX_NB_DBS_OPEN", 64);
+    static size_t fdbMaxDBsMemory = eckit::Resource<size_t>("fdbMaxDBsMemory;$FDB_MAX_DBS_MEMORY", 0);
+
+    size_t memory = 0;
+    if (fdbMaxDBsMemory) {
+        drain(); // the workers change the footprint of the databases they write to
+        for (const lru_t::value_type& db : lru_) {
+            memory += db.second->footprint();
         }
     }
 
+    while (!lru_.empty() && (lru_.size() >= fdbMaxNbDBsOpen || memory > fdbMaxDBsMemory)) {
+        memory -= std::min(memory, lru_.back().second->footprint());
+        evict();
+    }
+
+    // An earlier instance of this database may still be closing
+    if (closer_) {
+        closer_->wait(key);
+    }
+
     std::unique_ptr<DB> db = DB::buildWriter(key, dbConfig_);
 
     ASSERT(db);
@@ -106,10 +313,59 @@ DB& Archiver::database(const Key &key) {
     }
 
     DB& out = *db;
-    databases_[key] = std::make_pair(::time(0), std::move(db));
+    lru_.emplace_front(key, std::move(db));
+    databases_[key] = lru_.begin();
     return out;
 }
 
+void Archiver::evict() {
+
+    ASSERT(!lru_.empty());
+    Key key = lru_.back().first;
+
+    if (!workers_.empty()) {
+        worker(key).drain();
+    }
+
+    std::unique_ptr<DB> db = std::move(lru_.back().second);
+    databases_.erase(key);
+    lru_.pop_back();
+
+    duplicates_ += db->duplicates();
+    duplicateBytes_ += db->duplicateBytes();
+
+    eckit::Log::info() << "Closing database " << *db << std::endl;
+
+    if (closer_) {
+        closer_->close(key, std::move(db));
+    }
+    else {
+        db->flush();
+    }
+}
+
+void Archiver::duplicates(size_t& fields, size_t& bytes) const {
+    fields = duplicates_;
+    bytes = duplicateBytes_;
+    for (const lru_t::value_type& db : lru_) {
+        fields += db.second->duplicates();
+        bytes += db.second->duplicateBytes();
+    }
+}
+
+ArchiveWorker& Archiver::worker(const Key &key) {
+    ASSERT(!workers_.empty());
+    // By the canonical values, as in the path of the database, so that keys spelling the same database differently
+    // are given to the same worker. Database keys are built by the schema, so their keywords are in the same order
+    return *workers_[std::hash<std::string>()(key.valuesToString()) % workers_.size()];
+}
+
+void Archiver::drain() {
+    for (std::unique_ptr<ArchiveWorker>& w : workers_) {
+        w->drain();
+    }
+}
+
 void Archiver::print(std::ostream &out) const {
     out << "Archiver["
         << "]"
@@ -16,11 +16,15 @@
 #ifndef fdb5_Archiver_H
 #define fdb5_Archiver_H
 
-#include <time.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "eckit/memory/NonCopyable.h"
 
+#include "fdb5/database/ArchiveItem.h"
 #include "fdb5/database/DB.h"
 #include "fdb5/config/Config.h"
 
@@ -33,7 +37,9 @@ class MarsTask;
 namespace fdb5 {
 
 class Key;
+class ArchiveWorker;
 class BaseArchiveVisitor;
+class DBCloser;
 class Schema;
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -49,10 +55,17 @@ public: // methods
     void archive(const Key &key, BaseArchiveVisitor& visitor);
     void archive(const Key &key, const void* data, size_t len);
 
+    /// Archives a batch of fields. Each field is only routed to its database and index as it is expanded;
+    /// the data are then written an index at a time, in one batch to the store
+    void archive(const std::vector<ArchiveItem>& items);
+
     /// Flushes all buffers and closes all data handles into a consistent DB state
-    /// @note always safe to call
+    /// @note always safe to call. With archive workers, it waits for every field queued to be archived
     void flush();
 
+    /// Fields, and their bytes, skipped as duplicates by the databases archived to (see fdbSkipDuplicates)
+    void duplicates(size_t& fields, size_t& bytes) const;
+
     friend std::ostream &operator<<(std::ostream &s, const Archiver &x) {
         x.print(s);
         return s;
@@ -62,21 +75,45 @@ private: // methods
 
     void print(std::ostream &out) const;
 
+    /// Opens the database of the key, unless already open. Beyond fdbMaxNbDBsOpen open databases, or
+    /// fdbMaxDBsMemory bytes of their indexes and buffers, the least recently used are closed
     DB& database(const Key &key);
 
+    /// Closes the least recently used database, in the background with fdbCloseDBsInBackground
+    void evict();
+
+    void expand(const Key &key, BaseArchiveVisitor& visitor);
+
+    /// The worker owning the database of the key
+    ArchiveWorker& worker(const Key &key);
+
+    /// Waits for the workers to archive every field queued
+    void drain();
+
 private: // members
 
     friend class BaseArchiveVisitor;
 
-    typedef std::map< Key, std::pair<time_t, std::unique_ptr<DB> > > store_t;
+    typedef std::list< std::pair<Key, std::unique_ptr<DB> > > lru_t;  ///< most recently used first
+    typedef std::unordered_map< Key, lru_t::iterator > store_t;
 
     Config dbConfig_;
 
+    lru_t lru_;
     store_t databases_;
 
     std::vector<Key> prev_;
 
     DB* current_;
+
+    /// With fdbArchiveThreads set, fields are archived by these threads, each owning a share of the databases
+    std::vector<std::unique_ptr<ArchiveWorker>> workers_;
+
+    std::unique_ptr<DBCloser> closer_;
+
+    // Duplicates skipped by the databases already closed
+    size_t duplicates_;
+    size_t duplicateBytes_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
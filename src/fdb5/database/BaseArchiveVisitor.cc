@@ -26,12 +26,16 @@ BaseArchiveVisitor::BaseArchiveVisitor(Archiver &owner, const Key &field) :
 
 bool BaseArchiveVisitor::selectDatabase(const Key &key, const Key&) {
     LOG_DEBUG_LIB(LibFdb5) << "selectDatabase " << key << std::endl;
-    owner_.current_ = &owner_.database(key);
-    owner_.current_->deselectIndex();
+    openDatabase(key).deselectIndex();
 
     return true;
 }
 
+DB& BaseArchiveVisitor::openDatabase(const Key &key) {
+    owner_.current_ = &owner_.database(key);
+    return *owner_.current_;
+}
+
 bool BaseArchiveVisitor::selectIndex(const Key &key, const Key&) {
     // eckit::Log::info() << "selectIndex " << key << std::endl;
     ASSERT(owner_.current_);
@@ -46,6 +46,9 @@ protected: // methods
 
     fdb5::DB* current() const;
 
+    /// Makes the database of the key current for the rest of the expansion, leaving its selected index alone
+    fdb5::DB& openDatabase(const Key &key);
+
 private: // members
 
     Archiver &owner_;
@@ -129,6 +129,22 @@ std::unique_ptr<Catalogue> CatalogueFactory::build(const eckit::URI& uri, const
     return j->second->make(uri, config);
 }
 
+bool CatalogueFactory::mayExist(const Key& key, const Config& config, bool read) {
+    std::string nameLowercase = eckit::StringTools::lower(Manager(config).engine(key));
+
+    nameLowercase += read ? ".reader" : ".writer";
+
+    eckit::AutoLock<eckit::Mutex> lock(mutex_);
+    auto j = builders_.find(nameLowercase);
+
+    // Let build() report a missing builder
+    if (j == builders_.end()) {
+        return true;
+    }
+
+    return j->second->mayExist(key, config);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 CatalogueBuilderBase::CatalogueBuilderBase(const std::string& name) : name_(name) {
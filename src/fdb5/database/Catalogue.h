@@ -119,6 +119,12 @@ public:
     virtual DbStats stats() const = 0;
     virtual bool axis(const std::string& keyword, eckit::StringSet& s) const = 0;
     virtual bool retrieve(const Key& key, Field& field) const = 0;
+
+    /// Whether the database is unchanged since this reader loaded it, so that the reader can be reused
+    virtual bool upToDate() const { return false; }
+
+    /// Estimate of the memory held by the reader, used to bound the CatalogueCache
+    virtual size_t footprint() const { return 0; }
 };
 
 
@@ -129,6 +135,12 @@ public:
     virtual void overlayDB(const Catalogue& otherCatalogue, const std::set<std::string>& variableKeys, bool unmount) = 0;
     virtual void index(const Key& key, const eckit::URI& uri, eckit::Offset offset, eckit::Length length) = 0;
     virtual void reconsolidate() = 0;
+
+    /// Estimate of the memory held by the indexes open for writing
+    virtual size_t footprint() const { return 0; }
+
+    /// Looks up a field of the current index archived before, by this writer or since the database was created
+    virtual bool archived(const Key& key, Field& field) { return false; }
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -141,6 +153,10 @@ public:
     virtual ~CatalogueBuilderBase();
     virtual std::unique_ptr<Catalogue> make(const fdb5::Key& key, const fdb5::Config& config) = 0;
     virtual std::unique_ptr<Catalogue> make(const eckit::URI& uri, const fdb5::Config& config) = 0;
+
+    /// Cheap check, without building the catalogue, of whether the database may exist.
+    /// Only a false answer is definite.
+    virtual bool mayExist(const fdb5::Key&, const fdb5::Config&) { return true; }
 };
 
 template <class T>
@@ -168,6 +184,9 @@ public:
     std::unique_ptr<Catalogue> build(const Key& key, const Config& config, bool read);
     std::unique_ptr<Catalogue> build(const eckit::URI& uri, const Config& config, bool read);
 
+    /// @returns         false if the database certainly does not exist
+    bool mayExist(const Key& key, const Config& config, bool read);
+
 private:
     CatalogueFactory();
 
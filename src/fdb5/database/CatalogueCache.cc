@@ -0,0 +1,174 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/database/CatalogueCache.h"
+
+#include <sstream>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+
+#include "fdb5/LibFdb5.h"
+#include "fdb5/config/Config.h"
+#include "fdb5/database/Catalogue.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CatalogueCache& CatalogueCache::instance() {
+    static CatalogueCache cache;
+    return cache;
+}
+
+CatalogueCache::CatalogueCache() :
+    capacity_(eckit::Resource<size_t>("fdbCatalogueCacheSize;$FDB_CATALOGUE_CACHE_SIZE", 0)),
+    maxBytes_(eckit::Resource<size_t>("fdbCatalogueCacheBytes;$FDB_CATALOGUE_CACHE_BYTES", 0)),
+    bytes_(0),
+    stats_{0, 0, 0, 0} {}
+
+std::string CatalogueCache::makeKey(const eckit::URI& uri, const Config& config) {
+    // Readers built from different configurations (roots, schema, remapping) are not interchangeable
+    std::ostringstream key;
+    key << uri.asString() << '\n' << config.schemaPath() << '\n' << config;
+    return key.str();
+}
+
+std::unique_ptr<Catalogue> CatalogueCache::take(const eckit::URI& uri, const Config& config) {
+
+    if (!enabled()) {
+        return nullptr;
+    }
+
+    std::string key = makeKey(uri, config);
+    std::unique_ptr<Catalogue> catalogue;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            stats_.misses_++;
+            return nullptr;
+        }
+        catalogue = std::move(it->second->catalogue_);
+        bytes_ -= it->second->footprint_;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    // Checking the TOC costs system calls, so is done outside the lock
+
+    const CatalogueReader* reader = dynamic_cast<const CatalogueReader*>(catalogue.get());
+    ASSERT(reader);
+
+    if (reader->upToDate()) {
+        LOG_DEBUG_LIB(LibFdb5) << "CatalogueCache reusing " << uri << std::endl;
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.hits_++;
+        return catalogue;
+    }
+
+    LOG_DEBUG_LIB(LibFdb5) << "CatalogueCache discarding changed " << uri << std::endl;
+
+    // Any other reader of the same database was loaded no later, so is changed too
+
+    std::vector<std::unique_ptr<Catalogue>> discarded;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.stale_++;
+        stats_.misses_++;
+        auto range = index_.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            discarded.emplace_back(std::move(it->second->catalogue_));
+            bytes_ -= it->second->footprint_;
+            lru_.erase(it->second);
+        }
+        index_.erase(range.first, range.second);
+    }
+
+    return nullptr;
+}
+
+void CatalogueCache::give(std::unique_ptr<Catalogue> catalogue) {
+
+    if (!enabled() || !catalogue) {
+        return;
+    }
+
+    const CatalogueReader* reader = dynamic_cast<const CatalogueReader*>(catalogue.get());
+    if (!reader) {
+        return;
+    }
+
+    std::string key;
+    size_t footprint = 0;
+    try {
+        key = makeKey(catalogue->uri(), catalogue->config());
+        footprint = reader->footprint();
+        // Do not hold on to open index files while idle. They are reopened on demand.
+        catalogue->close();
+    }
+    catch (std::exception& e) {
+        LOG_DEBUG_LIB(LibFdb5) << "CatalogueCache not keeping " << *catalogue << ": " << e.what() << std::endl;
+        return;
+    }
+
+    if (maxBytes_ && footprint > maxBytes_) {
+        LOG_DEBUG_LIB(LibFdb5) << "CatalogueCache not keeping " << *catalogue << ": " << footprint
+                               << " bytes exceed fdbCatalogueCacheBytes" << std::endl;
+        return;
+    }
+
+    std::vector<std::unique_ptr<Catalogue>> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lru_.emplace_front(Entry{key, std::move(catalogue), footprint});
+        index_.emplace(key, lru_.begin());
+        bytes_ += footprint;
+
+        while (lru_.size() > capacity_ || (maxBytes_ && bytes_ > maxBytes_)) {
+            Entry& last = lru_.back();
+            auto range = index_.equal_range(last.key_);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == std::prev(lru_.end())) {
+                    index_.erase(it);
+                    break;
+                }
+            }
+            bytes_ -= last.footprint_;
+            evicted.emplace_back(std::move(last.catalogue_));
+            lru_.pop_back();
+            stats_.evictions_++;
+        }
+    }
+}
+
+CatalogueCache::Statistics CatalogueCache::takeStatistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Statistics result = stats_;
+    stats_ = Statistics{0, 0, 0, 0};
+    return result;
+}
+
+size_t CatalogueCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+size_t CatalogueCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
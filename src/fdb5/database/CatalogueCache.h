@@ -0,0 +1,104 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   CatalogueCache.h
+/// @date   Oct 2026
+
+#ifndef fdb5_CatalogueCache_H
+#define fdb5_CatalogueCache_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "eckit/filesystem/URI.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace fdb5 {
+
+class Catalogue;
+class Config;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Process-wide pool of catalogue readers no longer in use, keyed by database URI and by the configuration
+/// (schema included) they were built with, so that later requests (from any FDB object of the process using the
+/// same configuration) do not reload the TOC and decode the indexes again. A reader is handed out to one user at
+/// a time, and only if it reports that the database has not changed since it was loaded. Holds at most
+/// fdbCatalogueCacheSize readers (default 0, which disables it) and, if fdbCatalogueCacheBytes is set, at most
+/// that many bytes as estimated by CatalogueReader::footprint().
+
+class CatalogueCache : private eckit::NonCopyable {
+
+public: // types
+
+    struct Statistics {
+        size_t hits_;
+        size_t misses_;
+        size_t stale_;
+        size_t evictions_;
+    };
+
+public: // methods
+
+    static CatalogueCache& instance();
+
+    bool enabled() const { return capacity_ > 0; }
+
+    /// @returns a reader for the database at uri, built with the given configuration, that is still up to date,
+    ///          or nullptr
+    std::unique_ptr<Catalogue> take(const eckit::URI& uri, const Config& config);
+
+    /// Hands back a reader that is no longer used. Catalogues that are not readers are discarded.
+    void give(std::unique_ptr<Catalogue> catalogue);
+
+    /// Returns the statistics accumulated since the previous call, so that they are reported once however
+    /// many FDB instances of the process share the cache
+    Statistics takeStatistics();
+
+    /// Number of readers and estimated bytes currently held
+    size_t size() const;
+    size_t bytes() const;
+
+private: // types
+
+    struct Entry {
+        std::string key_;
+        std::unique_ptr<Catalogue> catalogue_;
+        size_t footprint_;
+    };
+
+private: // methods
+
+    CatalogueCache();
+
+    static std::string makeKey(const eckit::URI& uri, const Config& config);
+
+private: // members
+
+    mutable std::mutex mutex_;
+
+    std::list<Entry> lru_;   ///< most recently given first
+    std::multimap<std::string, std::list<Entry>::iterator> index_;
+
+    size_t capacity_;
+    size_t maxBytes_;  ///< 0 for no limit
+    size_t bytes_;
+
+    Statistics stats_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
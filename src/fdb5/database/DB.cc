@@ -8,11 +8,21 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <numeric>
+
+#include "eckit/config/Resource.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/DataHandle.h"
 #include "eckit/utils/StringTools.h"
 
 #include "fdb5/LibFdb5.h"
+#include "fdb5/database/CatalogueCache.h"
 #include "fdb5/database/DB.h"
 #include "fdb5/database/Field.h"
+#include "fdb5/io/Crc32c.h"
 #include "fdb5/toc/TocEngine.h"
 
 using eckit::Log;
@@ -21,6 +31,17 @@ namespace fdb5 {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+bool skipDuplicates() {
+    static bool fdbSkipDuplicates = eckit::Resource<bool>("fdbSkipDuplicates;$FDB_SKIP_DUPLICATES", false);
+    return fdbSkipDuplicates;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 std::unique_ptr<DB> DB::buildReader(const Key &key, const fdb5::Config& config) {
     return std::unique_ptr<DB>(new DB(key, config, true));
 }
@@ -34,6 +55,10 @@ std::unique_ptr<DB> DB::buildWriter(const eckit::URI& uri, const fdb5::Config& c
     return std::unique_ptr<DB>(new DB(uri, config, false));
 }
 
+bool DB::mayExist(const Key& key, const fdb5::Config& config) {
+    return CatalogueFactory::instance().mayExist(key, config.expandConfig(), true);
+}
+
 DB::DB(const Key& key, const fdb5::Config& config, bool read) {
     catalogue_ = CatalogueFactory::instance().build(key, config.expandConfig(), read);
 }
@@ -42,6 +67,13 @@ DB::DB(const eckit::URI& uri, const fdb5::Config& config, bool read) {
     catalogue_ = CatalogueFactory::instance().build(uri, config.expandConfig(), read);
 }
 
+DB::~DB() {
+    // Keep the reader for later requests, which then need not load the catalogue again
+    if (CatalogueCache::instance().enabled() && dynamic_cast<CatalogueReader*>(catalogue_.get())) {
+        CatalogueCache::instance().give(std::move(catalogue_));
+    }
+}
+
 Store& DB::store() const {
     if (store_ == nullptr) {
         store_ = catalogue_->buildStore();
@@ -108,10 +140,113 @@ void DB::archive(const Key& key, const void* data, eckit::Length length) {
     CatalogueWriter* cat = dynamic_cast<CatalogueWriter*>(catalogue_.get());
     ASSERT(cat);
 
+    if (skipDuplicates()) {
+        std::vector<ArchiveItem> fields{ArchiveItem(key, data, length)};
+        if (!duplicate(*cat, fields.front())) {
+            archive(*cat, fields);
+        }
+        return;
+    }
+
     const Index& idx = cat->currentIndex();
     cat->archive(key, store().archive(idx.key(), data, length));
 }
 
+void DB::archive(const std::vector<ArchiveItem>& fields) {
+
+    CatalogueWriter* cat = dynamic_cast<CatalogueWriter*>(catalogue_.get());
+    ASSERT(cat);
+
+    if (!skipDuplicates()) {
+        archive(*cat, fields);
+        return;
+    }
+
+    std::vector<ArchiveItem> changed;
+    changed.reserve(fields.size());
+    for (ArchiveItem field : fields) {
+        if (!duplicate(*cat, field)) {
+            changed.push_back(field);
+        }
+    }
+
+    if (!changed.empty()) {
+        archive(*cat, changed);
+    }
+}
+
+bool DB::duplicate(CatalogueWriter& cat, ArchiveItem& item) {
+
+    Field field;
+    if (!cat.archived(item.key_, field)) {
+        return false;
+    }
+
+    // The length and checksum recorded in the index rule out most fields that changed, and the data archived is
+    // only read back when they match. Without a checksum, the field is archived again
+    uint32_t recorded;
+    if (field.location().length() != eckit::Length(item.length_) || !field.location().recordedChecksum(recorded)) {
+        return false;
+    }
+
+    item.checksum(Crc32c::compute(item.data_, item.length_));
+    if (item.checksum_ != recorded || !sameData(field, item.data_, item.length_)) {
+        return false;
+    }
+
+    LOG_DEBUG_LIB(LibFdb5) << "Skipping " << item.key_ << ", identical to " << field.location() << std::endl;
+
+    duplicates_++;
+    duplicateBytes_ += item.length_;
+    return true;
+}
+
+bool DB::sameData(Field& field, const void* data, eckit::Length length) {
+
+    // The field may have been archived in this session, and still be buffered
+    store().flush();
+
+    std::unique_ptr<eckit::DataHandle> dh(store().retrieve(field));
+    dh->openForRead();
+    eckit::AutoClose closer(*dh);
+
+    const char* p = static_cast<const char*>(data);
+    const size_t total = length;
+
+    std::vector<char> buffer(std::min<size_t>(total, 1024 * 1024));
+    size_t pos = 0;
+    while (pos < total) {
+        long n = dh->read(buffer.data(), std::min(buffer.size(), total - pos));
+        if (n <= 0 || ::memcmp(buffer.data(), p + pos, n) != 0) {
+            return false;
+        }
+        pos += n;
+    }
+    return true;
+}
+
+void DB::archive(CatalogueWriter& cat, const std::vector<ArchiveItem>& fields) {
+
+    const Index& idx = cat.currentIndex();
+    std::vector<std::unique_ptr<FieldLocation>> locations = store().archive(idx.key(), fields);
+    ASSERT(locations.size() == fields.size());
+
+    // Index entries are added in the order of the index, a field still replacing any earlier one with the same key
+    std::vector<std::string> names;
+    names.reserve(fields.size());
+    for (const ArchiveItem& field : fields) {
+        names.emplace_back(field.key_.valuesToString());
+    }
+
+    std::vector<size_t> order(fields.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&names](size_t a, size_t b) { return names[a] < names[b]; });
+
+    for (size_t i : order) {
+        cat.archive(fields[i].key_, std::move(locations[i]));
+    }
+}
+
 bool DB::open() {
     bool ret = catalogue_->open();
     if (!ret)
@@ -134,6 +269,14 @@ void DB::close() {
     catalogue_->close();
 }
 
+size_t DB::footprint() const {
+    size_t total = (store_ != nullptr) ? store_->footprint() : 0;
+    if (const CatalogueWriter* cat = dynamic_cast<const CatalogueWriter*>(catalogue_.get())) {
+        total += cat->footprint();
+    }
+    return total;
+}
+
 bool DB::exists() const {
     return (catalogue_->exists()/* && store_->exists()*/);
 }
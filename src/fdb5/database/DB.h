@@ -16,9 +16,12 @@
 #ifndef fdb5_DB_H
 #define fdb5_DB_H
 
+#include <atomic>
+
 #include "eckit/types/Types.h"
 
 #include "fdb5/config/Config.h"
+#include "fdb5/database/ArchiveItem.h"
 #include "fdb5/database/Catalogue.h"
 #include "fdb5/database/EntryVisitMechanism.h"
 #include "fdb5/database/Key.h"
@@ -47,6 +50,11 @@ public: // methods
     static std::unique_ptr<DB> buildReader(const eckit::URI& uri, const fdb5::Config& config = fdb5::Config());
     static std::unique_ptr<DB> buildWriter(const eckit::URI& uri, const fdb5::Config& config = fdb5::Config());
 
+    /// Checks, without opening it, whether a database may exist for reading. Only a false answer is definite.
+    static bool mayExist(const Key& key, const fdb5::Config& config = fdb5::Config());
+
+    ~DB();
+
     std::string dbType() const;
 
     const Key& key() const;
@@ -58,10 +66,20 @@ public: // methods
     eckit::DataHandle *retrieve(const Key &key);
     void archive(const Key &key, const void *data, eckit::Length length);
 
+    /// Archives fields of the current index, keyed by their datum keys, in one batch to the store
+    void archive(const std::vector<ArchiveItem>& fields);
+
+    /// Fields, and their bytes, that archive() skipped with fdbSkipDuplicates, as identical to those archived before
+    size_t duplicates() const { return duplicates_; }
+    size_t duplicateBytes() const { return duplicateBytes_; }
+
     bool open();
     void flush();
     void close();
 
+    /// Estimate of the memory held for writing by the open indexes and data handles
+    size_t footprint() const;
+
     bool exists() const;
 
     void dump(std::ostream& out, bool simple=false, const eckit::Configuration& conf = eckit::LocalConfiguration()) const;
@@ -97,8 +115,20 @@ private: // members
 
     Store& store() const;
 
+    void archive(CatalogueWriter& cat, const std::vector<ArchiveItem>& fields);
+
+    /// Whether the field archived before under the key of the current index has the same data. The checksum of the
+    /// field, if computed to find out, is recorded in it for the store
+    bool duplicate(CatalogueWriter& cat, ArchiveItem& field);
+
+    /// Whether the data of the field archived is that given
+    bool sameData(Field& field, const void* data, eckit::Length length);
+
     std::unique_ptr<Catalogue> catalogue_;
     mutable std::unique_ptr<Store> store_ = nullptr;
+
+    std::atomic<size_t> duplicates_{0};
+    std::atomic<size_t> duplicateBytes_{0};
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,123 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/database/DBCloser.h"
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+
+#include "fdb5/database/DB.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+DBCloser::DBCloser() :
+    busy_(false),
+    stop_(false),
+    thread_([this] { run(); }) {}
+
+DBCloser::~DBCloser() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+
+    if (error_) {
+        eckit::Log::error() << "DBCloser stopped with an unreported error" << std::endl;
+    }
+}
+
+void DBCloser::close(const Key& key, std::unique_ptr<DB> db) {
+    ASSERT(db);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rethrow();
+        queue_.emplace_back(key, std::move(db));
+    }
+    cv_.notify_all();
+}
+
+void DBCloser::wait(const Key& key) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this, &key] { return !closing(key); });
+}
+
+void DBCloser::drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return queue_.empty() && !busy_; });
+    rethrow();
+}
+
+bool DBCloser::closing(const Key& key) const {
+    if (busy_ && current_ == key) {
+        return true;
+    }
+    for (const auto& db : queue_) {
+        if (db.first == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DBCloser::rethrow() {
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void DBCloser::run() {
+
+    for (;;) {
+
+        std::unique_ptr<DB> db;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            current_ = queue_.front().first;
+            db = std::move(queue_.front().second);
+            queue_.pop_front();
+            busy_ = true;
+        }
+
+        try {
+            // As when the Archiver closes it: the catalogue closes itself once flushed and deleted
+            db->flush();
+            db.reset();
+        }
+        catch (...) {
+            // Reported to the Archiver by its next close() or drain()
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        db.reset();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+        }
+        cv_.notify_all();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
@@ -0,0 +1,85 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   DBCloser.h
+/// @date   Oct 2026
+
+#ifndef fdb5_DBCloser_H
+#define fdb5_DBCloser_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "eckit/memory/NonCopyable.h"
+
+#include "fdb5/database/Key.h"
+
+namespace fdb5 {
+
+class DB;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A thread closing the databases evicted by the Archiver, so that flushing them does not hold up the archival
+/// to the others
+
+class DBCloser : private eckit::NonCopyable {
+
+public: // methods
+
+    DBCloser();
+
+    /// Closes what is queued, then stops the thread. Errors not yet reported are lost
+    ~DBCloser();
+
+    /// Queues the database of the key for closing.
+    /// @throws the error raised closing an earlier database, if not reported yet
+    void close(const Key& key, std::unique_ptr<DB> db);
+
+    /// Waits until the database of the key is not being closed, so that it may be opened again
+    void wait(const Key& key);
+
+    /// Waits until every queued database is closed.
+    /// @throws the first error raised since the last report
+    void drain();
+
+private: // methods
+
+    void run();
+    void rethrow();
+
+    bool closing(const Key& key) const;
+
+private: // members
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    std::deque<std::pair<Key, std::unique_ptr<DB>>> queue_;
+
+    bool busy_;
+    Key current_;  ///< the database being closed, while busy_
+
+    bool stop_;
+    std::exception_ptr error_;
+
+    std::thread thread_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
@@ -16,6 +16,7 @@
 #ifndef fdb5_FieldLocation_H
 #define fdb5_FieldLocation_H
 
+#include <cstdint>
 #include <memory>
 #include <eckit/filesystem/URI.h>
 
@@ -57,6 +58,13 @@ public: // methods
 
     virtual eckit::DataHandle *dataHandle() const = 0;
 
+    /// True if dataHandle() reads exactly the bytes [offset, offset + length) of the local file uri().path(),
+    /// so that reads of neighbouring fields may be coalesced
+    virtual bool plainFileRange() const { return false; }
+
+    /// The CRC-32C of the field data, if recorded when it was archived
+    virtual bool recordedChecksum(uint32_t& crc) const { return false; }
+
     /// Create a (shared) copy of the current object, for storage in a general container.
     virtual std::shared_ptr<FieldLocation> make_shared() const = 0;
 
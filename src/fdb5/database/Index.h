@@ -92,6 +92,9 @@ public: // methods
 
     virtual IndexStats statistics() const = 0;
 
+    /// Estimate of the memory held by the index while open
+    virtual size_t footprint() const { return 0; }
+
     virtual void print( std::ostream &out ) const = 0;
 
     virtual void flock() const = 0;
@@ -171,6 +174,8 @@ public: // methods
 
     IndexStats statistics() const { return content_->statistics(); }
 
+    size_t footprint() const { return content_->footprint(); }
+
     IndexBase* content() { return content_; }
     const IndexBase* content() const { return content_; }
 
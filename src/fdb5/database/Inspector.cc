@@ -64,26 +64,71 @@ ListIterator Inspector::inspect(const metkit::mars::MarsRequest& request,
                                 const Schema& schema,
                                 const fdb5::Notifier& notifyee) const {
 
+    missing_.expire();
+
     InspectIterator* iterator = new InspectIterator();
-    MultiRetrieveVisitor visitor(notifyee, *iterator, databases_, dbConfig_);
+    MultiRetrieveVisitor visitor(notifyee, *iterator, databases_, missing_, dbConfig_);
 
     LOG_DEBUG_LIB(LibFdb5) << "Using schema: " << schema << std::endl;
 
     schema.expand(request, visitor);
+    visitor.flush();
 
     using QueryIterator = APIIterator<ListElement>;
     return QueryIterator(iterator);
 }
 
-ListIterator Inspector::inspect(const metkit::mars::MarsRequest& request) const {
+void Inspector::forgetMissingDatabases() {
+    missing_.clear();
+}
 
-    class NullNotifier : public Notifier {
-        void notifyWind() const override {}
-    };
+namespace {
+class NullNotifier : public Notifier {
+    void notifyWind() const override {}
+};
+}
 
+ListIterator Inspector::inspect(const metkit::mars::MarsRequest& request) const {
     return inspect(request, NullNotifier());
 }
 
+std::vector<ListIterator> Inspector::inspect(const std::vector<metkit::mars::MarsRequest>& requests) const {
+
+    std::vector<ListIterator> result;
+    if (requests.empty()) {
+        return result;
+    }
+
+    missing_.expire();
+
+    std::vector<InspectIterator*> iterators;
+    iterators.reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        iterators.push_back(new InspectIterator());
+    }
+
+    using QueryIterator = APIIterator<ListElement>;
+    result.reserve(requests.size());
+    for (InspectIterator* it : iterators) {
+        result.emplace_back(QueryIterator(it));
+    }
+
+    NullNotifier notifyee;
+    MultiRetrieveVisitor visitor(notifyee, *iterators[0], databases_, missing_, dbConfig_);
+    visitor.deferLookups();
+
+    const Schema& schema = dbConfig_.schema();
+    for (size_t i = 0; i < requests.size(); ++i) {
+        visitor.target(*iterators[i]);
+        schema.expand(requests[i], visitor);
+    }
+    visitor.flush();
+
+    LOG_DEBUG_LIB(LibFdb5) << "Inspector expanded a batch of " << eckit::Plural(requests.size(), "request") << std::endl;
+
+    return result;
+}
+
 ListIterator Inspector::inspect(const metkit::mars::MarsRequest& request, const Notifier& notifyee) const {
 
     return inspect(request, dbConfig_.schema(), notifyee);
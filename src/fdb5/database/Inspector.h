@@ -19,9 +19,11 @@
 #include <iosfwd>
 #include <cstdlib>
 #include <map>
+#include <vector>
 
 #include "fdb5/config/Config.h"
 #include "fdb5/api/helpers/ListIterator.h"
+#include "fdb5/database/MissingDatabases.h"
 
 #include "eckit/memory/NonCopyable.h"
 #include "eckit/container/CacheLRU.h"
@@ -81,10 +83,20 @@ public: // methods
 
     ListIterator inspect(const metkit::mars::MarsRequest& request, const Notifier& notifyee) const;
 
+    /// Lists the fields of several requests, expanded together so that each database is opened, and each
+    /// index selected, once for the whole batch
+    /// @returns  one iterator per request, in the order of the requests
+
+    std::vector<ListIterator> inspect(const std::vector<metkit::mars::MarsRequest>& requests) const;
+
     /// Give read access to a range of entries according to a request
 
     void visitEntries(const FDBToolRequest& request, EntryVisitor& visitor) const;
 
+    /// Forgets the databases previously found missing, e.g. once data has been archived and flushed
+
+    void forgetMissingDatabases();
+
     friend std::ostream &operator<<(std::ostream &s, const Inspector &x) {
         x.print(s);
         return s;
@@ -100,6 +112,8 @@ private: // data
 
     mutable eckit::CacheLRU<Key,DB*> databases_;
 
+    mutable MissingDatabases missing_;
+
     Config dbConfig_;
 };
 
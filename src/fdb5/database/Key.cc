@@ -26,6 +26,18 @@ namespace fdb5 {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+struct KeywordLess {
+    bool operator()(const std::pair<std::string, std::string>& entry, const std::string& keyword) const {
+        return entry.first < keyword;
+    }
+};
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 Key::Key(const std::shared_ptr<TypesRegistry> reg) :
     keys_(),
     registry_(reg), canonical_(false) {}
@@ -44,7 +56,7 @@ Key::Key(const std::string &s, const Rule *rule) :
 }
 
 Key::Key(const eckit::StringDict &keys, const std::shared_ptr<TypesRegistry> reg) :
-    keys_(keys),
+    keys_(keys.begin(), keys.end()),
     registry_(reg),
     canonical_(false) {
 
@@ -62,15 +74,67 @@ Key::Key(eckit::Stream& s, const std::shared_ptr<TypesRegistry> reg) :
 }
 
 Key::Key(std::initializer_list<std::pair<const std::string, std::string>> l, const std::shared_ptr<TypesRegistry> reg) :
-    keys_(l),
     registry_(reg),
     canonical_(reg == nullptr) {
 
+    const eckit::StringDict keys(l);
+    keys_.assign(keys.begin(), keys.end());
+
     for (const auto& kv : keys_) {
         names_.emplace_back(kv.first);
     }
 }
 
+Key::Key(const Key& other) :
+    keys_(other.keys_),
+    names_(other.names_),
+    registry_(other.registry_),
+    canonical_(other.canonical_) {
+    copyMemo(other);
+}
+
+Key::Key(Key&& other) :
+    keys_(std::move(other.keys_)),
+    names_(std::move(other.names_)),
+    registry_(std::move(other.registry_)),
+    canonical_(other.canonical_) {
+    copyMemo(other);
+    other.forget();
+}
+
+Key& Key::operator=(const Key& other) {
+    if (this != &other) {
+        keys_ = other.keys_;
+        names_ = other.names_;
+        registry_ = other.registry_;
+        canonical_ = other.canonical_;
+        forget();
+        copyMemo(other);
+    }
+    return *this;
+}
+
+Key& Key::operator=(Key&& other) {
+    if (this != &other) {
+        keys_ = std::move(other.keys_);
+        names_ = std::move(other.names_);
+        registry_ = std::move(other.registry_);
+        canonical_ = other.canonical_;
+        forget();
+        copyMemo(other);
+        other.forget();
+    }
+    return *this;
+}
+
+void Key::copyMemo(const Key& other) {
+    if (other.memo_.load(std::memory_order_acquire) == MEMO_READY) {
+        fingerprint_ = other.fingerprint_;
+        memo_.store(MEMO_READY, std::memory_order_relaxed);
+    }
+    hash_.store(other.hash_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
 Key Key::parseStringUntyped(const std::string& s) {
 
     eckit::Tokenizer parse1(",");
@@ -122,16 +186,18 @@ void Key::decode(eckit::Stream& s) {
     canonical_ = true;
     keys_.clear();
     names_.clear();
+    forget();
 
     size_t n;
 
     s >> n;
     std::string k;
     std::string v;
+    keys_.reserve(n);
     for (size_t i = 0; i < n; ++i) {
         s >> k;
         s >> v;
-        keys_[k] = v;
+        assign(k, v);
     }
 
     s >> n;
@@ -146,7 +212,7 @@ void Key::encode(eckit::Stream& s) const {
     const TypesRegistry* registry = canonical_ ? nullptr : &this->registry();
 
     s << keys_.size();
-    for (eckit::StringDict::const_iterator i = keys_.begin(); i != keys_.end(); ++i) {
+    for (const_iterator i = keys_.begin(); i != keys_.end(); ++i) {
         s << i->first << (registry ? canonicalise(i->first, i->second) : i->second);
     }
 
@@ -161,7 +227,7 @@ std::set<std::string> Key::keys() const {
 
     std::set<std::string> k;
 
-    for (eckit::StringDict::const_iterator i = keys_.begin(); i != keys_.end(); ++i) {
+    for (const_iterator i = keys_.begin(); i != keys_.end(); ++i) {
         k.insert(i->first);
     }
 
@@ -172,37 +238,52 @@ void Key::clear() {
     registry_ = nullptr;
     keys_.clear();
     names_.clear();
+    forget();
 }
 
-void Key::set(const std::string &k, const std::string &v) {
+Key::const_iterator Key::find(const std::string& s) const {
+    const_iterator i = std::lower_bound(keys_.begin(), keys_.end(), s, KeywordLess());
+    return (i != keys_.end() && i->first == s) ? i : keys_.end();
+}
 
-    eckit::StringDict::iterator it = keys_.find(k);
-    if (it == keys_.end()) {
-        names_.push_back(k);
-        keys_[k] = v;
-    } else {
+bool Key::assign(const std::string &k, const std::string &v) {
+    forget();
+    Entries::iterator it = std::lower_bound(keys_.begin(), keys_.end(), k, KeywordLess());
+    if (it != keys_.end() && it->first == k) {
         it->second = v;
+        return false;
     }
+    keys_.emplace(it, k, v);
+    return true;
+}
 
+void Key::set(const std::string &k, const std::string &v) {
+    if (assign(k, v)) {
+        names_.push_back(k);
+    }
 }
 
 void Key::unset(const std::string &k) {
-    keys_.erase(k);
+    forget();
+    Entries::iterator it = std::lower_bound(keys_.begin(), keys_.end(), k, KeywordLess());
+    if (it != keys_.end() && it->first == k) {
+        keys_.erase(it);
+    }
 }
 
 void Key::push(const std::string &k, const std::string &v) {
-    keys_[k] = v;
+    assign(k, v);
     names_.push_back(k);
 }
 
 void Key::pop(const std::string &k) {
-    keys_.erase(k);
+    unset(k);
     ASSERT(names_.back() == k);
     names_.pop_back();
 }
 
 const std::string &Key::get( const std::string &k ) const {
-    eckit::StringDict::const_iterator i = keys_.find(k);
+    const_iterator i = find(k);
     if ( i == keys_.end() ) {
         std::ostringstream oss;
         oss << "Key::get() failed for [" + k + "] in " << *this;
@@ -272,7 +353,7 @@ bool Key::match(const Key& other, const eckit::StringList& ignore) const {
 
 bool Key::match(const std::string &key, const std::set<std::string> &values) const {
 
-    eckit::StringDict::const_iterator i = find(key);
+    const_iterator i = find(key);
     if (i == end()) {
         return false;
     }
@@ -282,7 +363,7 @@ bool Key::match(const std::string &key, const std::set<std::string> &values) con
 
 bool Key::match(const std::string &key, const eckit::DenseSet<std::string> &values) const {
 
-    eckit::StringDict::const_iterator i = find(key);
+    const_iterator i = find(key);
     if (i == end()) {
         return false;
     }
@@ -309,6 +390,7 @@ bool Key::partialMatch(const metkit::mars::MarsRequest& request) const {
 
 void Key::registry(const std::shared_ptr<TypesRegistry> reg) {
     registry_ = reg;
+    forget();
 }
 
 const TypesRegistry& Key::registry() const {
@@ -335,30 +417,70 @@ std::string Key::canonicalise(const std::string& keyword, const std::string& val
 
 std::string Key::canonicalValue(const std::string& keyword) const {
 
-    eckit::StringDict::const_iterator it = keys_.find(keyword);
+    const_iterator it = find(keyword);
     ASSERT(it != keys_.end());
 
     return canonicalise(keyword, it->second);
 }
 
 std::string Key::valuesToString() const {
+    if (memo_.load(std::memory_order_acquire) == MEMO_READY) {
+        return fingerprint_;
+    }
+    std::string result = fingerprint();
+    memoise(result);
+    return result;
+}
+
+size_t Key::hash() const {
+
+    size_t h = hash_.load(std::memory_order_relaxed);
+    if (h != 0) {
+        return h;
+    }
+
+    // Over the entries, which are sorted by keyword, rather than over the values in the order of names_, which
+    // differs between equal keys built in different orders. The values are hashed as stored, as operator== compares
+    // them: keys spelling a value differently are not equal, and need not hash equal
+    std::hash<std::string> hasher;
+    for (const auto& kv : keys_) {
+        h ^= hasher(kv.first) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= hasher(kv.second) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    if (h == 0) {
+        h = 1;
+    }
+
+    hash_.store(h, std::memory_order_relaxed);
+    return h;
+}
+
+void Key::memoise(const std::string& fingerprint) const {
+    int expected = MEMO_EMPTY;
+    if (memo_.compare_exchange_strong(expected, MEMO_FILLING, std::memory_order_acquire)) {
+        fingerprint_ = fingerprint;
+        memo_.store(MEMO_READY, std::memory_order_release);
+    }
+}
+
+std::string Key::fingerprint() const {
 
     ASSERT(names_.size() == keys_.size());
 
-    std::ostringstream oss;
-    const char *sep = "";
+    std::string result;
+    result.reserve(16 * names_.size());
 
     for (eckit::StringList::const_iterator j = names_.begin(); j != names_.end(); ++j) {
-        eckit::StringDict::const_iterator i = keys_.find(*j);
+        const_iterator i = find(*j);
         ASSERT(i != keys_.end());
 
-        oss << sep;
-        oss << canonicalise(*j, i->second);
-
-        sep = ":";
+        if (j != names_.begin()) {
+            result += ':';
+        }
+        result += canonicalise(*j, i->second);
     }
 
-    return oss.str();
+    return result;
 }
 
 
@@ -368,7 +490,7 @@ const eckit::StringList& Key::names() const {
 
 std::string Key::value(const std::string& key) const {
 
-    eckit::StringDict::const_iterator it = keys_.find(key);
+    const_iterator it = find(key);
     ASSERT(it != keys_.end());
     return it->second;
 }
@@ -410,14 +532,14 @@ void Key::validateKeysOf(const Key& other, bool checkAlsoValues) const
     }
 }
 
-const eckit::StringDict &Key::keyDict() const {
-    return keys_;
+eckit::StringDict Key::keyDict() const {
+    return eckit::StringDict(keys_.begin(), keys_.end());
 }
 
 metkit::mars::MarsRequest Key::request(std::string verb) const {
     metkit::mars::MarsRequest req(verb);
 
-    for (eckit::StringDict::const_iterator i = keys_.begin(); i != keys_.end(); ++i) {
+    for (const_iterator i = keys_.begin(); i != keys_.end(); ++i) {
         req.setValue(i->first, i->second);
     }
 
@@ -440,7 +562,7 @@ fdb5::Key::operator eckit::StringDict() const
 
     for (eckit::StringList::const_iterator j = names_.begin(); j != names_.end(); ++j) {
 
-        eckit::StringDict::const_iterator i = keys_.find(*j);
+        const_iterator i = find(*j);
 
         ASSERT(i != keys_.end());
         ASSERT(!(*i).second.empty());
@@ -455,7 +577,7 @@ void Key::print(std::ostream &out) const {
     if (names_.size() == keys_.size()) {
         out << "{" << toString() << "}";
     } else {
-        out << keys_;
+        out << keyDict();
     }
 }
 
@@ -463,7 +585,7 @@ std::string Key::toString() const {
     std::string res;
     const char *sep = "";
     for (eckit::StringList::const_iterator j = names_.begin(); j != names_.end(); ++j) {
-        eckit::StringDict::const_iterator i = keys_.find(*j);
+        const_iterator i = find(*j);
         ASSERT(i != keys_.end());
         if (!i->second.empty()) {
             res += sep + *j + '=' + i->second;
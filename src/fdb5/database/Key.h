@@ -16,11 +16,13 @@
 #ifndef fdb5_Key_H
 #define fdb5_Key_H
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <vector>
 #include <set>
 #include <memory>
+#include <utility>
 
 #include "eckit/types/Types.h"
 
@@ -44,6 +46,14 @@ class Rule;
 
 class Key {
 
+public: // types
+
+    /// Keyword/value pairs, sorted by keyword
+    typedef std::vector<std::pair<std::string, std::string>> Entries;
+
+    typedef Entries::const_iterator const_iterator;
+    typedef Entries::const_reverse_iterator const_reverse_iterator;
+
 public: // methods
 
     explicit Key(const std::shared_ptr<TypesRegistry> reg = nullptr);
@@ -52,6 +62,12 @@ public: // methods
     explicit Key(const eckit::StringDict &keys, const std::shared_ptr<TypesRegistry> reg=nullptr);
     Key(std::initializer_list<std::pair<const std::string, std::string>>, const std::shared_ptr<TypesRegistry> reg=nullptr);
 
+    Key(const Key& other);
+    Key(Key&& other);
+
+    Key& operator=(const Key& other);
+    Key& operator=(Key&& other);
+
     static Key parseStringUntyped(const std::string& s);
     /// @todo - this functionality should not be supported any more.
     static Key parseString(const std::string&, const std::shared_ptr<TypesRegistry> reg);
@@ -113,23 +129,25 @@ public: // methods
     const TypesRegistry& registry() const;
     const void* reg() const;
 
+    /// The canonical values, joined in the order of the keywords. Computed once, until the key changes
     std::string valuesToString() const;
 
+    /// Hash of the keywords and values as stored, in keyword order, so that keys that compare equal hash equal
+    /// whatever the order their keywords were set in. Computed once, until the key changes
+    size_t hash() const;
+
     const eckit::StringList& names() const;
 
     std::string value(const std::string& keyword) const;
     std::string canonicalValue(const std::string& keyword) const;
 
-    typedef eckit::StringDict::const_iterator const_iterator;
-    typedef eckit::StringDict::const_reverse_iterator const_reverse_iterator;
-
     const_iterator begin() const { return keys_.begin(); }
     const_iterator end() const { return keys_.end(); }
 
     const_reverse_iterator rbegin() const { return keys_.rbegin(); }
     const_reverse_iterator rend() const { return keys_.rend(); }
 
-    const_iterator find(const std::string& s) const { return keys_.find(s); }
+    const_iterator find(const std::string& s) const;
 
     size_t size() const { return keys_.size(); }
 
@@ -138,7 +156,7 @@ public: // methods
     /// @throws When "other" doesn't contain all the keys of "this"
     void validateKeysOf(const Key& other, bool checkAlsoValues = false) const;
 
-    const eckit::StringDict& keyDict() const;
+    eckit::StringDict keyDict() const;
 
     metkit::mars::MarsRequest request(std::string verb = "retrieve") const;
 
@@ -146,6 +164,14 @@ public: // methods
 
     operator eckit::StringDict() const;
 
+private: // types
+
+    enum Memo {
+        MEMO_EMPTY,
+        MEMO_FILLING,
+        MEMO_READY
+    };
+
 private: // members
 
     //TODO add unit test for each type
@@ -157,11 +183,33 @@ private: // members
 
     std::string toString() const;
 
-    eckit::StringDict keys_;
+    /// Sets the value of the keyword, adding it in its sorted position if missing.
+    /// @returns true if the keyword was added
+    bool assign(const std::string &k, const std::string &v);
+
+    std::string fingerprint() const;
+    void memoise(const std::string& fingerprint) const;
+    void copyMemo(const Key& other);
+    void forget() {
+        memo_.store(MEMO_EMPTY, std::memory_order_relaxed);
+        hash_.store(0, std::memory_order_relaxed);
+    }
+
+    /// A key holds a handful of short keywords and values, which mostly fit in the strings themselves.
+    /// Kept flat, it costs a single allocation rather than one per keyword, and is searched as fast as a map
+    Entries keys_;
     eckit::StringList names_;
 
     std::shared_ptr<TypesRegistry> registry_;
     bool canonical_;
+
+    // Whichever thread first computes the fingerprint of a const key stores it, so that keys shared
+    // read-only between threads stay safe to use
+    mutable std::string fingerprint_;
+    mutable std::atomic<int> memo_{MEMO_EMPTY};
+
+    // Any thread may store the hash, all of them computing the same value. 0 until computed
+    mutable std::atomic<size_t> hash_{0};
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -172,7 +220,7 @@ namespace std {
     template <>
     struct hash<fdb5::Key> {
         size_t operator() (const fdb5::Key& key) const {
-            return std::hash<std::string>()(key.valuesToString());
+            return key.hash();
         }
     };
 }
@@ -0,0 +1,87 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/database/LookupPool.h"
+
+#include <exception>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+LookupPool& LookupPool::instance() {
+    static LookupPool pool(size());
+    return pool;
+}
+
+size_t LookupPool::size() {
+    static size_t fdbRetrieveThreads = eckit::Resource<size_t>("fdbRetrieveThreads;$FDB_RETRIEVE_THREADS", 1);
+    return fdbRetrieveThreads;
+}
+
+LookupPool::LookupPool(size_t threads) :
+    stop_(false) {
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this] { run(); });
+    }
+}
+
+LookupPool::~LookupPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& t : threads_) {
+        t.join();
+    }
+}
+
+void LookupPool::submit(std::function<void()> task) {
+    ASSERT(!threads_.empty());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.emplace_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void LookupPool::run() {
+
+    for (;;) {
+
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        try {
+            task();
+        }
+        catch (std::exception& e) {
+            eckit::Log::error() << "LookupPool task failed: " << e.what() << std::endl;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
@@ -0,0 +1,67 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   LookupPool.h
+/// @date   Oct 2026
+
+#ifndef fdb5_LookupPool_H
+#define fdb5_LookupPool_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Threads shared by all the retrievals of the process, on which MultiRetrieveVisitor runs the index lookups
+/// of different databases concurrently. The number of threads is fixed (fdbRetrieveThreads), so concurrent
+/// retrievals queue for them rather than each starting their own.
+
+class LookupPool : private eckit::NonCopyable {
+
+public: // methods
+
+    static LookupPool& instance();
+
+    /// Number of lookup threads configured, 1 meaning lookups run on the calling thread
+    static size_t size();
+
+    /// Queues a task. Tasks must not throw, and must not wait for other tasks of the pool
+    void submit(std::function<void()> task);
+
+private: // methods
+
+    LookupPool(size_t threads);
+    ~LookupPool();
+
+    void run();
+
+private: // members
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_;
+
+    std::vector<std::thread> threads_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/database/MissingDatabases.h"
+
+#include "eckit/config/Resource.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MissingDatabases::MissingDatabases() {
+    static double fdbMissingDatabaseTTL = eckit::Resource<double>("fdbMissingDatabaseTTL;$FDB_MISSING_DATABASE_TTL", 0);
+    static size_t fdbMaxMissingDatabases = eckit::Resource<size_t>("fdbMaxMissingDatabases;$FDB_MAX_MISSING_DATABASES", 4096);
+
+    ttl_ = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(fdbMissingDatabaseTTL));
+    capacity_ = fdbMaxMissingDatabases;
+}
+
+bool MissingDatabases::contains(const Key& key) const {
+    return missing_.find(key) != missing_.end();
+}
+
+void MissingDatabases::insert(const Key& key) {
+    if (missing_.size() >= capacity_) {
+        missing_.clear();
+    }
+    missing_[key] = Clock::now();
+}
+
+void MissingDatabases::expire() {
+    if (missing_.empty()) {
+        return;
+    }
+
+    Clock::time_point limit = Clock::now() - ttl_;
+    for (auto it = missing_.begin(); it != missing_.end();) {
+        if (it->second <= limit) {
+            it = missing_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MissingDatabases::clear() {
+    missing_.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
@@ -0,0 +1,63 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MissingDatabases.h
+/// @date   Oct 2026
+
+#ifndef fdb5_MissingDatabases_H
+#define fdb5_MissingDatabases_H
+
+#include <chrono>
+#include <map>
+
+#include "eckit/memory/NonCopyable.h"
+
+#include "fdb5/database/Key.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Remembers the databases that a retrieval found not to exist, so that sparse requests do not
+/// retry opening them. Entries last for the remainder of the current request, and are kept across
+/// requests for at most fdbMissingDatabaseTTL seconds (default 0, i.e. not kept).
+
+class MissingDatabases : private eckit::NonCopyable {
+
+public: // methods
+
+    MissingDatabases();
+
+    bool contains(const Key& key) const;
+
+    void insert(const Key& key);
+
+    /// Drops the entries older than the TTL. Called at the start of each request.
+    void expire();
+
+    void clear();
+
+private: // types
+
+    using Clock = std::chrono::steady_clock;
+
+private: // members
+
+    std::map<Key, Clock::time_point> missing_;
+
+    Clock::duration ttl_;
+    size_t capacity_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
@@ -12,11 +12,18 @@
 
 #include <memory>
 
-#include "eckit/config/Resource.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+
 
 #include "fdb5/LibFdb5.h"
 #include "fdb5/database/DB.h"
 #include "fdb5/database/Key.h"
+#include "fdb5/database/LookupPool.h"
+#include "fdb5/database/MissingDatabases.h"
 #include "fdb5/io/HandleGatherer.h"
 #include "fdb5/types/Type.h"
 #include "fdb5/types/TypesRegistry.h"
@@ -30,17 +37,157 @@ namespace fdb5 {
 MultiRetrieveVisitor::MultiRetrieveVisitor(const Notifier& wind,
                                            InspectIterator& iterator,
                                            eckit::CacheLRU<Key,DB*>& databases,
+                                           MissingDatabases& missing,
                                            const Config& config) :
     db_(nullptr),
     wind_(wind),
     databases_(databases),
-    iterator_(iterator),
+    missing_(missing),
+    iterator_(&iterator),
     config_(config) {
+
+    threads_ = LookupPool::size();
+    defer_ = (threads_ > 1);
 }
 
 MultiRetrieveVisitor::~MultiRetrieveVisitor() {
 }
 
+void MultiRetrieveVisitor::lookup(DB& db, const std::vector<PendingDatum>& pending, const std::vector<size_t>& slots,
+                                  std::vector<std::unique_ptr<ListElement>>& results) const {
+
+    for (size_t slot : slots) {
+        const PendingDatum& p = pending[slot];
+
+        if (!db.selectIndex(p.index_)) {
+            continue;
+        }
+
+        Field field;
+        if (db.inspect(p.datum_, field)) {
+
+            Key simplifiedKey;
+            for (auto k = p.datum_.begin(); k != p.datum_.end(); k++) {
+                if (!k->second.empty())
+                    simplifiedKey.set(k->first, k->second);
+            }
+
+            results[slot].reset(new ListElement({db.key(), p.index_, simplifiedKey}, field.stableLocation(), field.timestamp()));
+        }
+    }
+}
+
+void MultiRetrieveVisitor::flush() {
+
+    if (pending_.empty()) {
+        return;
+    }
+
+    LOG_DEBUG_LIB(LibFdb5) << "MultiRetrieveVisitor looking up " << pending_.size() << " fields with "
+                           << threads_ << " threads" << std::endl;
+
+    std::vector<PendingDatum> pending;
+    std::swap(pending, pending_);
+
+    // Group the lookups by database, and by index within each database, so that each batch
+    // selects every index once
+
+    struct Batch {
+        DB* db_;
+        std::vector<size_t> slots_;
+        bool done_;
+        std::exception_ptr error_;
+    };
+
+    std::vector<Batch> batches;
+    std::vector<size_t> batchOf(pending.size());
+    std::map<DB*, size_t> index;
+    for (size_t i = 0; i < pending.size(); ++i) {
+        auto it = index.emplace(pending[i].db_, batches.size()).first;
+        if (it->second == batches.size()) {
+            batches.push_back(Batch{pending[i].db_, {}, false, nullptr});
+        }
+        batches[it->second].slots_.push_back(i);
+        batchOf[i] = it->second;
+    }
+    for (Batch& b : batches) {
+        std::stable_sort(b.slots_.begin(), b.slots_.end(),
+                         [&pending](size_t x, size_t y) { return pending[x].index_ < pending[y].index_; });
+    }
+
+    std::vector<std::unique_ptr<ListElement>> results(pending.size());
+
+    auto run = [&](Batch& b) {
+        try {
+            lookup(*b.db_, pending, b.slots_, results);
+        }
+        catch (...) {
+            b.error_ = std::current_exception();
+        }
+    };
+
+    // One task per database (catalogue readers are not thread safe), on the shared pool if there are lookup
+    // threads, or else on this thread as their fields come up. Fields are emitted in request order as soon as
+    // the lookups of their database are done.
+
+    bool parallel = (threads_ > 1);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t outstanding = 0;
+
+    if (parallel) {
+        outstanding = batches.size();
+        for (Batch& b : batches) {
+            Batch* batch = &b;
+            LookupPool::instance().submit([&, batch]() {
+                run(*batch);
+                std::lock_guard<std::mutex> lock(mutex);
+                batch->done_ = true;
+                --outstanding;
+                cv.notify_all();
+            });
+        }
+    }
+
+    std::exception_ptr error;
+    size_t next = 0;
+
+    while (next < pending.size()) {
+
+        Batch& b = batches[batchOf[next]];
+        if (parallel) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&b] { return b.done_; });
+        }
+        else if (!b.done_) {
+            run(b);
+            b.done_ = true;
+        }
+
+        if (b.error_) {
+            error = b.error_;
+            break;
+        }
+
+        if (results[next]) {
+            pending[next].iterator_->emplace(std::move(*results[next]));
+        }
+        ++next;
+    }
+
+    // The tasks refer to this frame, so wait for all of them even if one failed
+
+    if (parallel) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&outstanding] { return outstanding == 0; });
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
 // From Visitor
 
 bool MultiRetrieveVisitor::selectDatabase(const Key& key, const Key&) {
@@ -64,8 +211,26 @@ bool MultiRetrieveVisitor::selectDatabase(const Key& key, const Key&) {
         return true;
     }
 
+    /* is the DB known not to exist ? */
+
+    if (missing_.contains(key)) {
+        LOG_DEBUG_LIB(LibFdb5) << "FDB5 Database previously found missing " << key << std::endl;
+        return false;
+    }
+
+    if (!DB::mayExist(key, config_)) {
+        LOG_DEBUG_LIB(LibFdb5) << "Database does not exist " << key << std::endl;
+        missing_.insert(key);
+        return false;
+    }
+
     /* DB not yet open */
 
+    // Opening it may evict a database that deferred lookups still refer to
+    if (!pending_.empty() && databases_.size() >= databases_.capacity()) {
+        flush();
+    }
+
     //std::unique_ptr<DB> newDB( DBFactory::buildReader(key, config_) );
     std::unique_ptr<DB> newDB = DB::buildReader(key, config_);
 
@@ -81,6 +246,7 @@ bool MultiRetrieveVisitor::selectDatabase(const Key& key, const Key&) {
 
     if (!newDB->open()) {
         LOG_DEBUG_LIB(LibFdb5) << "Database does not exist " << key << std::endl;
+        missing_.insert(key);
         return false;
     } else {
         db_ = newDB.release();
@@ -99,6 +265,11 @@ bool MultiRetrieveVisitor::selectDatum(const Key& key, const Key& full) {
     ASSERT(db_);
     LOG_DEBUG_LIB(LibFdb5) << "selectDatum " << key << ", " << full << std::endl;
 
+    if (defer_) {
+        pending_.push_back(PendingDatum{db_, db_->indexKey(), key, iterator_});
+        return true;
+    }
+
     Field field;
     if (db_->inspect(key, field)) {
 
@@ -108,7 +279,7 @@ bool MultiRetrieveVisitor::selectDatum(const Key& key, const Key& full) {
                 simplifiedKey.set(k->first, k->second);
         }
 
-        iterator_.emplace(ListElement({db_->key(), db_->indexKey(), simplifiedKey}, field.stableLocation(), field.timestamp()));
+        iterator_->emplace(ListElement({db_->key(), db_->indexKey(), simplifiedKey}, field.stableLocation(), field.timestamp()));
         return true;
     }
 
@@ -18,6 +18,9 @@
 
 #include <string>
 
+#include <memory>
+#include <vector>
+
 #include "eckit/container/CacheLRU.h"
 #include "eckit/container/Queue.h"
 
@@ -29,6 +32,7 @@
 namespace fdb5 {
 
 class HandleGatherer;
+class MissingDatabases;
 class Notifier;
 
 class DB;
@@ -42,12 +46,35 @@ public: // methods
     MultiRetrieveVisitor(const Notifier& wind,
                          InspectIterator& queue,
                          eckit::CacheLRU<Key,DB*>& databases,
+                         MissingDatabases& missing,
                          const Config& config);
 
     ~MultiRetrieveVisitor();
 
+    /// Performs the index lookups deferred during expansion, and emits their results in request order
+    void flush();
+
+    /// Defers the index lookups until flush() regardless of the number of threads, so that the lookups of
+    /// several requests are grouped by database and index
+    void deferLookups() { defer_ = true; }
+
+    /// Emits the fields found from now on to another iterator, e.g. for the next request of a batch
+    void target(InspectIterator& iterator) { iterator_ = &iterator; }
+
+private:  // types
+
+    struct PendingDatum {
+        DB* db_;
+        Key index_;
+        Key datum_;
+        InspectIterator* iterator_;
+    };
+
 private:  // methods
 
+    void lookup(DB& db, const std::vector<PendingDatum>& pending, const std::vector<size_t>& slots,
+                std::vector<std::unique_ptr<ListElement>>& results) const;
+
     // From Visitor
 
     virtual bool selectDatabase(const Key &key, const Key &full) override;
@@ -73,9 +100,17 @@ private:
 
     eckit::CacheLRU<Key,DB*>& databases_;
 
-    InspectIterator& iterator_;
+    MissingDatabases& missing_;
+
+    InspectIterator* iterator_;
 
     Config config_;
+
+    /// With more than one thread, datum lookups are deferred until the request is fully expanded, then run
+    /// concurrently on the LookupPool, one task per database (catalogue readers are not thread safe)
+    size_t threads_;
+    bool defer_;
+    std::vector<PendingDatum> pending_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -24,6 +24,15 @@ namespace fdb5 {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+std::vector<std::unique_ptr<FieldLocation>> Store::archive(const Key& key, const std::vector<ArchiveItem>& fields) {
+    std::vector<std::unique_ptr<FieldLocation>> result;
+    result.reserve(fields.size());
+    for (const ArchiveItem& field : fields) {
+        result.emplace_back(archive(key, field.data_, field.length_));
+    }
+    return result;
+}
+
 bool Store::canMoveTo(const Key&, const Config&, const eckit::URI& dest) const {
     std::stringstream ss;
     ss << "Store type " << type() << " does not support move" << std::endl;
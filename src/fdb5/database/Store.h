@@ -21,6 +21,7 @@
 
 #include "fdb5/api/helpers/MoveIterator.h"
 #include "fdb5/config/Config.h"
+#include "fdb5/database/ArchiveItem.h"
 #include "fdb5/database/DB.h"
 #include "fdb5/database/Field.h"
 #include "fdb5/database/FieldLocation.h"
@@ -38,6 +39,9 @@ public:
     virtual eckit::DataHandle* retrieve(Field& field) const = 0;
     virtual std::unique_ptr<FieldLocation> archive(const Key &key, const void *data, eckit::Length length) = 0;
 
+    /// Archives fields of the same index, given by key. By default they are archived one after the other
+    virtual std::vector<std::unique_ptr<FieldLocation>> archive(const Key &key, const std::vector<ArchiveItem>& fields);
+
     virtual void remove(const eckit::URI& uri, std::ostream& logAlways, std::ostream& logVerbose, bool doit = true) const = 0;
 
     friend std::ostream &operator<<(std::ostream &s, const Store &x);
@@ -48,6 +52,9 @@ public:
     virtual void flush() = 0;
     virtual void close() = 0;
 
+    /// Estimate of the memory held for writing, mostly by the buffers of the open data handles
+    virtual size_t footprint() const { return 0; }
+
 //    virtual std::string owner() const = 0;
     virtual bool exists() const = 0;
     virtual void checkUID() const = 0;
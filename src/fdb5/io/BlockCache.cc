@@ -0,0 +1,149 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/io/BlockCache.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <sstream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+
+#include "fdb5/LibFdb5.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+BlockCache& BlockCache::instance() {
+    static BlockCache cache;
+    return cache;
+}
+
+BlockCache::BlockCache() :
+    capacity_(eckit::Resource<size_t>("fdbReadCacheSize;$FDB_READ_CACHE_SIZE", 0)),
+    blockSize_(eckit::Resource<size_t>("fdbReadCacheBlockSize;$FDB_READ_CACHE_BLOCK_SIZE", 1024 * 1024)),
+    used_(0),
+    stats_{0, 0, 0, 0} {
+
+    ASSERT(blockSize_ > 0);
+    LOG_DEBUG_LIB(LibFdb5) << "BlockCache capacity " << capacity_ << ", block size " << blockSize_ << std::endl;
+}
+
+size_t BlockCache::readFully(int fd, const eckit::PathName& path, char* buffer, size_t length, off_t offset) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = ::pread(fd, buffer + done, length - done, offset + done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::ostringstream ss;
+            ss << path << ": cannot read at " << (offset + done);
+            throw eckit::ReadError(ss.str());
+        }
+        if (n == 0) {
+            break;
+        }
+        done += n;
+    }
+    return done;
+}
+
+std::shared_ptr<const BlockCache::Block> BlockCache::get(const eckit::PathName& path, int fd, off_t offset,
+                                                         size_t size, size_t minLength) {
+
+    std::ostringstream os;
+    os << path << ':' << offset << ':' << size;
+    std::string key = os.str();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            if (it->second->block_->length_ >= minLength) {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                stats_.hits_++;
+                return it->second->block_;
+            }
+            used_ -= it->second->block_->data_.size();
+            lru_.erase(it->second);
+            index_.erase(it);
+        }
+        stats_.misses_++;
+    }
+
+    // Read outside the lock. Concurrent misses on the same block may both read it, which is harmless.
+
+    std::shared_ptr<Block> block = std::make_shared<Block>();
+    block->data_.resize(size);
+    block->length_ = readFully(fd, path, block->data_.data(), size, offset);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    stats_.bytesRead_ += block->length_;
+
+    if (size > capacity_ || index_.find(key) != index_.end() || !admit(key)) {
+        return block;
+    }
+
+    lru_.push_front(Entry{key, block});
+    index_[key] = lru_.begin();
+    used_ += size;
+
+    while (used_ > capacity_ && !lru_.empty()) {
+        used_ -= lru_.back().block_->data_.size();
+        index_.erase(lru_.back().key_);
+        lru_.pop_back();
+        stats_.evictions_++;
+    }
+
+    return block;
+}
+
+bool BlockCache::admit(const std::string& key) {
+
+    static bool fdbReadCacheAdmitFirstRead = eckit::Resource<bool>("fdbReadCacheAdmitFirstRead;$FDB_READ_CACHE_ADMIT_FIRST_READ", false);
+    if (fdbReadCacheAdmitFirstRead) {
+        return true;
+    }
+
+    auto it = seenIndex_.find(key);
+    if (it != seenIndex_.end()) {
+        seen_.erase(it->second);
+        seenIndex_.erase(it);
+        return true;
+    }
+
+    seen_.push_front(key);
+    seenIndex_[key] = seen_.begin();
+
+    size_t maxSeen = std::max(capacity_ / blockSize_, size_t(1));
+    while (seen_.size() > maxSeen) {
+        seenIndex_.erase(seen_.back());
+        seen_.pop_back();
+    }
+
+    return false;
+}
+
+BlockCache::Statistics BlockCache::takeStatistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Statistics result = stats_;
+    stats_ = Statistics{0, 0, 0, 0};
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
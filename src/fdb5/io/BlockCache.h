@@ -0,0 +1,114 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   BlockCache.h
+/// @date   Oct 2026
+
+#ifndef fdb5_io_BlockCache_H
+#define fdb5_io_BlockCache_H
+
+#include <sys/types.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Process-wide LRU cache of aligned blocks of data files, keyed by (path, block offset), within a byte budget
+/// (fdbReadCacheSize, 0 disables it). Shared by all the BlockPartFileHandles of the process, so that fields
+/// read repeatedly, or neighbours of fields read earlier, are served from memory.
+///
+/// A block is only admitted the second time it is read, so that a single scan through a large amount of data
+/// does not flush the blocks that are actually reused. The blocks read once are remembered, without their
+/// data, in a list as long as the cache holds blocks.
+
+class BlockCache : private eckit::NonCopyable {
+
+public: // types
+
+    struct Block {
+        std::vector<char> data_;
+        size_t length_;    ///< valid bytes, shorter than the block at the end of a file
+    };
+
+    struct Statistics {
+        size_t hits_;
+        size_t misses_;
+        size_t evictions_;
+        size_t bytesRead_;
+    };
+
+public: // methods
+
+    static BlockCache& instance();
+
+    bool enabled() const { return capacity_ > 0; }
+
+    /// Block size used when reading through the cache (fdbReadCacheBlockSize)
+    size_t blockSize() const { return blockSize_; }
+
+    /// Returns the block of the given size at offset, reading it from fd on a miss. A cached block with fewer
+    /// than minLength valid bytes (the file has grown since) is read again.
+    std::shared_ptr<const Block> get(const eckit::PathName& path, int fd, off_t offset, size_t size, size_t minLength);
+
+    /// Returns the statistics accumulated since the previous call, so that they are reported once however
+    /// many FDB instances of the process share the cache
+    Statistics takeStatistics();
+
+    /// Reads up to length bytes at offset, stopping short only at end of file. Returns the bytes read.
+    static size_t readFully(int fd, const eckit::PathName& path, char* buffer, size_t length, off_t offset);
+
+private: // types
+
+    struct Entry {
+        std::string key_;
+        std::shared_ptr<const Block> block_;
+    };
+
+    typedef std::list<Entry> LRU;
+    typedef std::list<std::string> Seen;
+
+private: // methods
+
+    BlockCache();
+
+    /// Whether a block just read should be cached. Called with the lock held
+    bool admit(const std::string& key);
+
+private: // members
+
+    size_t capacity_;
+    size_t blockSize_;
+
+    mutable std::mutex mutex_;
+    LRU lru_;    ///< most recently used first
+    std::unordered_map<std::string, LRU::iterator> index_;
+    size_t used_;
+
+    Seen seen_;    ///< blocks read once and not cached, most recent first
+    std::unordered_map<std::string, Seen::iterator> seenIndex_;
+
+    Statistics stats_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif // fdb5_io_BlockCache_H
@@ -0,0 +1,239 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/io/BlockPartFileHandle.h"
+#include "fdb5/io/BlockCache.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <numeric>
+#include <sstream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/log/Log.h"
+
+using namespace eckit;
+
+namespace fdb5 {
+
+//--------------------------------------------------------------------------------------------------
+
+::eckit::ClassSpec BlockPartFileHandle::classSpec_ = {
+    &DataHandle::classSpec(),
+    "BlockPartFileHandle",
+};
+::eckit::Reanimator<BlockPartFileHandle> BlockPartFileHandle::reanimator_;
+
+size_t BlockPartFileHandle::blockSize() {
+    static size_t fdbDataBlockSize = eckit::Resource<size_t>("fdbDataBlockSize;$FDB_DATA_BLOCK_SIZE", 0);
+    return fdbDataBlockSize;
+}
+
+size_t BlockPartFileHandle::readBlockSize(size_t layoutBlockSize) {
+    size_t size = layoutBlockSize;
+    if (size == 0 && BlockCache::instance().enabled()) {
+        size = BlockCache::instance().blockSize();
+    }
+    return size;
+}
+
+void BlockPartFileHandle::print(std::ostream& s) const
+{
+    if (format(s) == Log::compactFormat)
+        s << "BlockPartFileHandle";
+    else
+        s << "BlockPartFileHandle[path=" << name_
+          << ",blockSize=" << blockSize_
+          << ",parts=" << offsets_.size() << ']';
+}
+
+BlockPartFileHandle::BlockPartFileHandle(const PathName& name,
+                                         const Offset& offset,
+                                         const Length& length,
+                                         size_t blockSize):
+    name_(name),
+    blockSize_(blockSize),
+    fd_(-1),
+    part_(0),
+    pos_(0),
+    block_(0),
+    blockData_(nullptr),
+    blockIndex_(-1),
+    blockLength_(0) {
+    ASSERT(blockSize_ > 0);
+    offsets_.push_back(offset);
+    lengths_.push_back(length);
+}
+
+BlockPartFileHandle::~BlockPartFileHandle() {
+    if (fd_ >= 0) {
+        Log::warning() << "Closing BlockPartFileHandle " << name_ << std::endl;
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+DataHandle* BlockPartFileHandle::clone() const {
+    BlockPartFileHandle* h = new BlockPartFileHandle(name_, offsets_[0], lengths_[0], blockSize_);
+    h->offsets_ = offsets_;
+    h->lengths_ = lengths_;
+    return h;
+}
+
+bool BlockPartFileHandle::merge(DataHandle* other) {
+    BlockPartFileHandle* h = dynamic_cast<BlockPartFileHandle*>(other);
+    if (!h || h->name_ != name_ || h->blockSize_ != blockSize_) {
+        return false;
+    }
+    offsets_.insert(offsets_.end(), h->offsets_.begin(), h->offsets_.end());
+    lengths_.insert(lengths_.end(), h->lengths_.begin(), h->lengths_.end());
+    return true;
+}
+
+bool BlockPartFileHandle::compress(bool sorted) {
+
+    if (!sorted) {
+        return false;
+    }
+
+    // Visit the parts in file order, so that each block is read once
+
+    std::vector<size_t> order(offsets_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return offsets_[a] < offsets_[b]; });
+
+    std::vector<Offset> offsets;
+    std::vector<Length> lengths;
+    offsets.reserve(order.size());
+    lengths.reserve(order.size());
+    for (size_t i : order) {
+        offsets.push_back(offsets_[i]);
+        lengths.push_back(lengths_[i]);
+    }
+    std::swap(offsets_, offsets);
+    std::swap(lengths_, lengths);
+
+    return true;
+}
+
+Length BlockPartFileHandle::openForRead() {
+
+    ASSERT(fd_ < 0);
+    fd_ = ::open(name_.localPath(), O_RDONLY);
+    if (fd_ < 0) {
+        throw CantOpenFile(name_, errno == ENOENT);
+    }
+
+    rewind();
+    return estimate();
+}
+
+void BlockPartFileHandle::loadBlock(unsigned long long block, size_t minLength) {
+
+    off_t off = block * blockSize_;
+
+    BlockCache& cache = BlockCache::instance();
+    if (cache.enabled()) {
+        cached_ = cache.get(name_, fd_, off, blockSize_, minLength);
+        blockData_ = cached_->data_.data();
+        blockLength_ = cached_->length_;
+    }
+    else {
+        if (block_.size() < blockSize_) {
+            block_.resize(blockSize_);
+        }
+        blockLength_ = BlockCache::readFully(fd_, name_, static_cast<char*>(block_.data()), blockSize_, off);
+        blockData_ = static_cast<const char*>(block_.data());
+    }
+
+    blockIndex_ = block;
+}
+
+long BlockPartFileHandle::read(void* buffer, long length) {
+
+    ASSERT(fd_ >= 0);
+
+    char* out = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (total < length && part_ < offsets_.size()) {
+
+        long long partLength = lengths_[part_];
+        if (pos_ >= partLength) {
+            ++part_;
+            pos_ = 0;
+            continue;
+        }
+
+        unsigned long long absolute = static_cast<long long>(offsets_[part_]) + pos_;
+        unsigned long long block = absolute / blockSize_;
+        size_t inBlock = absolute - block * blockSize_;
+
+        if (static_cast<long long>(block) != blockIndex_ || inBlock >= blockLength_) {
+            loadBlock(block, inBlock + 1);
+        }
+
+        if (inBlock >= blockLength_) {
+            std::ostringstream ss;
+            ss << name_ << ": unexpected end of file at " << absolute;
+            throw ReadError(ss.str());
+        }
+
+        long n = std::min<long long>(std::min<long long>(partLength - pos_, blockLength_ - inBlock), length - total);
+        ::memcpy(out + total, blockData_ + inBlock, n);
+
+        pos_ += n;
+        total += n;
+    }
+
+    return total;
+}
+
+void BlockPartFileHandle::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    else {
+        Log::warning() << "Closing BlockPartFileHandle " << name_ << ", file is not opened" << std::endl;
+    }
+    blockIndex_ = -1;
+    blockLength_ = 0;
+    cached_.reset();
+}
+
+void BlockPartFileHandle::rewind() {
+    part_ = 0;
+    pos_ = 0;
+}
+
+Length BlockPartFileHandle::size() {
+    return estimate();
+}
+
+Length BlockPartFileHandle::estimate() {
+    long long total = 0;
+    for (const Length& l : lengths_) {
+        total += l;
+    }
+    return total;
+}
+
+std::string BlockPartFileHandle::title() const {
+    return PathName::shorten(name_);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
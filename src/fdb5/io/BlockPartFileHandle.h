@@ -0,0 +1,123 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   BlockPartFileHandle.h
+/// @date   Oct 2026
+
+#ifndef fdb5_io_BlockPartFileHandle_h
+#define fdb5_io_BlockPartFileHandle_h
+
+#include <memory>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/Offset.h"
+
+#include "fdb5/io/BlockCache.h"
+
+namespace fdb5 {
+
+//-----------------------------------------------------------------------------
+
+// Reads small fields of one data file by whole aligned blocks. Handles on the same file
+// merge, and each block is read once for all the fields it contains (provided the fields
+// are visited in offset order, as they are once sorted), and the fields are then sliced
+// from memory. Pairs with the block-aligned layout written by TocStore (dataBlockSize), whose
+// block size is recorded with each field.
+// Blocks are shared between handles through the BlockCache when it is enabled.
+
+class BlockPartFileHandle : public eckit::DataHandle {
+public:
+
+    /// Default block size used to lay out new data files, 0 if disabled (fdbDataBlockSize)
+    static size_t blockSize();
+
+    /// Block size used to read small fields: the block size the field was laid out with, or else that of
+    /// the BlockCache if enabled
+    static size_t readBlockSize(size_t layoutBlockSize);
+
+// -- Contructors
+
+    BlockPartFileHandle(const eckit::PathName&,
+                        const eckit::Offset&,
+                        const eckit::Length&,
+                        size_t blockSize);
+    BlockPartFileHandle(eckit::Stream&) { NOTIMP; }
+    ~BlockPartFileHandle() override;
+
+	// From DataHandle
+
+    eckit::Length openForRead() override;
+    void openForWrite(const eckit::Length&) override { NOTIMP; }
+    void openForAppend(const eckit::Length&) override { NOTIMP; }
+
+    long read(void*,long) override;
+    long write(const void*,long) override { NOTIMP; }
+    void close() override;
+    void rewind() override;
+
+    void print(std::ostream&) const override;
+    bool merge(DataHandle*) override;
+    bool compress(bool = false) override;
+    eckit::Length size() override;
+    eckit::Length estimate() override;
+
+    void restartReadFrom(const eckit::Offset&) override { NOTIMP; }
+    eckit::Offset seek(const eckit::Offset&) override { NOTIMP; }
+    bool canSeek() const override { return false; }
+
+    void toRemote(eckit::Stream&) const override { NOTIMP; }
+
+    std::string title() const override;
+    bool moveable() const override { return false; }
+    eckit::DataHandle* clone() const override;
+
+	// From Streamable
+
+    void encode(eckit::Stream&) const override { NOTIMP; }
+    const eckit::ReanimatorBase& reanimator() const override { return reanimator_; }
+
+private: // methods
+
+    void loadBlock(unsigned long long block, size_t minLength);
+
+private: // members
+
+    eckit::PathName name_;
+    size_t          blockSize_;
+
+    std::vector<eckit::Offset> offsets_;
+    std::vector<eckit::Length> lengths_;
+
+    int             fd_;
+    size_t          part_;
+    long long       pos_;     ///< position within the current part
+
+    eckit::Buffer   block_;        ///< block read directly, when the BlockCache is disabled
+    std::shared_ptr<const BlockCache::Block> cached_;
+    const char*     blockData_;
+    long long       blockIndex_;   ///< block held in block_, -1 if none
+    size_t          blockLength_;  ///< valid bytes in block_ (shorter at end of file)
+
+    // For Streamable
+
+    static eckit::ClassSpec classSpec_;
+    static eckit::Reanimator<BlockPartFileHandle> reanimator_;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/io/ChecksumCheckingHandle.h"
+
+#include <sstream>
+
+#include "eckit/log/Log.h"
+
+using namespace eckit;
+
+namespace fdb5 {
+
+//--------------------------------------------------------------------------------------------------
+
+::eckit::ClassSpec ChecksumCheckingHandle::classSpec_ = {
+    &DataHandle::classSpec(),
+    "ChecksumCheckingHandle",
+};
+::eckit::Reanimator<ChecksumCheckingHandle> ChecksumCheckingHandle::reanimator_;
+
+ChecksumCheckingHandle::ChecksumCheckingHandle(DataHandle* handle, uint32_t checksum) :
+    handle_(handle),
+    checksum_(checksum),
+    expected_(0),
+    read_(0) {
+    ASSERT(handle_);
+}
+
+ChecksumCheckingHandle::~ChecksumCheckingHandle() {}
+
+void ChecksumCheckingHandle::print(std::ostream& s) const {
+    if (format(s) == Log::compactFormat)
+        s << "ChecksumCheckingHandle";
+    else
+        s << "ChecksumCheckingHandle[handle=" << *handle_
+          << ",crc32c=" << std::hex << checksum_ << std::dec << ']';
+}
+
+DataHandle* ChecksumCheckingHandle::clone() const {
+    return new ChecksumCheckingHandle(handle_->clone(), checksum_);
+}
+
+Length ChecksumCheckingHandle::openForRead() {
+    crc_ = Crc32c();
+    read_ = 0;
+    Length len = handle_->openForRead();
+    expected_ = len;
+    return len;
+}
+
+long ChecksumCheckingHandle::read(void* buffer, long length) {
+
+    long len = handle_->read(buffer, length);
+
+    if (len > 0) {
+        bool complete = (read_ < expected_);
+        crc_.update(buffer, len);
+        read_ += len;
+        complete = complete && (read_ >= expected_);
+
+        if (complete && crc_.value() != checksum_) {
+            std::ostringstream ss;
+            ss << "Checksum mismatch reading " << *handle_ << ": expected crc32c " << std::hex << checksum_
+               << ", found " << crc_.value();
+            throw ReadError(ss.str());
+        }
+    }
+
+    return len;
+}
+
+void ChecksumCheckingHandle::close() {
+    handle_->close();
+}
+
+Length ChecksumCheckingHandle::size() {
+    return handle_->size();
+}
+
+Length ChecksumCheckingHandle::estimate() {
+    return handle_->estimate();
+}
+
+std::string ChecksumCheckingHandle::title() const {
+    return handle_->title();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
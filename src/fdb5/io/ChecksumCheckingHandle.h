@@ -0,0 +1,95 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ChecksumCheckingHandle.h
+/// @date   Oct 2026
+
+#ifndef fdb5_io_ChecksumCheckingHandle_h
+#define fdb5_io_ChecksumCheckingHandle_h
+
+#include <cstdint>
+#include <memory>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/Offset.h"
+
+#include "fdb5/io/Crc32c.h"
+
+namespace fdb5 {
+
+//-----------------------------------------------------------------------------
+
+// Reads a single field through another handle, computing the CRC-32C of the data as
+// it streams past. Once the whole field has been read the checksum is compared with
+// the one recorded at archive time, and a mismatch raises a ReadError.
+
+class ChecksumCheckingHandle : public eckit::DataHandle {
+public:
+
+// -- Contructors
+
+    ChecksumCheckingHandle(eckit::DataHandle* handle, uint32_t checksum);
+    ChecksumCheckingHandle(eckit::Stream&) { NOTIMP; }
+    ~ChecksumCheckingHandle() override;
+
+	// From DataHandle
+
+    eckit::Length openForRead() override;
+    void openForWrite(const eckit::Length&) override { NOTIMP; }
+    void openForAppend(const eckit::Length&) override { NOTIMP; }
+
+    long read(void*,long) override;
+    long write(const void*,long) override { NOTIMP; }
+    void close() override;
+    void rewind() override { NOTIMP; }
+
+    void print(std::ostream&) const override;
+    bool merge(DataHandle*) override { return false; }
+    bool compress(bool = false) override { return false; }
+    eckit::Length size() override;
+    eckit::Length estimate() override;
+
+    void restartReadFrom(const eckit::Offset&) override { NOTIMP; }
+    eckit::Offset seek(const eckit::Offset&) override { NOTIMP; }
+    bool canSeek() const override { return false; }
+
+    void toRemote(eckit::Stream&) const override { NOTIMP; }
+
+    std::string title() const override;
+    bool moveable() const override { return handle_->moveable(); }
+    eckit::DataHandle* clone() const override;
+
+	// From Streamable
+
+    void encode(eckit::Stream&) const override { NOTIMP; }
+    const eckit::ReanimatorBase& reanimator() const override { return reanimator_; }
+
+private: // members
+
+    std::unique_ptr<eckit::DataHandle> handle_;
+    uint32_t        checksum_;
+
+    Crc32c          crc_;
+    unsigned long long expected_;
+    unsigned long long read_;
+
+    // For Streamable
+
+    static eckit::ClassSpec classSpec_;
+    static eckit::Reanimator<ChecksumCheckingHandle> reanimator_;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
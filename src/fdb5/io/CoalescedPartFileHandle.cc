@@ -0,0 +1,192 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/io/CoalescedPartFileHandle.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/log/Log.h"
+
+using namespace eckit;
+
+namespace fdb5 {
+
+//--------------------------------------------------------------------------------------------------
+
+::eckit::ClassSpec CoalescedPartFileHandle::classSpec_ = {
+    &DataHandle::classSpec(),
+    "CoalescedPartFileHandle",
+};
+::eckit::Reanimator<CoalescedPartFileHandle> CoalescedPartFileHandle::reanimator_;
+
+void CoalescedPartFileHandle::print(std::ostream& s) const
+{
+    if (format(s) == Log::compactFormat)
+        s << "CoalescedPartFileHandle";
+    else
+        s << "CoalescedPartFileHandle[path=" << name_
+          << ",offset=" << offsets_.front()
+          << ",end=" << end_
+          << ",parts=" << offsets_.size() << ']';
+}
+
+CoalescedPartFileHandle::CoalescedPartFileHandle(const PathName& name,
+                                                 const std::vector<Offset>& offsets,
+                                                 const std::vector<Length>& lengths):
+    name_(name),
+    offsets_(offsets),
+    lengths_(lengths),
+    end_(0),
+    fd_(-1),
+    part_(0),
+    pos_(0),
+    chunk_(0),
+    chunkStart_(0),
+    chunkLength_(0) {
+
+    ASSERT(!offsets_.empty());
+    ASSERT(offsets_.size() == lengths_.size());
+    for (size_t i = 1; i < offsets_.size(); ++i) {
+        ASSERT(static_cast<long long>(offsets_[i]) >=
+               static_cast<long long>(offsets_[i - 1]) + static_cast<long long>(lengths_[i - 1]));
+    }
+    end_ = static_cast<long long>(offsets_.back()) + static_cast<long long>(lengths_.back());
+}
+
+CoalescedPartFileHandle::~CoalescedPartFileHandle() {
+    if (fd_ >= 0) {
+        Log::warning() << "Closing CoalescedPartFileHandle " << name_ << std::endl;
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+DataHandle* CoalescedPartFileHandle::clone() const {
+    return new CoalescedPartFileHandle(name_, offsets_, lengths_);
+}
+
+Length CoalescedPartFileHandle::openForRead() {
+
+    ASSERT(fd_ < 0);
+    fd_ = ::open(name_.localPath(), O_RDONLY);
+    if (fd_ < 0) {
+        throw CantOpenFile(name_, errno == ENOENT);
+    }
+
+    rewind();
+    return estimate();
+}
+
+void CoalescedPartFileHandle::fill(unsigned long long from) {
+
+    static size_t fdbReadCoalesceChunk = eckit::Resource<size_t>("fdbReadCoalesceChunk", 8 * 1024 * 1024);
+
+    size_t length = std::min<unsigned long long>(fdbReadCoalesceChunk, end_ - from);
+    if (chunk_.size() < length) {
+        chunk_.resize(length);
+    }
+
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = ::pread(fd_, static_cast<char*>(chunk_.data()) + done, length - done, from + done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::ostringstream ss;
+            ss << name_ << ": cannot read at " << (from + done);
+            throw ReadError(ss.str());
+        }
+        if (n == 0) {
+            std::ostringstream ss;
+            ss << name_ << ": unexpected end of file at " << (from + done);
+            throw ReadError(ss.str());
+        }
+        done += n;
+    }
+
+    chunkStart_ = from;
+    chunkLength_ = length;
+}
+
+long CoalescedPartFileHandle::read(void* buffer, long length) {
+
+    ASSERT(fd_ >= 0);
+
+    char* out = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (total < length && part_ < offsets_.size()) {
+
+        long long partLength = lengths_[part_];
+        if (pos_ >= partLength) {
+            ++part_;
+            pos_ = 0;
+            continue;
+        }
+
+        unsigned long long absolute = static_cast<long long>(offsets_[part_]) + pos_;
+        if (absolute < chunkStart_ || absolute >= chunkStart_ + chunkLength_) {
+            fill(absolute);
+        }
+
+        size_t inChunk = absolute - chunkStart_;
+        long n = std::min<long long>(std::min<long long>(partLength - pos_, chunkLength_ - inChunk), length - total);
+        ::memcpy(out + total, static_cast<const char*>(chunk_.data()) + inChunk, n);
+
+        pos_ += n;
+        total += n;
+    }
+
+    return total;
+}
+
+void CoalescedPartFileHandle::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    else {
+        Log::warning() << "Closing CoalescedPartFileHandle " << name_ << ", file is not opened" << std::endl;
+    }
+    chunkLength_ = 0;
+}
+
+void CoalescedPartFileHandle::rewind() {
+    part_ = 0;
+    pos_ = 0;
+}
+
+Length CoalescedPartFileHandle::size() {
+    return estimate();
+}
+
+Length CoalescedPartFileHandle::estimate() {
+    long long total = 0;
+    for (const Length& l : lengths_) {
+        total += l;
+    }
+    return total;
+}
+
+std::string CoalescedPartFileHandle::title() const {
+    return PathName::shorten(name_);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
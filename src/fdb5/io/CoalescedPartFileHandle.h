@@ -0,0 +1,106 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   CoalescedPartFileHandle.h
+/// @date   Oct 2026
+
+#ifndef fdb5_io_CoalescedPartFileHandle_h
+#define fdb5_io_CoalescedPartFileHandle_h
+
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/Offset.h"
+
+namespace fdb5 {
+
+//-----------------------------------------------------------------------------
+
+// Reads ordered, non-overlapping ranges of one file that lie close together with large
+// sequential reads covering the small gaps between them. The gap bytes are read and
+// discarded, and only the ranges are returned.
+
+class CoalescedPartFileHandle : public eckit::DataHandle {
+public:
+
+// -- Contructors
+
+    CoalescedPartFileHandle(const eckit::PathName&,
+                            const std::vector<eckit::Offset>&,
+                            const std::vector<eckit::Length>&);
+    CoalescedPartFileHandle(eckit::Stream&) { NOTIMP; }
+    ~CoalescedPartFileHandle() override;
+
+	// From DataHandle
+
+    eckit::Length openForRead() override;
+    void openForWrite(const eckit::Length&) override { NOTIMP; }
+    void openForAppend(const eckit::Length&) override { NOTIMP; }
+
+    long read(void*,long) override;
+    long write(const void*,long) override { NOTIMP; }
+    void close() override;
+    void rewind() override;
+
+    void print(std::ostream&) const override;
+    bool merge(DataHandle*) override { return false; }
+    bool compress(bool = false) override { return false; }
+    eckit::Length size() override;
+    eckit::Length estimate() override;
+
+    void restartReadFrom(const eckit::Offset&) override { NOTIMP; }
+    eckit::Offset seek(const eckit::Offset&) override { NOTIMP; }
+    bool canSeek() const override { return false; }
+
+    void toRemote(eckit::Stream&) const override { NOTIMP; }
+
+    std::string title() const override;
+    bool moveable() const override { return false; }
+    eckit::DataHandle* clone() const override;
+
+	// From Streamable
+
+    void encode(eckit::Stream&) const override { NOTIMP; }
+    const eckit::ReanimatorBase& reanimator() const override { return reanimator_; }
+
+private: // methods
+
+    void fill(unsigned long long from);
+
+private: // members
+
+    eckit::PathName name_;
+    std::vector<eckit::Offset> offsets_;
+    std::vector<eckit::Length> lengths_;
+    unsigned long long end_;    ///< end of the last range
+
+    int             fd_;
+    size_t          part_;
+    long long       pos_;       ///< position within the current range
+
+    eckit::Buffer   chunk_;
+    unsigned long long chunkStart_;
+    size_t          chunkLength_;
+
+    // For Streamable
+
+    static eckit::ClassSpec classSpec_;
+    static eckit::Reanimator<CoalescedPartFileHandle> reanimator_;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/io/CompressedPartFileHandle.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "eckit/log/Log.h"
+#include "eckit/utils/Compressor.h"
+
+using namespace eckit;
+
+namespace fdb5 {
+
+//--------------------------------------------------------------------------------------------------
+
+::eckit::ClassSpec CompressedPartFileHandle::classSpec_ = {
+    &DataHandle::classSpec(),
+    "CompressedPartFileHandle",
+};
+::eckit::Reanimator<CompressedPartFileHandle> CompressedPartFileHandle::reanimator_;
+
+const void* CompressedPartFileHandle::compress(const Compressor& compressor, const void* data, size_t length,
+                                               Buffer& out, size_t& outLength) {
+    outLength = compressor.compress(data, length, out);
+    if (outLength >= length) {
+        outLength = length;
+        return data;
+    }
+    return out.data();
+}
+
+void CompressedPartFileHandle::print(std::ostream& s) const
+{
+    if (format(s) == Log::compactFormat)
+        s << "CompressedPartFileHandle";
+    else {
+        s << "CompressedPartFileHandle[path=" << name_ << ",codec=" << codec_ << ",parts=";
+        for (size_t i = 0; i < offset_.size(); ++i) {
+            if (i) {
+                s << ',';
+            }
+            s << '(' << offset_[i] << ',' << stored_[i] << ',' << length_[i] << ')';
+        }
+        s << ']';
+    }
+}
+
+CompressedPartFileHandle::CompressedPartFileHandle(const PathName& name,
+                                                   const Offset& offset,
+                                                   const Length& storedLength,
+                                                   const Length& length,
+                                                   const std::string& codec):
+    name_(name),
+    offset_(1, offset),
+    stored_(1, storedLength),
+    length_(1, length),
+    codec_(codec),
+    readBuffer_(0),
+    buffer_(0),
+    loaded_(-1),
+    part_(0),
+    pos_(0) {}
+
+CompressedPartFileHandle::CompressedPartFileHandle(const PathName& name,
+                                                   const std::vector<Offset>& offsets,
+                                                   const std::vector<Length>& storedLengths,
+                                                   const std::vector<Length>& lengths,
+                                                   const std::string& codec):
+    name_(name),
+    offset_(offsets),
+    stored_(storedLengths),
+    length_(lengths),
+    codec_(codec),
+    readBuffer_(0),
+    buffer_(0),
+    loaded_(-1),
+    part_(0),
+    pos_(0) {
+    ASSERT(offset_.size() == stored_.size());
+    ASSERT(offset_.size() == length_.size());
+}
+
+CompressedPartFileHandle::~CompressedPartFileHandle() {}
+
+DataHandle* CompressedPartFileHandle::clone() const {
+    return new CompressedPartFileHandle(name_, offset_, stored_, length_, codec_);
+}
+
+bool CompressedPartFileHandle::compress(bool) {
+    return false;
+}
+
+void CompressedPartFileHandle::load(size_t part) {
+
+    ASSERT(file_);
+
+    size_t stored = stored_[part];
+    size_t length = length_[part];
+
+    if (buffer_.size() < length) {
+        buffer_.resize(length);
+    }
+
+    file_->seek(offset_[part]);
+
+    if (stored == length) {
+        ASSERT(file_->read(buffer_, stored) == static_cast<long>(stored));
+    }
+    else {
+        if (readBuffer_.size() < stored) {
+            readBuffer_.resize(stored);
+        }
+        ASSERT(file_->read(readBuffer_, stored) == static_cast<long>(stored));
+
+        if (!compressor_) {
+            compressor_.reset(CompressorFactory::instance().build(codec_));
+        }
+        compressor_->uncompress(readBuffer_.data(), stored, buffer_, length);
+    }
+
+    loaded_ = part;
+}
+
+Length CompressedPartFileHandle::openForRead() {
+    file_.reset(name_.fileHandle());
+    file_->openForRead();
+    loaded_ = -1;
+    part_ = 0;
+    pos_ = 0;
+    return estimate();
+}
+
+long CompressedPartFileHandle::read(void* buffer, long length) {
+
+    char* out = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (total < length && part_ < length_.size()) {
+
+        size_t partLength = length_[part_];
+
+        if (pos_ < partLength) {
+            if (loaded_ != static_cast<long>(part_)) {
+                load(part_);
+            }
+            size_t n = std::min(partLength - pos_, static_cast<size_t>(length - total));
+            ::memcpy(out + total, static_cast<const char*>(buffer_.data()) + pos_, n);
+            pos_ += n;
+            total += n;
+        }
+
+        if (pos_ >= partLength) {
+            part_++;
+            pos_ = 0;
+        }
+    }
+
+    return total;
+}
+
+void CompressedPartFileHandle::close() {
+    if (file_) {
+        file_->close();
+        file_.reset();
+    }
+    loaded_ = -1;
+}
+
+void CompressedPartFileHandle::rewind() {
+    restartReadFrom(0);
+}
+
+void CompressedPartFileHandle::restartReadFrom(const Offset& from) {
+
+    ASSERT(from >= Offset(0));
+
+    unsigned long long remaining = static_cast<long long>(from);
+    part_ = 0;
+    while (part_ < length_.size() && remaining >= static_cast<unsigned long long>(length_[part_])) {
+        remaining -= static_cast<unsigned long long>(length_[part_]);
+        part_++;
+    }
+    ASSERT(part_ < length_.size() || remaining == 0);
+    pos_ = remaining;
+}
+
+Offset CompressedPartFileHandle::seek(const Offset& from) {
+    restartReadFrom(from);
+    return from;
+}
+
+bool CompressedPartFileHandle::merge(DataHandle* other) {
+
+    if (other->isEmpty()) {
+        return true;
+    }
+
+    CompressedPartFileHandle* handle = dynamic_cast<CompressedPartFileHandle*>(other);
+    if (!handle || handle->name_ != name_ || handle->codec_ != codec_) {
+        return false;
+    }
+
+    offset_.insert(offset_.end(), handle->offset_.begin(), handle->offset_.end());
+    stored_.insert(stored_.end(), handle->stored_.begin(), handle->stored_.end());
+    length_.insert(length_.end(), handle->length_.begin(), handle->length_.end());
+
+    return true;
+}
+
+Length CompressedPartFileHandle::size() {
+    return estimate();
+}
+
+Length CompressedPartFileHandle::estimate() {
+    Length total = 0;
+    for (const Length& len : length_) {
+        total += len;
+    }
+    return total;
+}
+
+std::string CompressedPartFileHandle::title() const {
+    return PathName::shorten(name_);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
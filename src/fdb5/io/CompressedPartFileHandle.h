@@ -0,0 +1,126 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   CompressedPartFileHandle.h
+/// @date   Oct 2026
+
+#ifndef fdb5_io_CompressedPartFileHandle_h
+#define fdb5_io_CompressedPartFileHandle_h
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/Offset.h"
+
+namespace eckit {
+class Compressor;
+}
+
+namespace fdb5 {
+
+//-----------------------------------------------------------------------------
+
+// Reads fields stored compressed in a data file. Each part is the payload of one field,
+// compressed with the given codec, and is read back as the uncompressed field. A payload
+// as long as the field itself is stored raw. Handles on the same file and codec merge,
+// so that a retrieval of several fields opens the file once.
+
+class CompressedPartFileHandle : public eckit::DataHandle {
+public:
+
+    /// Compresses a field. Returns the payload to store, which is the input itself if
+    /// compression does not reduce its size
+    static const void* compress(const eckit::Compressor& compressor, const void* data, size_t length,
+                                eckit::Buffer& out, size_t& outLength);
+
+// -- Contructors
+
+    CompressedPartFileHandle(const eckit::PathName&,
+                             const eckit::Offset&,
+                             const eckit::Length& storedLength,
+                             const eckit::Length& length,
+                             const std::string& codec);
+    CompressedPartFileHandle(const eckit::PathName&,
+                             const std::vector<eckit::Offset>&,
+                             const std::vector<eckit::Length>& storedLengths,
+                             const std::vector<eckit::Length>& lengths,
+                             const std::string& codec);
+    CompressedPartFileHandle(eckit::Stream&) { NOTIMP; }
+    ~CompressedPartFileHandle() override;
+
+	// From DataHandle
+
+    eckit::Length openForRead() override;
+    void openForWrite(const eckit::Length&) override { NOTIMP; }
+    void openForAppend(const eckit::Length&) override { NOTIMP; }
+
+    long read(void*,long) override;
+    long write(const void*,long) override { NOTIMP; }
+    void close() override;
+    void rewind() override;
+
+    void print(std::ostream&) const override;
+    bool merge(DataHandle*) override;
+    bool compress(bool = false) override;
+    eckit::Length size() override;
+    eckit::Length estimate() override;
+
+    void restartReadFrom(const eckit::Offset&) override;
+    eckit::Offset seek(const eckit::Offset&) override;
+    bool canSeek() const override { return true; }
+
+    void toRemote(eckit::Stream&) const override { NOTIMP; }
+
+    std::string title() const override;
+    bool moveable() const override { return false; }
+    eckit::DataHandle* clone() const override;
+
+	// From Streamable
+
+    void encode(eckit::Stream&) const override { NOTIMP; }
+    const eckit::ReanimatorBase& reanimator() const override { return reanimator_; }
+
+private: // methods
+
+    void load(size_t part);
+
+private: // members
+
+    eckit::PathName name_;
+    std::vector<eckit::Offset> offset_;
+    std::vector<eckit::Length> stored_;
+    std::vector<eckit::Length> length_;
+    std::string     codec_;
+
+    std::unique_ptr<eckit::DataHandle> file_;
+    std::unique_ptr<eckit::Compressor> compressor_;
+    eckit::Buffer   readBuffer_;
+    eckit::Buffer   buffer_;
+    long            loaded_;    ///< part currently uncompressed in buffer_, -1 if none
+    size_t          part_;
+    size_t          pos_;       ///< position within the current part
+
+    // For Streamable
+
+    static eckit::ClassSpec classSpec_;
+    static eckit::Reanimator<CompressedPartFileHandle> reanimator_;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
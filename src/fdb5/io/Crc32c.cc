@@ -0,0 +1,120 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/io/Crc32c.h"
+
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+
+static inline uint32_t crc32c_u8(uint32_t crc, uint8_t v) {
+#if defined(__SSE4_2__)
+    return _mm_crc32_u8(crc, v);
+#else
+    return __crc32cb(crc, v);
+#endif
+}
+
+static inline uint32_t crc32c_u64(uint32_t crc, uint64_t v) {
+#if defined(__SSE4_2__) && defined(__x86_64__)
+    return static_cast<uint32_t>(_mm_crc32_u64(crc, v));
+#elif defined(__SSE4_2__)
+    crc = _mm_crc32_u32(crc, static_cast<uint32_t>(v));
+    return _mm_crc32_u32(crc, static_cast<uint32_t>(v >> 32));
+#else
+    return __crc32cd(crc, v);
+#endif
+}
+
+void Crc32c::update(const void* data, size_t length) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint32_t crc = crc_;
+
+    while (length >= sizeof(uint64_t)) {
+        uint64_t v;
+        ::memcpy(&v, p, sizeof(v));
+        crc = crc32c_u64(crc, v);
+        p += sizeof(v);
+        length -= sizeof(v);
+    }
+    while (length--) {
+        crc = crc32c_u8(crc, *p++);
+    }
+
+    crc_ = crc;
+}
+
+#else
+
+namespace {
+
+struct Crc32cTables {
+    uint32_t table[8][256];
+
+    Crc32cTables() {
+        const uint32_t poly = 0x82F63B78u;  // reflected Castagnoli polynomial
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; ++k) {
+                crc = (crc >> 1) ^ (poly & (0u - (crc & 1u)));
+            }
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int t = 1; t < 8; ++t) {
+                table[t][i] = (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+const Crc32cTables& tables() {
+    static Crc32cTables t;
+    return t;
+}
+
+}  // namespace
+
+void Crc32c::update(const void* data, size_t length) {
+    const Crc32cTables& t = tables();
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint32_t crc = crc_;
+
+    while (length >= 8) {
+        uint32_t lo = crc ^ (uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24));
+        uint32_t hi = uint32_t(p[4]) | (uint32_t(p[5]) << 8) | (uint32_t(p[6]) << 16) | (uint32_t(p[7]) << 24);
+        crc = t.table[7][lo & 0xFF] ^ t.table[6][(lo >> 8) & 0xFF] ^ t.table[5][(lo >> 16) & 0xFF] ^
+              t.table[4][lo >> 24] ^ t.table[3][hi & 0xFF] ^ t.table[2][(hi >> 8) & 0xFF] ^
+              t.table[1][(hi >> 16) & 0xFF] ^ t.table[0][hi >> 24];
+        p += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = (crc >> 8) ^ t.table[0][(crc ^ *p++) & 0xFF];
+    }
+
+    crc_ = crc;
+}
+
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
@@ -0,0 +1,52 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   Crc32c.h
+/// @date   Oct 2026
+
+#ifndef fdb5_io_Crc32c_H
+#define fdb5_io_Crc32c_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Streaming CRC-32C (Castagnoli) used to checksum archived fields.
+/// Uses the SSE4.2 / ARMv8 CRC instructions when the compiler targets them, slicing-by-8 tables otherwise.
+
+class Crc32c {
+
+public: // methods
+
+    Crc32c() : crc_(0xFFFFFFFFu) {}
+
+    void update(const void* data, size_t length);
+
+    uint32_t value() const { return crc_ ^ 0xFFFFFFFFu; }
+
+    static uint32_t compute(const void* data, size_t length) {
+        Crc32c crc;
+        crc.update(data, length);
+        return crc.value();
+    }
+
+private: // members
+
+    uint32_t crc_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif // fdb5_io_Crc32c_H
@@ -8,8 +8,10 @@
  * does it submit to any jurisdiction.
  */
 
+#include <fcntl.h>
+#include <sys/uio.h>
 #include <unistd.h>
-#include <cstdio>
+#include <cstring>
 
 #include "eckit/config/Resource.h"
 #include "eckit/eckit.h"
@@ -31,8 +33,9 @@ void FDBFileHandle::print(std::ostream& s) const {
 
 FDBFileHandle::FDBFileHandle(const std::string& name, size_t buffer) :
     path_(name),
-    file_(nullptr),
+    fd_(-1),
     buffer_(buffer),
+    used_(0),
     pos_(0) {}
 
 FDBFileHandle::~FDBFileHandle() {}
@@ -46,71 +49,132 @@ void FDBFileHandle::openForWrite(const Length&) {
 }
 
 void FDBFileHandle::openForAppend(const Length&) {
-    ASSERT(!file_);
-    file_ = ::fopen(path_.c_str(), "a");
-    if (!file_) {
+    ASSERT(fd_ < 0);
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0666);
+    if (fd_ < 0) {
         throw eckit::CantOpenFile(path_);
     }
-    SYSCALL(pos_ = ::ftello(file_));
-    SYSCALL(::setvbuf(file_, buffer_, _IOFBF, buffer_.size()));
+    SYSCALL(pos_ = ::lseek(fd_, 0, SEEK_END));
+    used_ = 0;
 }
 
 long FDBFileHandle::read(void*, long) {
     NOTIMP;
 }
 
+/// Writes the pending buffered bytes followed by the caller's buffer in a single writev(),
+/// without copying the caller's data. Handles short writes and EINTR. Writing nothing is an error, as it would
+/// otherwise be retried forever.
+
+void FDBFileHandle::writeVector(const void* buffer, long length) {
+
+    struct iovec iov[2];
+    int iovcnt = 0;
+
+    if (used_) {
+        iov[iovcnt].iov_base = buffer_.data();
+        iov[iovcnt].iov_len  = used_;
+        ++iovcnt;
+    }
+    if (length) {
+        iov[iovcnt].iov_base = const_cast<void*>(buffer);
+        iov[iovcnt].iov_len  = length;
+        ++iovcnt;
+    }
+
+    struct iovec* cur = iov;
+
+    while (iovcnt > 0) {
+        ssize_t written = ::writev(fd_, cur, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Log::error() << "Cannot write to " << path_ << Log::syserr << std::endl;
+            throw eckit::WriteError(path_);
+        }
+        if (written == 0) {
+            Log::error() << "Cannot write to " << path_ << ", nothing written" << std::endl;
+            throw eckit::WriteError(path_);
+        }
+
+        while (iovcnt > 0 && size_t(written) >= cur->iov_len) {
+            written -= cur->iov_len;
+            ++cur;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            cur->iov_base = static_cast<char*>(cur->iov_base) + written;
+            cur->iov_len -= written;
+        }
+    }
+
+    used_ = 0;
+}
+
 long FDBFileHandle::write(const void* buffer, long length) {
     ASSERT(buffer);
-    ASSERT(file_);
+    ASSERT(fd_ >= 0);
 
-    long written = ::fwrite(buffer, 1, length, file_);
+    static long fdbDirectWriteThreshold =
+        eckit::LibResource<long, LibFdb5>("$FDB_DIRECT_WRITE_THRESHOLD;fdbDirectWriteThreshold", 1024 * 1024);
 
-    if (written != length) {
-        throw eckit::WriteError(path_);
+    if (length < fdbDirectWriteThreshold && used_ + length <= buffer_.size()) {
+        ::memcpy(static_cast<char*>(buffer_.data()) + used_, buffer, length);
+        used_ += length;
+    }
+    else {
+        writeVector(buffer, length);
     }
 
-    pos_ += written;
+    pos_ += length;
 
-    return written;
+    return length;
 }
 
 void FDBFileHandle::flush() {
     static bool fdbDataSyncOnFlush =
         eckit::LibResource<bool, LibFdb5>("$FDB_DATA_SYNC_ON_FLUSH;fdbDataSyncOnFlush", true);
 
-    if (file_) {
-        if (::fflush(file_))
-            throw WriteError(std::string("FDBFileHandle::~FDBFileHandle(fflush(") + path_ + "))",
-                             Here());
+    if (fd_ >= 0) {
+        writeVector(nullptr, 0);
 
         if (fdbDataSyncOnFlush) {
-            int ret = eckit::fdatasync(::fileno(file_));
+            int ret = eckit::fdatasync(fd_);
 
             while (ret < 0 && errno == EINTR) {
-                ret = eckit::fdatasync(::fileno(file_));
+                ret = eckit::fdatasync(fd_);
             }
             if (ret < 0) {
-                Log::error() << "Cannot fdatasync(" << path_ << ") " << ::fileno(file_)
+                Log::error() << "Cannot fdatasync(" << path_ << ") " << fd_
                              << Log::syserr << std::endl;
                 throw eckit::WriteError(path_);
             }
         }
 
         off_t current;
-        SYSCALL(current = ::ftello(file_));
+        SYSCALL(current = ::lseek(fd_, 0, SEEK_CUR));
         ASSERT(pos_ == current);
     }
 }
 
 void FDBFileHandle::close() {
-    if (file_) {
-        if (::fclose(file_)) {
-            file_ = nullptr;
+    if (fd_ >= 0) {
+        int fd = fd_;
+        try {
+            writeVector(nullptr, 0);
+        }
+        catch (...) {
+            ::close(fd);
+            fd_ = -1;
             pos_ = 0;
-            throw WriteError(std::string("fclose ") + name());
+            throw;
         }
-        file_ = nullptr;
+        fd_ = -1;
         pos_ = 0;
+        if (::close(fd)) {
+            throw WriteError(std::string("close ") + name());
+        }
     }
 }
 
@@ -28,6 +28,10 @@ namespace fdb5 {
 ///   * it fails on ENOSPC
 ///   * this class can only be used in Append mode
 ///   * this is not thread-safe neither multi-process safe
+///   * it manages its own write buffer instead of stdio's. Writes that do not fit in the
+///     remaining buffer, or that exceed fdbDirectWriteThreshold, are handed to the kernel
+///     straight from the caller's memory together with any pending bytes (writev), so large
+///     fields are not copied into the buffer first
 
 class FDBFileHandle : public eckit::DataHandle {
 public:  // methods
@@ -53,10 +57,15 @@ protected: // members
 
     std::string      path_;
 
+private: // methods
+
+    void writeVector(const void* buffer, long length);
+
 private: // members
 
-    FILE            *file_;
+    int              fd_;
     eckit::Buffer    buffer_;
+    size_t           used_;
     off_t pos_;
 
 };
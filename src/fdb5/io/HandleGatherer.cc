@@ -10,54 +10,305 @@
 
 #include "fdb5/io/HandleGatherer.h"
 
+#include <algorithm>
+
+#include "eckit/config/Resource.h"
 #include "eckit/io/MultiHandle.h"
 #include "eckit/log/Plural.h"
 #include "eckit/exception/Exceptions.h"
 
+#include "fdb5/LibFdb5.h"
+#include "fdb5/database/FieldLocation.h"
+#include "fdb5/io/CoalescedPartFileHandle.h"
+#include "fdb5/io/PrefetchingMultiHandle.h"
+
 namespace fdb5 {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+static bool allowReorder() {
+    static bool fdbReadAllowReorder = eckit::Resource<bool>("fdbReadAllowReorder;$FDB_READ_ALLOW_REORDER", false);
+    return fdbReadAllowReorder;
+}
+
 HandleGatherer::HandleGatherer(bool sorted):
     sorted_(sorted),
-    count_(0) {
+    planner_(sorted, allowReorder()),
+    plan_{sorted ? ReadPlanner::SORTED_MERGED : ReadPlanner::REQUEST_ORDERED, sorted, 1},
+    count_(0),
+    orderKnown_(true) {
+
+    static long long fdbReadCoalesceGap = eckit::Resource<long long>("fdbReadCoalesceGap;$FDB_READ_COALESCE_GAP", 0);
+    gap_ = fdbReadCoalesceGap;
+
+    // Collecting by file keeps both orders available to the planner
+    collectByFile_ = planner_.reorderAllowed();
 }
 
 HandleGatherer::~HandleGatherer() {
-    for (std::vector<eckit::DataHandle *>::iterator j = handles_.begin(); j != handles_.end(); ++j) {
-        delete (*j);
+    for (Entry& e : entries_) {
+        delete e.handle_;
+    }
+}
+
+ReadPlanner::Profile HandleGatherer::profile() const {
+
+    ReadPlanner::Profile p{count_, 0, 0, 0, 0, false};
+
+    struct Located {
+        size_t file_;
+        Range range_;
+    };
+
+    std::unordered_map<std::string, size_t> files;
+    std::vector<Located> all;
+    all.reserve(count_);
+
+    for (const FileRanges& g : groups_) {
+        size_t file = files.emplace(g.path_.asString(), files.size()).first->second;
+        std::vector<Range> ranges(g.ranges_);
+        std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return a.offset_ < b.offset_; });
+        long long end = -1;
+        for (const Range& r : ranges) {
+            if (r.offset_ != end) {
+                p.seeksSorted_++;
+            }
+            end = r.offset_ + r.length_;
+            p.bytes_ += r.length_;
+            all.push_back(Located{file, r});
+        }
     }
+
+    std::sort(all.begin(), all.end(), [](const Located& a, const Located& b) { return a.range_.seq_ < b.range_.seq_; });
+
+    size_t file = size_t(-1);
+    long long end = -1;
+    for (const Located& l : all) {
+        if (l.file_ != file || l.range_.offset_ != end) {
+            p.seeksOrdered_++;
+        }
+        file = l.file_;
+        end = l.range_.offset_ + l.range_.length_;
+    }
+
+    p.files_ = files.size();
+    p.parallelFileSystem_ = !groups_.empty() && ReadPlanner::parallelFileSystem(groups_.front().path_);
+
+    return p;
+}
+
+void HandleGatherer::regroupInRequestOrder() {
+
+    struct Located {
+        const eckit::PathName* path_;
+        Range range_;
+    };
+
+    std::vector<Located> all;
+    all.reserve(count_);
+    for (const FileRanges& g : groups_) {
+        for (const Range& r : g.ranges_) {
+            all.push_back(Located{&g.path_, r});
+        }
+    }
+    std::sort(all.begin(), all.end(), [](const Located& a, const Located& b) { return a.range_.seq_ < b.range_.seq_; });
+
+    std::vector<FileRanges> groups;
+    std::vector<Entry> entries;
+    for (const Located& l : all) {
+        if (!groups.empty()) {
+            FileRanges& last = groups.back();
+            const Range& prev = last.ranges_.back();
+            if (last.path_ == *l.path_ && l.range_.offset_ >= prev.offset_ + prev.length_) {
+                last.ranges_.push_back(l.range_);
+                continue;
+            }
+        }
+        groups.push_back(FileRanges{*l.path_, {l.range_}});
+        entries.push_back(Entry{nullptr, groups.size() - 1});
+    }
+
+    std::swap(groups, groups_);
+    std::swap(entries, entries_);
+}
+
+void HandleGatherer::emit(FileRanges& group, bool sorted, std::vector<eckit::DataHandle*>& handles) {
+
+    std::vector<Range>& ranges = group.ranges_;
+
+    if (sorted) {
+        std::stable_sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return a.offset_ < b.offset_; });
+    }
+
+    // Split the ranges into spans of ranges separated by gaps of at most gap_ bytes. A span of one range
+    // (after merging contiguous ones) is batched with its neighbours into one PartFileHandle, as before.
+
+    eckit::OffsetList batchOffsets;
+    eckit::LengthList batchLengths;
+
+    auto flushBatch = [&]() {
+        if (!batchOffsets.empty()) {
+            handles.push_back(group.path_.partHandle(batchOffsets, batchLengths));
+            batchOffsets.clear();
+            batchLengths.clear();
+        }
+    };
+
+    size_t i = 0;
+    while (i < ranges.size()) {
+
+        std::vector<eckit::Offset> offsets{eckit::Offset(ranges[i].offset_)};
+        std::vector<eckit::Length> lengths{eckit::Length(ranges[i].length_)};
+        long long end = ranges[i].offset_ + ranges[i].length_;
+        order_.push_back(ranges[i].seq_);
+
+        size_t j = i + 1;
+        for (; j < ranges.size(); ++j) {
+            const Range& r = ranges[j];
+            if (r.offset_ < end || r.offset_ - end > gap_) {
+                break;
+            }
+            if (r.offset_ == end) {
+                lengths.back() = eckit::Length(static_cast<long long>(lengths.back()) + r.length_);
+            }
+            else {
+                offsets.push_back(eckit::Offset(r.offset_));
+                lengths.push_back(eckit::Length(r.length_));
+            }
+            end = r.offset_ + r.length_;
+            order_.push_back(r.seq_);
+        }
+
+        if (offsets.size() == 1) {
+            batchOffsets.push_back(offsets.front());
+            batchLengths.push_back(lengths.front());
+        }
+        else {
+            flushBatch();
+            handles.push_back(new CoalescedPartFileHandle(group.path_, offsets, lengths));
+        }
+
+        i = j;
+    }
+
+    flushBatch();
 }
 
 eckit::DataHandle *HandleGatherer::dataHandle() {
-    for (std::vector<eckit::DataHandle *>::iterator j = handles_.begin(); j != handles_.end(); ++j) {
-        (*j)->compress(sorted_);
+
+    // Fields added as handles cannot be reordered by the planner. Those collected by file are read by file.
+    bool sorted = collectByFile_;
+    plan_ = ReadPlanner::Decision{sorted ? ReadPlanner::SORTED_MERGED : ReadPlanner::REQUEST_ORDERED, sorted, 1};
+
+    if (orderKnown_ && !groups_.empty()) {
+        ReadPlanner::Profile p = profile();
+        plan_ = planner_.plan(p);
+
+        LOG_DEBUG_LIB(LibFdb5) << "HandleGatherer read plan " << plan_ << " for " << p.fields_ << " fields, "
+                               << p.files_ << " files, " << p.bytes_ << " bytes, " << p.seeksOrdered_
+                               << " discontinuities in request order, " << p.seeksSorted_ << " sorted" << std::endl;
+
+        if (collectByFile_ && !plan_.sorted_) {
+            regroupInRequestOrder();
+        }
+        sorted = plan_.sorted_;
+    }
+
+    std::vector<eckit::DataHandle*> handles;
+    handles.reserve(entries_.size());
+
+    for (Entry& e : entries_) {
+        if (e.handle_) {
+            e.handle_->compress(sorted_);
+            handles.push_back(e.handle_);
+            e.handle_ = nullptr;
+        }
+        else {
+            emit(groups_[e.group_], sorted, handles);
+        }
     }
 
-    eckit::DataHandle *h = new eckit::MultiHandle(handles_);
-    handles_.clear();
+    entries_.clear();
+    groups_.clear();
+    files_.clear();
+
+    if (!orderKnown_) {
+        order_.clear();
+    }
+
+    static size_t fdbPrefetchParts = eckit::Resource<size_t>("fdbPrefetchParts;$FDB_PREFETCH_PARTS", 0);
+    static size_t fdbPrefetchMaxPartSize = eckit::Resource<size_t>("fdbPrefetchMaxPartSize;$FDB_PREFETCH_MAX_PART_SIZE", 64 * 1024 * 1024);
+
+    size_t parts = fdbPrefetchParts;
+    if (plan_.plan_ == ReadPlanner::PARALLEL_STRIPED) {
+        parts = std::max(parts, plan_.threads_);
+    }
+
+    eckit::DataHandle *h;
+    if (parts > 0 && handles.size() > 1) {
+        h = new PrefetchingMultiHandle(handles, parts, fdbPrefetchMaxPartSize);
+    } else {
+        h = new eckit::MultiHandle(handles);
+    }
     return h;
 }
 
 void HandleGatherer::add(eckit::DataHandle *h) {
     count_++;
+    orderKnown_ = false;
     ASSERT(h);
     if (sorted_) {
-        for (std::vector<eckit::DataHandle *>::iterator j = handles_.begin(); j != handles_.end(); ++j) {
-            if ( (*j)->merge(h) ) {
+        for (Entry& e : entries_) {
+            if (e.handle_ && e.handle_->merge(h)) {
                 delete h;
                 return;
             }
         }
     } else {
-        if (handles_.size() > 0) {
-            if ( handles_.back()->merge(h) ) {
+        if (entries_.size() > 0 && entries_.back().handle_) {
+            if ( entries_.back().handle_->merge(h) ) {
                 delete h;
                 return;
             }
         }
     }
-    handles_.push_back(h);
+    entries_.push_back(Entry{h, 0});
+}
+
+void HandleGatherer::add(const FieldLocation& location) {
+
+    if (!location.plainFileRange()) {
+        add(location.dataHandle());
+        return;
+    }
+
+    Range range{static_cast<long long>(location.offset()), static_cast<long long>(location.length()), count_++};
+    eckit::PathName path = location.uri().path();
+
+    if (collectByFile_) {
+        auto it = files_.find(path.asString());
+        if (it == files_.end()) {
+            it = files_.emplace(path.asString(), groups_.size()).first;
+            groups_.push_back(FileRanges{path, {}});
+            entries_.push_back(Entry{nullptr, it->second});
+        }
+        groups_[it->second].ranges_.push_back(range);
+        return;
+    }
+
+    // Unsorted: only consecutive fields of the same file, going forwards, share a group
+
+    if (!entries_.empty() && !entries_.back().handle_) {
+        FileRanges& last = groups_[entries_.back().group_];
+        const Range& prev = last.ranges_.back();
+        if (last.path_ == path && range.offset_ >= prev.offset_ + prev.length_) {
+            last.ranges_.push_back(range);
+            return;
+        }
+    }
+
+    groups_.push_back(FileRanges{path, {range}});
+    entries_.push_back(Entry{nullptr, groups_.size() - 1});
 }
 
 size_t HandleGatherer::count() const {
@@ -65,7 +316,7 @@ size_t HandleGatherer::count() const {
 }
 
 void HandleGatherer::print( std::ostream &out ) const {
-    out << eckit::Plural(handles_.size(), "handle");
+    out << eckit::Plural(entries_.size(), "handle");
 }
 
 //----------------------------------------------------------------------------------------------------------------------
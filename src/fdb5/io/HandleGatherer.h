@@ -19,9 +19,16 @@
 #include <cstdlib>
 #include <vector>
 #include <iosfwd>
+#include <string>
+#include <unordered_map>
 
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/Offset.h"
 #include "eckit/memory/NonCopyable.h"
 
+#include "fdb5/io/ReadPlanner.h"
+
 namespace eckit {
 class DataHandle;
 }
@@ -29,9 +36,21 @@ class DataHandle;
 
 namespace fdb5 {
 
+class FieldLocation;
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Gathers the handles of retrieved fields into one handle.
+///
+/// Fields added by location, whose data is a plain byte range of a file, are kept as intervals grouped by file.
+/// When sorted, each file's intervals are sorted by offset, and neighbouring intervals separated by at most
+/// fdbReadCoalesceGap bytes are read together, the gap being read and discarded. Otherwise only consecutive
+/// fields are coalesced, preserving the order in which they were added.
+///
+/// If all the fields were added by location, the ReadPlanner chooses between these two orders (the sorted one
+/// only if requested, or if reordering is tolerated with fdbReadAllowReorder) and whether to read parts
+/// concurrently.
+
 class HandleGatherer : public eckit::NonCopyable {
 
 public: // methods
@@ -41,17 +60,60 @@ public: // methods
     ~HandleGatherer();
 
     void add(eckit::DataHandle *);
+    void add(const FieldLocation&);
 
     eckit::DataHandle *dataHandle();
 
     size_t count() const;
 
+    /// After dataHandle(): how the fields are read
+    const ReadPlanner::Decision& plan() const { return plan_; }
+
+    /// After dataHandle(): for each field in the order it is delivered, the index of the call to add() that
+    /// supplied it. Only available if all the fields were added by location, empty otherwise.
+    const std::vector<size_t>& order() const { return order_; }
+
+private: // types
+
+    struct Range {
+        long long offset_;
+        long long length_;
+        size_t seq_;
+    };
+
+    struct FileRanges {
+        eckit::PathName path_;
+        std::vector<Range> ranges_;
+    };
+
+    /// Either a handle, or (if handle_ is null) the group of ranges ranges_[group_]
+    struct Entry {
+        eckit::DataHandle* handle_;
+        size_t group_;
+    };
+
+private: // methods
+
+    void emit(FileRanges& group, bool sorted, std::vector<eckit::DataHandle*>& handles);
+
+    ReadPlanner::Profile profile() const;
+
+    /// Regroups the ranges, collected by file, in the order they were added
+    void regroupInRequestOrder();
 
 private: // members
 
     bool sorted_;
-    std::vector<eckit::DataHandle *> handles_;
+    bool collectByFile_;
+    ReadPlanner planner_;
+    ReadPlanner::Decision plan_;
+    std::vector<Entry> entries_;
+    std::vector<FileRanges> groups_;
+    std::unordered_map<std::string, size_t> files_;   ///< group of each file, when collecting by file
+    std::vector<size_t> order_;
     size_t count_;
+    bool orderKnown_;
+    long long gap_;
 
     void print( std::ostream &out ) const;
     friend std::ostream &operator<<(std::ostream &s, const HandleGatherer &x) {
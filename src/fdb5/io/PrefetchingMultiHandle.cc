@@ -0,0 +1,249 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/io/PrefetchingMultiHandle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "eckit/log/Log.h"
+#include "eckit/log/Plural.h"
+
+using namespace eckit;
+
+namespace fdb5 {
+
+//--------------------------------------------------------------------------------------------------
+
+::eckit::ClassSpec PrefetchingMultiHandle::classSpec_ = {
+    &DataHandle::classSpec(),
+    "PrefetchingMultiHandle",
+};
+::eckit::Reanimator<PrefetchingMultiHandle> PrefetchingMultiHandle::reanimator_;
+
+PrefetchingMultiHandle::PrefetchingMultiHandle(const std::vector<DataHandle*>& handles, size_t inFlight,
+                                               size_t maxPartSize) :
+    inFlight_(std::max<size_t>(inFlight, 1)),
+    maxPartSize_(maxPartSize),
+    stop_(false),
+    current_(0),
+    nextFetch_(0),
+    pos_(0),
+    directOpen_(false) {
+
+    parts_.resize(handles.size());
+    for (size_t i = 0; i < handles.size(); ++i) {
+        parts_[i].handle_.reset(handles[i]);
+        parts_[i].state_ = State::Pending;
+        parts_[i].length_ = 0;
+    }
+}
+
+PrefetchingMultiHandle::~PrefetchingMultiHandle() {
+    stopThreads();
+}
+
+void PrefetchingMultiHandle::print(std::ostream& s) const {
+    if (format(s) == Log::compactFormat)
+        s << "PrefetchingMultiHandle";
+    else
+        s << "PrefetchingMultiHandle[" << Plural(parts_.size(), "part") << ",inFlight=" << inFlight_ << ']';
+}
+
+Length PrefetchingMultiHandle::openForRead() {
+
+    ASSERT(threads_.empty());
+
+    current_ = 0;
+    nextFetch_ = 0;
+    pos_ = 0;
+    stop_ = false;
+
+    for (Part& part : parts_) {
+        part.buffer_.reset();
+        part.error_ = nullptr;
+        part.state_ = (static_cast<long long>(part.handle_->estimate()) > static_cast<long long>(maxPartSize_))
+                          ? State::Direct
+                          : State::Pending;
+    }
+
+    size_t nthreads = std::min(inFlight_, parts_.size());
+    for (size_t i = 0; i < nthreads; ++i) {
+        threads_.emplace_back([this] { prefetchLoop(); });
+    }
+
+    return estimate();
+}
+
+void PrefetchingMultiHandle::load(Part& part) {
+
+    DataHandle& dh = *part.handle_;
+
+    size_t capacity = std::max<long long>(static_cast<long long>(dh.openForRead()), 0);
+    AutoClose closer(dh);
+
+    std::unique_ptr<Buffer> buffer(new Buffer(std::max<size_t>(capacity, 1)));
+    size_t length = 0;
+    for (;;) {
+        if (length == buffer->size()) {
+            buffer->resize(buffer->size() * 2, true);
+        }
+        long n = dh.read(static_cast<char*>(buffer->data()) + length, buffer->size() - length);
+        if (n <= 0) {
+            break;
+        }
+        length += n;
+    }
+
+    part.buffer_ = std::move(buffer);
+    part.length_ = length;
+}
+
+void PrefetchingMultiHandle::prefetchLoop() {
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (;;) {
+
+        // Bound the readahead window to inFlight parts beyond the one being consumed
+
+        cv_.wait(lock, [this] { return stop_ || nextFetch_ >= parts_.size() || nextFetch_ < current_ + inFlight_; });
+
+        if (stop_ || nextFetch_ >= parts_.size()) {
+            return;
+        }
+
+        size_t i = nextFetch_++;
+        Part& part = parts_[i];
+        if (part.state_ != State::Pending) {
+            continue;
+        }
+        part.state_ = State::Loading;
+
+        lock.unlock();
+        try {
+            load(part);
+        }
+        catch (...) {
+            part.error_ = std::current_exception();
+        }
+        lock.lock();
+
+        part.state_ = State::Ready;
+        cv_.notify_all();
+    }
+}
+
+long PrefetchingMultiHandle::read(void* buffer, long length) {
+
+    char* out = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (total < length && current_ < parts_.size()) {
+
+        Part& part = parts_[current_];
+
+        if (part.state_ == State::Direct) {
+            if (!directOpen_) {
+                part.handle_->openForRead();
+                directOpen_ = true;
+            }
+            long n = part.handle_->read(out + total, length - total);
+            if (n > 0) {
+                total += n;
+                continue;
+            }
+            part.handle_->close();
+            directOpen_ = false;
+        }
+        else {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&part] { return part.state_ == State::Ready; });
+            }
+
+            if (part.error_) {
+                std::rethrow_exception(part.error_);
+            }
+
+            size_t n = std::min<size_t>(part.length_ - pos_, length - total);
+            ::memcpy(out + total, static_cast<const char*>(part.buffer_->data()) + pos_, n);
+            pos_ += n;
+            total += n;
+
+            if (pos_ < part.length_) {
+                continue;
+            }
+            part.buffer_.reset();
+        }
+
+        // Move on to the next part, and let the prefetch threads advance the window
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++current_;
+        pos_ = 0;
+        cv_.notify_all();
+    }
+
+    return total;
+}
+
+void PrefetchingMultiHandle::stopThreads() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        cv_.notify_all();
+    }
+    for (std::thread& t : threads_) {
+        t.join();
+    }
+    threads_.clear();
+}
+
+void PrefetchingMultiHandle::close() {
+    stopThreads();
+    if (directOpen_) {
+        parts_[current_].handle_->close();
+        directOpen_ = false;
+    }
+    for (Part& part : parts_) {
+        part.buffer_.reset();
+    }
+}
+
+Length PrefetchingMultiHandle::size() {
+    long long total = 0;
+    for (Part& part : parts_) {
+        total += part.handle_->size();
+    }
+    return total;
+}
+
+Length PrefetchingMultiHandle::estimate() {
+    long long total = 0;
+    for (Part& part : parts_) {
+        total += part.handle_->estimate();
+    }
+    return total;
+}
+
+std::string PrefetchingMultiHandle::title() const {
+    std::ostringstream os;
+    os << "[";
+    if (!parts_.empty()) os << parts_[0].handle_->title();
+    if (parts_.size() > 1) os << ",...{" << parts_.size() << "}";
+    os << "]";
+    return os.str();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
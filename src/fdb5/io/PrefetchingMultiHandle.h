@@ -0,0 +1,123 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   PrefetchingMultiHandle.h
+/// @date   Oct 2026
+
+#ifndef fdb5_io_PrefetchingMultiHandle_h
+#define fdb5_io_PrefetchingMultiHandle_h
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/Length.h"
+
+namespace fdb5 {
+
+//-----------------------------------------------------------------------------
+
+// Concatenates a list of handles, like eckit::MultiHandle, but reads up to a given number
+// of parts ahead of the consumer on background threads, so that the latency of opening
+// and reading each part overlaps with the consumer. Parts are delivered in order. Parts
+// larger than the prefetch limit are read synchronously when reached.
+
+class PrefetchingMultiHandle : public eckit::DataHandle {
+public:
+
+// -- Contructors
+
+    /// Takes ownership of the handles
+    PrefetchingMultiHandle(const std::vector<eckit::DataHandle*>& handles, size_t inFlight, size_t maxPartSize);
+    PrefetchingMultiHandle(eckit::Stream&) { NOTIMP; }
+    ~PrefetchingMultiHandle() override;
+
+	// From DataHandle
+
+    eckit::Length openForRead() override;
+    void openForWrite(const eckit::Length&) override { NOTIMP; }
+    void openForAppend(const eckit::Length&) override { NOTIMP; }
+
+    long read(void*,long) override;
+    long write(const void*,long) override { NOTIMP; }
+    void close() override;
+    void rewind() override { NOTIMP; }
+
+    void print(std::ostream&) const override;
+    bool merge(DataHandle*) override { return false; }
+    bool compress(bool = false) override { return false; }
+    eckit::Length size() override;
+    eckit::Length estimate() override;
+
+    void restartReadFrom(const eckit::Offset&) override { NOTIMP; }
+    eckit::Offset seek(const eckit::Offset&) override { NOTIMP; }
+    bool canSeek() const override { return false; }
+
+    void toRemote(eckit::Stream&) const override { NOTIMP; }
+
+    std::string title() const override;
+    bool moveable() const override { return false; }
+
+	// From Streamable
+
+    void encode(eckit::Stream&) const override { NOTIMP; }
+    const eckit::ReanimatorBase& reanimator() const override { return reanimator_; }
+
+private: // types
+
+    enum class State { Pending, Loading, Ready, Direct };
+
+    struct Part {
+        std::unique_ptr<eckit::DataHandle> handle_;
+        State state_;
+        std::unique_ptr<eckit::Buffer> buffer_;
+        size_t length_;
+        std::exception_ptr error_;
+    };
+
+private: // methods
+
+    void prefetchLoop();
+    void load(Part& part);
+    void stopThreads();
+
+private: // members
+
+    std::vector<Part> parts_;
+    size_t inFlight_;
+    size_t maxPartSize_;
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_;
+
+    size_t current_;     ///< part being consumed
+    size_t nextFetch_;   ///< next part for a prefetch thread to claim
+    size_t pos_;         ///< position within the current part
+    bool directOpen_;
+
+    // For Streamable
+
+    static eckit::ClassSpec classSpec_;
+    static eckit::Reanimator<PrefetchingMultiHandle> reanimator_;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
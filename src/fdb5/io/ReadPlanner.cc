@@ -0,0 +1,109 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/io/ReadPlanner.h"
+
+#include <algorithm>
+#include <ostream>
+
+#if defined(__linux__)
+#include <sys/vfs.h>
+#endif
+
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ReadPlanner::ReadPlanner(bool sortRequested, bool reorderAllowed) :
+    sortRequested_(sortRequested),
+    reorderAllowed_(reorderAllowed) {
+
+    static double fdbReadPlannerSeekCost = eckit::Resource<double>("fdbReadPlannerSeekCost;$FDB_READ_PLANNER_SEEK_COST", 4 * 1024 * 1024);
+    static size_t fdbReadPlannerThreads = eckit::Resource<size_t>("fdbReadPlannerThreads;$FDB_READ_PLANNER_THREADS", 1);
+    static long long fdbReadPlannerParallelBytes = eckit::Resource<long long>("fdbReadPlannerParallelBytes;$FDB_READ_PLANNER_PARALLEL_BYTES", 256LL * 1024 * 1024);
+
+    seekCost_ = fdbReadPlannerSeekCost;
+    threads_ = std::max<size_t>(fdbReadPlannerThreads, 1);
+    parallelBytes_ = fdbReadPlannerParallelBytes;
+}
+
+ReadPlanner::Decision ReadPlanner::plan(const Profile& profile) const {
+
+    double ordered = double(profile.bytes_) + seekCost_ * double(profile.seeksOrdered_);
+    double sorted = double(profile.bytes_) + seekCost_ * double(profile.seeksSorted_);
+
+    Decision d{REQUEST_ORDERED, false, 1};
+
+    if (sortRequested_ || (reorderAllowed_ && sorted < ordered)) {
+        d.plan_ = SORTED_MERGED;
+        d.sorted_ = true;
+    }
+
+    double cost = d.sorted_ ? sorted : ordered;
+
+    // Concurrent reads only pay off across files, and for enough data to hide the cost of the threads
+
+    size_t ways = std::min(threads_, profile.files_);
+    if (ways > 1 && (profile.parallelFileSystem_ || profile.bytes_ >= parallelBytes_)) {
+        double parallel = cost / double(ways) + seekCost_ * double(ways);
+        if (parallel < cost) {
+            d.plan_ = PARALLEL_STRIPED;
+            d.threads_ = ways;
+        }
+    }
+
+    return d;
+}
+
+const char* ReadPlanner::name(Plan plan) {
+    switch (plan) {
+        case REQUEST_ORDERED:
+            return "request-ordered";
+        case SORTED_MERGED:
+            return "sorted-merged";
+        case PARALLEL_STRIPED:
+            return "parallel-striped";
+    }
+    return "unknown";
+}
+
+bool ReadPlanner::parallelFileSystem(const eckit::PathName& path) {
+#if defined(__linux__)
+    struct statfs info;
+    if (::statfs(path.localPath(), &info) != 0) {
+        return false;
+    }
+    switch (static_cast<unsigned long>(info.f_type)) {
+        case 0x0BD00BD0UL:  // Lustre
+        case 0x47504653UL:  // GPFS
+        case 0x19830326UL:  // BeeGFS
+            return true;
+        default:
+            return false;
+    }
+#else
+    return false;
+#endif
+}
+
+std::ostream& operator<<(std::ostream& s, const ReadPlanner::Decision& d) {
+    s << ReadPlanner::name(d.plan_);
+    if (d.plan_ == ReadPlanner::PARALLEL_STRIPED) {
+        s << "(" << (d.sorted_ ? "sorted" : "ordered") << ", " << d.threads_ << " threads)";
+    }
+    return s;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace fdb5
@@ -0,0 +1,90 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ReadPlanner.h
+/// @date   Oct 2026
+
+#ifndef fdb5_io_ReadPlanner_H
+#define fdb5_io_ReadPlanner_H
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace eckit {
+class PathName;
+}
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Chooses how the HandleGatherer reads a set of resolved field locations.
+///
+/// Each plan is costed as bytes read plus a fixed cost per discontinuity (fdbReadPlannerSeekCost bytes).
+/// Reading each file in offset order is only considered if the caller asked for it (optimise=on) or
+/// tolerates reordering (fdbReadAllowReorder). Reading parts concurrently (fdbReadPlannerThreads, default 1,
+/// i.e. never) divides the cost by the number of files read at once, and is preferred on parallel
+/// filesystems or above fdbReadPlannerParallelBytes.
+
+class ReadPlanner {
+
+public: // types
+
+    enum Plan {
+        REQUEST_ORDERED = 0,
+        SORTED_MERGED,
+        PARALLEL_STRIPED
+    };
+
+    struct Profile {
+        size_t fields_;
+        size_t files_;
+        long long bytes_;
+        size_t seeksOrdered_;   ///< discontinuities when reading in request order
+        size_t seeksSorted_;    ///< discontinuities when reading each file in offset order
+        bool parallelFileSystem_;
+    };
+
+    struct Decision {
+        Plan plan_;
+        bool sorted_;           ///< read each file in offset order
+        size_t threads_;        ///< parts read concurrently, for PARALLEL_STRIPED
+    };
+
+public: // methods
+
+    ReadPlanner(bool sortRequested, bool reorderAllowed);
+
+    Decision plan(const Profile& profile) const;
+
+    bool reorderAllowed() const { return sortRequested_ || reorderAllowed_; }
+
+    static const char* name(Plan plan);
+
+    /// Whether path lives on a filesystem striping files across servers (Lustre, GPFS, ...)
+    static bool parallelFileSystem(const eckit::PathName& path);
+
+private: // members
+
+    bool sortRequested_;
+    bool reorderAllowed_;
+
+    double seekCost_;
+    size_t threads_;
+    long long parallelBytes_;
+};
+
+std::ostream& operator<<(std::ostream& s, const ReadPlanner::Decision& d);
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace fdb5
+
+#endif
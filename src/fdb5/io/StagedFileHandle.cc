@@ -0,0 +1,100 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+
+#include "fdb5/LibFdb5.h"
+#include "fdb5/io/StagedFileHandle.h"
+#include "fdb5/io/StagingLog.h"
+
+using namespace eckit;
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+bool dataSyncOnFlush() {
+    static bool fdbDataSyncOnFlush =
+        eckit::LibResource<bool, LibFdb5>("$FDB_DATA_SYNC_ON_FLUSH;fdbDataSyncOnFlush", true);
+    return fdbDataSyncOnFlush;
+}
+
+} // namespace
+
+void StagedFileHandle::print(std::ostream& s) const {
+    s << "StagedFileHandle[file=" << path_ << ']';
+}
+
+StagedFileHandle::StagedFileHandle(const std::string& name) :
+    path_(name),
+    open_(false),
+    pos_(0) {}
+
+StagedFileHandle::~StagedFileHandle() {}
+
+Length StagedFileHandle::openForRead() {
+    NOTIMP;
+}
+
+void StagedFileHandle::openForWrite(const Length&) {
+    NOTIMP;
+}
+
+void StagedFileHandle::openForAppend(const Length&) {
+    ASSERT(!open_);
+    pos_ = StagingLog::instance().end(path_);
+    open_ = true;
+}
+
+long StagedFileHandle::read(void*, long) {
+    NOTIMP;
+}
+
+long StagedFileHandle::write(const void* buffer, long length) {
+    ASSERT(buffer);
+    ASSERT(open_);
+
+    Offset offset = StagingLog::instance().append(path_, buffer, length);
+    ASSERT(offset == Offset(pos_));
+
+    pos_ += length;
+
+    return length;
+}
+
+void StagedFileHandle::flush() {
+    if (open_) {
+        StagingLog::instance().flush(path_, dataSyncOnFlush());
+    }
+}
+
+void StagedFileHandle::close() {
+    if (open_) {
+        open_ = false;
+        pos_ = 0;
+        StagingLog::instance().close(path_, false);
+    }
+}
+
+Offset StagedFileHandle::position() {
+    return pos_;
+}
+
+std::string StagedFileHandle::title() const {
+    return PathName::shorten(path_);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace fdb5
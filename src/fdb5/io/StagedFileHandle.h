@@ -0,0 +1,59 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   StagedFileHandle.h
+/// @date   Oct 2026
+
+#ifndef fdb5_StagedFileHandle_h
+#define fdb5_StagedFileHandle_h
+
+#include "eckit/io/DataHandle.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Appends to a data file through the StagingLog. A write returns once the data is in the log, and is written to
+/// the file in the background. As with FDBFileHandle, flush() syncs the file, once the data staged for it is written.
+/// This class can only be used in Append mode
+
+class StagedFileHandle : public eckit::DataHandle {
+public:  // methods
+
+    StagedFileHandle(const std::string&);
+
+    ~StagedFileHandle();
+
+    virtual eckit::Length openForRead() override;
+    virtual void   openForWrite(const eckit::Length &) override;
+    virtual void   openForAppend(const eckit::Length &) override;
+
+    virtual long   read(void *, long) override;
+    virtual long   write(const void *, long) override;
+    virtual void   close() override;
+    virtual void   flush() override;
+    virtual void print(std::ostream &) const override;
+    virtual eckit::Offset position() override;
+    virtual std::string title() const override;
+    virtual bool canSeek() const override { return false; }
+
+private: // members
+
+    std::string      path_;
+    bool             open_;
+    off_t            pos_;
+
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
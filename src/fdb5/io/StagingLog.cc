@@ -0,0 +1,662 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/FDataSync.h"
+#include "eckit/log/Log.h"
+#include "eckit/log/Plural.h"
+#include "eckit/runtime/Main.h"
+
+#include "fdb5/LibFdb5.h"
+#include "fdb5/io/Crc32c.h"
+#include "fdb5/io/StagingLog.h"
+#include "fdb5/toc/TocCatalogueWriter.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const uint32_t dataMagic    = 0x46444253;  // "FDBS"
+const uint32_t entryMagic   = 0x46444249;  // "FDBI"
+const uint32_t flushedMagic = 0x46444246;  // "FDBF"
+
+/// Precedes the name of the data file and the data, in the log. An index entry is recorded with the directory of its
+/// database and the catalogue staging it, and the flush of a catalogue with the catalogue alone
+struct RecordHeader {
+    uint32_t magic_;
+    uint32_t pathLength_;
+    uint64_t offset_;  ///< in the data file, or the catalogue
+    uint64_t length_;
+    uint32_t crc_;  ///< of the name and the data, so that a record torn by a crash is not replayed
+    uint32_t unused_;
+};
+
+const std::string& stagingDirectory() {
+    static std::string fdbStagingDirectory = eckit::Resource<std::string>("fdbStagingDirectory;$FDB_STAGING_DIRECTORY", "");
+    return fdbStagingDirectory;
+}
+
+void writeFully(int fd, const void* data, size_t length, off_t offset, const std::string& path) {
+    const char* p = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t written = ::pwrite(fd, p, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            eckit::Log::error() << "Cannot write to " << path << eckit::Log::syserr << std::endl;
+            throw eckit::WriteError(path);
+        }
+        if (written == 0) {
+            eckit::Log::error() << "Cannot write to " << path << ", nothing written" << std::endl;
+            throw eckit::WriteError(path);
+        }
+        p += written;
+        offset += written;
+        length -= written;
+    }
+}
+
+bool readFully(int fd, void* data, size_t length, off_t offset) {
+    char* p = static_cast<char*>(data);
+    while (length > 0) {
+        ssize_t len = ::pread(fd, p, length, offset);
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            return false;
+        }
+        p += len;
+        offset += len;
+        length -= len;
+    }
+    return true;
+}
+
+void syncFile(int fd, const std::string& path) {
+    int ret = eckit::fdatasync(fd);
+    while (ret < 0 && errno == EINTR) {
+        ret = eckit::fdatasync(fd);
+    }
+    if (ret < 0) {
+        eckit::Log::error() << "Cannot fdatasync(" << path << ") " << fd << eckit::Log::syserr << std::endl;
+        throw eckit::WriteError(path);
+    }
+}
+
+int openTarget(const std::string& path) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT, 0666);
+    if (fd < 0) {
+        throw eckit::CantOpenFile(path);
+    }
+    return fd;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool StagingLog::enabled() {
+    return !stagingDirectory().empty();
+}
+
+StagingLog& StagingLog::instance() {
+    static size_t fdbStagingCapacity = eckit::Resource<size_t>("fdbStagingCapacity;$FDB_STAGING_CAPACITY", 1024 * 1024 * 1024);
+
+    ASSERT(enabled());
+    static StagingLog log(stagingDirectory(), fdbStagingCapacity);
+    return log;
+}
+
+StagingLog::StagingLog(const eckit::PathName& directory, size_t capacity) :
+    path_(directory / (eckit::Main::hostname() + "." + std::to_string(::getpid()) + ".staging")),
+    fd_(-1),
+    capacity_(capacity),
+    size_(0),
+    busy_(false),
+    syncing_(false),
+    stop_(false),
+    failed_(false) {
+
+    directory.mkdir();
+
+    removeUnnamed(directory);
+
+    // Nothing is staged before the logs left by dead processes are replayed
+    std::vector<eckit::PathName> logs;
+    eckit::PathName::match(directory / "*.staging", logs);
+    for (const eckit::PathName& log : logs) {
+        replay(log);
+    }
+
+    // The log is only given its name once locked, so that it is never taken for the log of a dead process
+    eckit::PathName tmp(path_ + ".tmp");
+    SYSCALL(fd_ = ::open(tmp.localPath(), O_RDWR | O_CREAT | O_TRUNC, 0666));
+    SYSCALL(::flock(fd_, LOCK_EX));
+    eckit::PathName::rename(tmp, path_);
+
+    LOG_DEBUG_LIB(LibFdb5) << "Staging archived data in " << path_ << std::endl;
+
+    thread_ = std::thread([this] { run(); });
+}
+
+StagingLog::~StagingLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+
+    for (auto& t : targets_) {
+        if (t.second.fd_ >= 0) {
+            if (t.second.dirty_ && !failed_) {
+                try {
+                    syncFile(t.second.fd_, t.first);
+                }
+                catch (const eckit::Exception&) {
+                    failed_ = true;
+                }
+            }
+            ::close(t.second.fd_);
+        }
+    }
+
+    // Keep the log, to be replayed
+    if (failed_) {
+        eckit::Log::error() << "StagingLog stopped after failing to write a data file, keeping " << path_ << std::endl;
+        ::close(fd_);
+        return;
+    }
+
+    if (!unflushed_.empty()) {
+        eckit::Log::warning() << "StagingLog stopped with index entries never flushed, keeping " << path_ << std::endl;
+        ::close(fd_);
+        return;
+    }
+
+    path_.unlink();
+    ::close(fd_);
+}
+
+void StagingLog::replay(const eckit::PathName& log) {
+
+    int fd = ::open(log.localPath(), O_RDWR);
+    if (fd < 0) {
+        return;  // replayed meanwhile by another process
+    }
+
+    if (::flock(fd, LOCK_EX | LOCK_NB) < 0) {
+        ::close(fd);  // its process is alive
+        return;
+    }
+
+    eckit::Log::info() << "Replaying staged data from " << log << std::endl;
+
+    std::unordered_map<std::string, int> targets;
+    size_t count = 0;
+    size_t skipped = 0;
+    size_t indexed = 0;
+
+    // By catalogue, the directory of its database and the entries it had not flushed
+    std::map<uint64_t, std::pair<std::string, std::vector<std::string>>> unflushed;
+
+    try {
+        RecordHeader header;
+        std::string path;
+        std::vector<char> data;
+        off_t offset = 0;
+        const off_t logSize = static_cast<long long>(log.size());
+
+        while (readFully(fd, &header, sizeof(header), offset) &&
+               (header.magic_ == dataMagic || header.magic_ == entryMagic || header.magic_ == flushedMagic)) {
+
+            // A torn header may claim more than the log holds
+            if (header.pathLength_ + header.length_ > uint64_t(logSize - offset)) {
+                break;
+            }
+
+            path.resize(header.pathLength_);
+            data.resize(header.length_);
+
+            off_t pathOffset = offset + sizeof(header);
+            off_t dataOffset = pathOffset + path.size();
+
+            if (!readFully(fd, &path[0], path.size(), pathOffset) ||
+                !readFully(fd, data.data(), data.size(), dataOffset)) {
+                break;
+            }
+
+            Crc32c crc;
+            crc.update(path.data(), path.size());
+            crc.update(data.data(), data.size());
+            if (crc.value() != header.crc_) {
+                break;
+            }
+
+            offset = dataOffset + data.size();
+
+            if (header.magic_ == entryMagic) {
+                auto& u = unflushed[header.offset_];
+                u.first = path;
+                u.second.emplace_back(data.begin(), data.end());
+                continue;
+            }
+
+            if (header.magic_ == flushedMagic) {
+                unflushed.erase(header.offset_);
+                continue;
+            }
+
+            auto t = targets.find(path);
+            if (t == targets.end()) {
+                // The database has been wiped since
+                if (!eckit::PathName(path).dirName().exists()) {
+                    eckit::Log::warning() << "Skipping data staged for " << path << ", its directory no longer exists"
+                                          << std::endl;
+                    skipped++;
+                    continue;
+                }
+                t = targets.emplace(path, openTarget(path)).first;
+            }
+            writeFully(t->second, data.data(), data.size(), header.offset_, path);
+
+            count++;
+        }
+
+        for (auto& t : targets) {
+            syncFile(t.second, t.first);
+        }
+
+        // Once their data is in the data files
+        for (const auto& u : unflushed) {
+            if (!eckit::PathName(u.second.first).exists()) {
+                eckit::Log::warning() << "Skipping index entries staged for " << u.second.first
+                                      << ", the database no longer exists" << std::endl;
+                skipped += u.second.second.size();
+                continue;
+            }
+            indexed += TocCatalogueWriter::reindex(u.second.first, u.second.second);
+        }
+    }
+    catch (const eckit::Exception& e) {
+        for (auto& t : targets) {
+            ::close(t.second);
+        }
+
+        // Set aside, so that this process and the next ones can still stage
+        eckit::PathName failed(log + ".failed");
+        eckit::Log::error() << "Cannot replay " << log << ": " << e.what() << ", renamed " << failed << std::endl;
+        eckit::PathName::rename(log, failed);
+        ::close(fd);
+        return;
+    }
+
+    for (auto& t : targets) {
+        ::close(t.second);
+    }
+
+    log.unlink();
+    ::close(fd);
+
+    eckit::Log::info() << "Replayed " << eckit::Plural(count, "staged field") << " from " << log;
+    if (indexed) {
+        eckit::Log::info() << ", indexed " << indexed << " again";
+    }
+    if (skipped) {
+        eckit::Log::info() << ", skipped " << skipped;
+    }
+    eckit::Log::info() << std::endl;
+}
+
+void StagingLog::removeUnnamed(const eckit::PathName& directory) {
+
+    // Named <host>.<pid>.staging.tmp until locked. Those of other hosts cannot be told from the logs being created
+    const std::string prefix = eckit::Main::hostname() + ".";
+    const std::string suffix = ".staging.tmp";
+
+    std::vector<eckit::PathName> unnamed;
+    eckit::PathName::match(directory / ("*" + suffix), unnamed);
+
+    for (const eckit::PathName& tmp : unnamed) {
+        std::string name = tmp.baseName().asString();
+        if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+
+        pid_t pid = ::atol(name.substr(prefix.size(), name.size() - prefix.size() - suffix.size()).c_str());
+        if (pid <= 0 || ::kill(pid, 0) == 0 || errno != ESRCH) {
+            continue;
+        }
+
+        eckit::Log::info() << "Removing " << tmp << ", left by a process that died" << std::endl;
+        tmp.unlink(false);
+    }
+}
+
+StagingLog::Target& StagingLog::target(const std::string& path) {
+    auto t = targets_.find(path);
+    if (t == targets_.end()) {
+        Target target;
+        eckit::PathName p(path);
+        if (p.exists()) {
+            target.end_ = static_cast<long long>(p.size());
+        }
+        t = targets_.emplace(path, target).first;
+    }
+    return t->second;
+}
+
+eckit::Offset StagingLog::end(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return target(path).end_;
+}
+
+void StagingLog::reserve(std::unique_lock<std::mutex>& lock, size_t recordSize) {
+
+    // A record larger than the log still goes in once the log is empty. The log grows past its capacity rather than
+    // wait for entries to be flushed, possibly by the caller. A failed log is never emptied again
+    auto fits = [this, recordSize] {
+        return size_ == 0 || size_t(size_) + recordSize <= capacity_ || (queue_.empty() && !unflushed_.empty());
+    };
+    cv_.wait(lock, [this, &fits] { return fits() || failed_; });
+    if (!fits()) {
+        std::ostringstream oss;
+        oss << "StagingLog: " << path_ << " is full, and kept since writing to a data file failed";
+        throw eckit::WriteError(oss.str(), Here());
+    }
+}
+
+off_t StagingLog::write(uint32_t magic, const std::string& path, uint64_t offset, const void* data, size_t length,
+                        uint32_t crc) {
+
+    RecordHeader header;
+    header.magic_ = magic;
+    header.pathLength_ = path.size();
+    header.offset_ = offset;
+    header.length_ = length;
+    header.crc_ = crc;
+    header.unused_ = 0;
+
+    off_t pathOffset = size_ + sizeof(header);
+    off_t dataOffset = pathOffset + path.size();
+
+    writeFully(fd_, &header, sizeof(header), size_, path_);
+    writeFully(fd_, path.data(), path.size(), pathOffset, path_);
+    writeFully(fd_, data, length, dataOffset, path_);
+
+    size_ = dataOffset + length;
+    return dataOffset;
+}
+
+eckit::Offset StagingLog::append(const std::string& path, const void* data, size_t length) {
+
+    Crc32c crc;
+    crc.update(path.data(), path.size());
+    crc.update(data, length);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    Target& t = target(path);
+    if (t.error_) {
+        std::rethrow_exception(t.error_);
+    }
+
+    reserve(lock, sizeof(RecordHeader) + path.size() + length);
+
+    off_t offset = t.end_;
+    off_t dataOffset = write(dataMagic, path, offset, data, length, crc.value());
+
+    queue_.push_back(Record{path, offset, dataOffset, length});
+
+    t.end_ += length;
+    t.pending_++;
+
+    lock.unlock();
+    cv_.notify_all();
+
+    // Only then is the data safe from a crash. Appends made meanwhile are synced along
+    syncFile(fd_, path_);
+
+    return offset;
+}
+
+void StagingLog::index(const std::string& directory, uintptr_t catalogue, const void* entry, size_t length) {
+
+    Crc32c crc;
+    crc.update(directory.data(), directory.size());
+    crc.update(entry, length);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    reserve(lock, sizeof(RecordHeader) + directory.size() + length);
+
+    write(entryMagic, directory, catalogue, entry, length, crc.value());
+    unflushed_.insert(catalogue);
+
+    lock.unlock();
+
+    syncFile(fd_, path_);
+}
+
+void StagingLog::indexed(uintptr_t catalogue) {
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (unflushed_.erase(catalogue) == 0) {
+            return;
+        }
+
+        // Synced along with the next record, which is what could be indexed again after it otherwise
+        write(flushedMagic, "", catalogue, nullptr, 0, Crc32c().value());
+    }
+    cv_.notify_all();
+}
+
+void StagingLog::flush(const std::string& path, bool sync) {
+
+    int fd;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this, &path] { return target(path).pending_ == 0; });
+        Target& t = target(path);
+        if (t.error_) {
+            std::rethrow_exception(t.error_);
+        }
+        fd = t.fd_;
+    }
+
+    if (sync && fd >= 0) {
+        syncFile(fd, path);
+    }
+}
+
+void StagingLog::close(const std::string& path, bool sync) {
+
+    try {
+        flush(path, sync);
+
+        // The log no longer covers the data once emptied, so it must be in the data file before it is closed
+        if (!sync) {
+            int fd = -1;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Target& t = target(path);
+                if (t.dirty_) {
+                    fd = t.fd_;
+                }
+            }
+            if (fd >= 0) {
+                syncFile(fd, path);
+            }
+        }
+    }
+    catch (...) {
+        // The file is closed, but still known with its error, so that it is not appended to again
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !syncing_; });
+        Target& t = target(path);
+        if (t.fd_ >= 0) {
+            ::close(t.fd_);
+            t.fd_ = -1;
+        }
+        throw;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !syncing_; });
+    auto t = targets_.find(path);
+    if (t != targets_.end()) {
+        if (t->second.fd_ >= 0) {
+            ::close(t->second.fd_);
+        }
+        targets_.erase(t);
+    }
+}
+
+bool StagingLog::caughtUp() const {
+    return queue_.empty() && unflushed_.empty() && !failed_;
+}
+
+void StagingLog::truncate(std::unique_lock<std::mutex>& lock) {
+
+    std::vector<std::pair<std::string, int>> files;
+    for (const auto& t : targets_) {
+        if (t.second.dirty_ && t.second.fd_ >= 0) {
+            files.emplace_back(t.first, t.second.fd_);
+        }
+    }
+
+    // Without the lock, so that appends go on. The data files are only closed once synced
+    syncing_ = true;
+    lock.unlock();
+
+    std::vector<std::exception_ptr> errors(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        try {
+            syncFile(files[i].second, files[i].first);
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    }
+
+    lock.lock();
+    syncing_ = false;
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        Target& t = target(files[i].first);
+        if (errors[i]) {
+            // Reported by the next append(), flush() or close() of the file
+            if (!t.error_) {
+                t.error_ = errors[i];
+            }
+            failed_ = true;
+        }
+        else {
+            t.dirty_ = false;
+        }
+    }
+
+    // The log starts again from the beginning, unless staged to meanwhile
+    if (caughtUp()) {
+        SYSCALL(::ftruncate(fd_, 0));
+        size_ = 0;
+    }
+}
+
+void StagingLog::run() {
+
+    std::vector<char> buffer;
+
+    for (;;) {
+
+        Record record;
+        Target* target;
+        bool failed;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty() || (size_ > 0 && caughtUp()); });
+            if (queue_.empty()) {
+                if (size_ > 0 && caughtUp()) {
+                    truncate(lock);
+                    lock.unlock();
+                    cv_.notify_all();
+                    continue;
+                }
+                return;
+            }
+            record = queue_.front();
+            queue_.pop_front();
+            target = &this->target(record.path_);
+            failed = bool(target->error_);
+            busy_ = true;
+        }
+
+        // The data file is not closed while it has records pending, so its descriptor needs no lock. Once writing
+        // to it has failed, its records are left in the log, to be replayed
+        if (!failed) {
+            try {
+                if (target->fd_ < 0) {
+                    target->fd_ = openTarget(record.path_);
+                }
+
+                buffer.resize(record.length_);
+                if (!readFully(fd_, buffer.data(), record.length_, record.logOffset_)) {
+                    throw eckit::ReadError(path_);
+                }
+                writeFully(target->fd_, buffer.data(), record.length_, record.offset_, record.path_);
+            }
+            catch (...) {
+                // Reported by the next append(), flush() or close() of the file
+                std::lock_guard<std::mutex> lock(mutex_);
+                target->error_ = std::current_exception();
+                failed_ = true;
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!target->error_) {
+                target->dirty_ = true;
+            }
+
+            // Caught up: emptied before the record is done with, so that the log is empty once a flush returns
+            if (caughtUp()) {
+                truncate(lock);
+            }
+
+            target->pending_--;
+            busy_ = false;
+        }
+        cv_.notify_all();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
@@ -0,0 +1,158 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   StagingLog.h
+/// @date   Oct 2026
+
+#ifndef fdb5_io_StagingLog_H
+#define fdb5_io_StagingLog_H
+
+#include <sys/types.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Offset.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Write-ahead staging of archived data, enabled by setting fdbStagingDirectory (or $FDB_STAGING_DIRECTORY) to a
+/// fast local directory, e.g. in /dev/shm or on an NVMe device.
+///
+/// Data appended to a data file is recorded, with the file name and its offset in the file, in a log of this process
+/// in the staging directory, and synced to it before the append returns. A thread then writes it to the data file.
+/// The catalogues stage the index entries of the fields archived, until they flush their indexes.
+///
+/// The log is emptied, once the data files written are synced, whenever the thread has caught up and every entry
+/// staged is flushed to its index. Appends wait for the thread once the log holds fdbStagingCapacity bytes, and only
+/// go past it while the log is held by entries that are not flushed yet. Once writing to a data file has failed, the
+/// log is no longer emptied, and is kept when the process ends, as it is if entries staged were never flushed.
+///
+/// The log of a process that died is replayed into the data files by the next process staging to the same directory,
+/// before it stages anything, and the entries its catalogues had not flushed are indexed again. A live process holds
+/// a lock on its log, so that it is never replayed by another. Records for databases whose directory has been removed
+/// since are skipped, and a log that cannot be replayed is set aside with the suffix .failed.
+
+class StagingLog : private eckit::NonCopyable {
+
+public: // methods
+
+    static bool enabled();
+
+    static StagingLog& instance();
+
+    /// The offset of the end of the data file, including the data still staged for it
+    eckit::Offset end(const std::string& path);
+
+    /// Stages data to append to the data file. Returns the offset it will have in the file.
+    /// @throws the error raised writing to this data file before, or if the log is full and can no longer be emptied
+    eckit::Offset append(const std::string& path, const void* data, size_t length);
+
+    /// Waits until the data staged for the file is written to it, and then syncs the file if asked to
+    /// @throws the error raised writing to this data file
+    void flush(const std::string& path, bool sync);
+
+    /// Flushes the data file, and closes it. It is synced anyway if the log still holds data written to it
+    /// @throws the error raised writing to this data file
+    void close(const std::string& path, bool sync);
+
+    /// Stages an entry, as encoded by a catalogue of the database in the directory, for the catalogue to index the
+    /// data staged before it. Synced to the log before it returns
+    void index(const std::string& directory, uintptr_t catalogue, const void* entry, size_t length);
+
+    /// The catalogue has flushed the entries it staged to its indexes, so they are no longer indexed again
+    void indexed(uintptr_t catalogue);
+
+private: // types
+
+    struct Record {
+        std::string path_;
+        off_t offset_;     ///< in the data file
+        off_t logOffset_;  ///< of the data in the log
+        size_t length_;
+    };
+
+    struct Target {
+        int fd_ = -1;
+        off_t end_ = 0;
+        size_t pending_ = 0;  ///< records staged and not yet written
+        bool dirty_ = false;  ///< written since the data files were last synced
+        std::exception_ptr error_;  ///< raised writing to the file. Its later records are left in the log
+    };
+
+private: // methods
+
+    StagingLog(const eckit::PathName& directory, size_t capacity);
+
+    ~StagingLog();
+
+    static void replay(const eckit::PathName& log);
+
+    /// Removes the logs left by processes of this host that died before naming them
+    static void removeUnnamed(const eckit::PathName& directory);
+
+    Target& target(const std::string& path);
+
+    /// Waits until a record of the size fits in the log. Called with the mutex held
+    /// @throws if the log is full and can no longer be emptied
+    void reserve(std::unique_lock<std::mutex>& lock, size_t recordSize);
+
+    /// Writes a record at the end of the log, and returns the offset of its data. Called with the mutex held
+    off_t write(uint32_t magic, const std::string& path, uint64_t offset, const void* data, size_t length, uint32_t crc);
+
+    /// Whether the log may be emptied. Called with the mutex held
+    bool caughtUp() const;
+
+    /// Syncs the data files written, then empties the log if it may still be. Called with the mutex held
+    void truncate(std::unique_lock<std::mutex>& lock);
+
+    void run();
+
+private: // members
+
+    eckit::PathName path_;
+    int fd_;
+
+    size_t capacity_;
+    off_t size_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    std::deque<Record> queue_;
+    std::unordered_map<std::string, Target> targets_;
+
+    std::unordered_set<uintptr_t> unflushed_;  ///< catalogues with entries staged and not flushed
+
+    bool busy_;
+    bool syncing_;  ///< the data files are synced, so none is closed
+    bool stop_;
+    bool failed_;  ///< writing to a data file failed, so the log is kept
+
+    std::thread thread_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace fdb5
+
+#endif
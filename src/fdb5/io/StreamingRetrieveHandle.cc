@@ -0,0 +1,189 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "fdb5/io/StreamingRetrieveHandle.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+
+#include "fdb5/LibFdb5.h"
+#include "fdb5/io/HandleGatherer.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+StreamingRetrieveHandle::StreamingRetrieveHandle(ListIterator&& it, bool sorted, size_t window, bool deduplicate) :
+    it_(std::move(it)),
+    sorted_(sorted),
+    window_(window),
+    deduplicate_(deduplicate),
+    exhausted_(false),
+    resolved_(false),
+    length_(unknownLength),
+    fields_(0),
+    windows_(0) {
+    ASSERT(window_ > 0);
+}
+
+StreamingRetrieveHandle::~StreamingRetrieveHandle() {}
+
+eckit::Length StreamingRetrieveHandle::openForRead() {
+    resolve();
+    return length_;
+}
+
+void StreamingRetrieveHandle::resolve() {
+
+    if (!deduplicate_ || resolved_) {
+        return;
+    }
+
+    // The index of each key is only needed until the listing is resolved
+
+    std::vector<ListElement> elements;
+    std::unordered_map<Key, size_t> positions;
+
+    ListElement el;
+    while (it_.next(el)) {
+        Key key = el.combinedKey();
+        auto p = positions.find(key);
+        if (p == positions.end()) {
+            positions.emplace(std::move(key), elements.size());
+            elements.push_back(el);
+        }
+        else if (elements[p->second].timestamp() < el.timestamp()) {
+            elements[p->second] = el;
+        }
+    }
+
+    length_ = 0;
+    for (ListElement& e : elements) {
+        length_ += e.location().length();
+        resolvedElements_.emplace_back(std::move(e));
+    }
+
+    resolved_ = true;
+}
+
+bool StreamingRetrieveHandle::nextElement(ListElement& element) {
+
+    if (!deduplicate_) {
+        return it_.next(element);
+    }
+
+    resolve();
+    if (resolvedElements_.empty()) {
+        return false;
+    }
+    element = std::move(resolvedElements_.front());
+    resolvedElements_.pop_front();
+    return true;
+}
+
+bool StreamingRetrieveHandle::nextWindow() {
+
+    if (current_) {
+        current_->close();
+        current_.reset();
+    }
+
+    if (exhausted_) {
+        return false;
+    }
+
+    std::vector<ListElement> elements;
+    elements.reserve(window_);
+
+    ListElement el;
+    while (elements.size() < window_) {
+        if (!nextElement(el)) {
+            exhausted_ = true;
+            break;
+        }
+        elements.push_back(el);
+    }
+
+    if (elements.empty()) {
+        return false;
+    }
+
+    HandleGatherer gatherer(sorted_);
+    for (const ListElement& e : elements) {
+        gatherer.add(e.location());
+    }
+
+    fields_ += elements.size();
+    windows_++;
+
+    LOG_DEBUG_LIB(LibFdb5) << "StreamingRetrieveHandle window " << windows_ << " of " << elements.size()
+                           << " fields" << std::endl;
+
+    current_.reset(gatherer.dataHandle());
+    current_->openForRead();
+    return true;
+}
+
+long StreamingRetrieveHandle::read(void* buffer, long length) {
+
+    char* p = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (length > 0) {
+        if (!current_ && !nextWindow()) {
+            break;
+        }
+
+        long n = current_->read(p, length);
+        if (n < 0) {
+            return total ? total : n;
+        }
+        if (n == 0) {
+            if (!nextWindow()) {
+                break;
+            }
+            continue;
+        }
+
+        total += n;
+        p += n;
+        length -= n;
+    }
+
+    return total;
+}
+
+void StreamingRetrieveHandle::close() {
+    if (current_) {
+        current_->close();
+        current_.reset();
+    }
+}
+
+eckit::Length StreamingRetrieveHandle::estimate() {
+    // Only known once a deduplicated listing is resolved. 0 is the DataHandle convention for no estimate.
+    return resolved_ ? length_ : eckit::Length(0);
+}
+
+std::string StreamingRetrieveHandle::title() const {
+    return "StreamingRetrieveHandle";
+}
+
+void StreamingRetrieveHandle::print(std::ostream& s) const {
+    s << "StreamingRetrieveHandle[window=" << window_ << ",sorted=" << sorted_ << ",deduplicate=" << deduplicate_
+      << ",fields=" << fields_ << ",windows=" << windows_ << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace fdb5
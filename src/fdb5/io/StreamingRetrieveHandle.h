@@ -0,0 +1,94 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   StreamingRetrieveHandle.h
+/// @date   Oct 2026
+
+#ifndef fdb5_io_StreamingRetrieveHandle_H
+#define fdb5_io_StreamingRetrieveHandle_H
+
+#include <deque>
+#include <memory>
+
+#include "eckit/io/DataHandle.h"
+
+#include "fdb5/api/helpers/ListIterator.h"
+#include "fdb5/database/Key.h"
+
+namespace fdb5 {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Reads the fields listed by an iterator in windows of at most window fields, so that data flows as soon as
+/// the first window is resolved and only one window of handles is held at a time. When sorted, fields are
+/// reordered within each window only.
+///
+/// When deduplicating, the newest of the fields with the same key wins, as in FDB::read. As a later field may
+/// replace an earlier one, the whole listing is resolved on opening (the handles are still built one window at
+/// a time), and the total length is then known. Otherwise openForRead() returns unknownLength.
+
+class StreamingRetrieveHandle : public eckit::DataHandle {
+
+public: // types
+
+    /// Length returned by openForRead() when the total is not known until the last window is read
+    static constexpr long long unknownLength = -1;
+
+public: // methods
+
+    StreamingRetrieveHandle(ListIterator&& it, bool sorted, size_t window, bool deduplicate);
+
+    ~StreamingRetrieveHandle() override;
+
+    eckit::Length openForRead() override;
+    long read(void* buffer, long length) override;
+    void close() override;
+
+    eckit::Length estimate() override;
+    bool canSeek() const override { return false; }
+
+    std::string title() const override;
+
+private: // methods
+
+    /// When deduplicating, lists every field keeping the newest of each key, in the order keys first appear
+    void resolve();
+
+    bool nextElement(ListElement& element);
+
+    /// Builds the handle of the next window of fields. @returns false once the iterator is exhausted
+    bool nextWindow();
+
+    void print(std::ostream& s) const override;
+
+private: // members
+
+    ListIterator it_;
+
+    bool sorted_;
+    size_t window_;
+    bool deduplicate_;
+
+    std::unique_ptr<eckit::DataHandle> current_;
+    bool exhausted_;
+
+    bool resolved_;
+    std::deque<ListElement> resolvedElements_;  ///< deduplicated fields not yet handed to a window
+    eckit::Length length_;
+
+    size_t fields_;
+    size_t windows_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace fdb5
+
+#endif
@@ -8,8 +8,12 @@
  * does it submit to any jurisdiction.
  */
 
+#include <memory>
+#include <thread>
 #include <vector>
 
+#include "eckit/config/Resource.h"
+#include "eckit/container/Queue.h"
 #include "eckit/log/Timer.h"
 #include "eckit/log/Plural.h"
 #include "eckit/log/Bytes.h"
@@ -28,6 +32,8 @@
 #include "fdb5/LibFdb5.h"
 #include "fdb5/message/MessageArchiver.h"
 #include "fdb5/database/ArchiveVisitor.h"
+#include "fdb5/database/DB.h"
+#include "fdb5/rules/Schema.h"
 
 // For HAVE_FAIL_ON_CCSDS
 #include "metkit/metkit_config.h"
@@ -40,11 +46,27 @@ using eckit::Log;
 
 MessageArchiver::MessageArchiver(const fdb5::Key& key, bool completeTransfers, bool verbose, const Config& config) :
     MessageDecoder(),
+    config_(config),
     fdb_(config),
     key_(key),
+    schemaKeywords_(false),
+    generation_(0),
     completeTransfers_(completeTransfers),
     verbose_(verbose)
 {
+    static bool fdbDecodeSchemaKeywords = eckit::Resource<bool>("fdbDecodeSchemaKeywords;$FDB_DECODE_SCHEMA_KEYWORDS", false);
+
+    // The key of each message need only hold what the schema and the filters select on. Keywords unknown to the
+    // schema then go unnoticed, whereas checkMissingKeysOnWrite would reject the message. Existing databases may
+    // have been written with another schema, whose keywords are added as they are met
+    if (fdbDecodeSchemaKeywords) {
+        schemaKeywords_ = true;
+        config.schema().keywords(decoded_);
+        for (Key::const_iterator i = key_.begin(); i != key_.end(); ++i) {
+            decoded_.insert(i->first);
+        }
+        keywords(decoded_);
+    }
 }
 
 
@@ -101,6 +123,16 @@ static std::vector<metkit::mars::MarsRequest> make_filter_requests(const std::st
 void MessageArchiver::filters(const std::string& include, const std::string& exclude) {
     include_ = make_filter_requests(include);
     exclude_ = make_filter_requests(exclude);
+
+    if (schemaKeywords_) {
+        for (const std::vector<metkit::mars::MarsRequest>* filter : {&include_, &exclude_}) {
+            for (const metkit::mars::MarsRequest& r : *filter) {
+                std::vector<std::string> params = r.params();
+                decoded_.insert(params.begin(), params.end());
+            }
+        }
+        keywords(decoded_);
+    }
 }
 
 void MessageArchiver::modifiers(const std::string& modify) {
@@ -157,63 +189,206 @@ bool MessageArchiver::filterOut(const Key& k) const {
     return !out;
 }
 
-eckit::Length MessageArchiver::archive(eckit::DataHandle& source) {
+bool MessageArchiver::decode(eckit::message::Message& msg, Key& key) {
 
-    eckit::Timer timer("fdb::service::archive");
+#ifdef metkit_HAVE_FAIL_ON_CCSDS
 
-    eckit::message::Reader reader(source);
+    if(msg.getString("packingType") == "grid_ccsds") {
+        throw eckit::SeriousBug("grid_ccsds is disabled");
+    }
 
-    size_t count = 0;
-    size_t total_size = 0;
+#endif
 
-    eckit::Progress progress("FDB archive", 0, source.estimate());
+    size_t generation = generation_;
 
-    try {
+    key.clear();
+    messageToKey(msg, key);
 
-        eckit::message::Message msg;
+    if (schemaKeywords_ && addDatabaseKeywords(key, generation)) {
+        key.clear();
+        messageToKey(msg, key);
+    }
 
-        while ( (msg = reader.next()) ) {
+    LOG_DEBUG_LIB(LibFdb5) << "Archiving message "
+                           << " key: " << key_ << " data: " << msg.data() << " length:" << msg.length()
+                           << std::endl;
 
-#ifdef metkit_HAVE_FAIL_ON_CCSDS
+    ASSERT(key.match(key_));
 
-            if(msg.getString("packingType") == "grid_ccsds") {
-                throw eckit::SeriousBug("grid_ccsds is disabled");
-            }
+    if (filterOut(key))
+        return false;
 
-#endif
+    if (modifiers_.size()) {
+        msg = transform(msg);
+        key.clear();
+        messageToKey(msg, key);  // re-build the key, as it may have changed
+    }
 
-            Key key;
+    return true;
+}
+
+bool MessageArchiver::addDatabaseKeywords(const Key& key, size_t generation) {
+
+    Key dbKey;
+    if (!config_.schema().expandFirstLevel(key, dbKey)) {
+        return false; // the archiver reports it
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (databases_.insert(dbKey).second && DB::mayExist(dbKey, config_)) {
+
+        std::unique_ptr<DB> db = DB::buildReader(dbKey, config_);
+        size_t before = decoded_.size();
+
+        if (db->exists()) {
+            db->schema().keywords(decoded_);
+        }
+
+        if (decoded_.size() != before) {
+            LOG_DEBUG_LIB(LibFdb5) << "Decoding the keywords of the schema of " << *db << std::endl;
+            keywords(decoded_);
+            generation_++;
+        }
+    }
+
+    // Also if added by another thread since the message was decoded
+    return generation != generation_;
+}
+
+namespace {
 
-            messageToKey(msg, key);
+/// A message decoded by a worker of MessageArchiver::decodeInParallel
+struct DecodedMessage {
+    eckit::message::Message msg_;
+    Key key_;
+    bool archive_ = false;
+};
 
-            LOG_DEBUG_LIB(LibFdb5) << "Archiving message "
-                                   << " key: " << key_ << " data: " << msg.data() << " length:" << msg.length()
-                                   << std::endl;
+} // namespace
 
-            ASSERT(key.match(key_));
+void MessageArchiver::decodeInParallel(eckit::message::Reader& reader, size_t threads,
+                                       const std::function<void(const eckit::message::Message&, const Key&)>& archive) {
 
-            if (filterOut(key))
-                continue;
+    // Messages are dealt to the workers in turn, and their keys collected in the same turn, so that they are archived
+    // in the order read. The queues are short, to bound the memory held by messages in flight
+    const size_t queueSize = 4;
 
-            if (modifiers_.size()) {
-                msg = transform(msg);
-                key.clear();
-                messageToKey(msg, key);  // re-build the key, as it may have changed
+    std::vector<std::unique_ptr<eckit::Queue<eckit::message::Message>>> input;
+    std::vector<std::unique_ptr<eckit::Queue<DecodedMessage>>> output;
+    for (size_t i = 0; i < threads; ++i) {
+        input.emplace_back(new eckit::Queue<eckit::message::Message>(queueSize));
+        output.emplace_back(new eckit::Queue<DecodedMessage>(queueSize));
+    }
+
+    // Any failure stops every stage of the pipeline
+    auto interrupt = [&input, &output](std::exception_ptr error) {
+        for (auto& q : input) {
+            q->interrupt(error);
+        }
+        for (auto& q : output) {
+            q->interrupt(error);
+        }
+    };
+
+    std::vector<std::thread> pipeline;
+
+    pipeline.emplace_back([&reader, &input, &interrupt, threads] {
+        try {
+            eckit::message::Message msg;
+            for (size_t n = 0; (msg = reader.next()); ++n) {
+                input[n % threads]->push(msg);
+            }
+            for (auto& q : input) {
+                q->close();
+            }
+        }
+        catch (...) {
+            interrupt(std::current_exception());
+        }
+    });
+
+    for (size_t i = 0; i < threads; ++i) {
+        pipeline.emplace_back([this, i, &input, &output, &interrupt] {
+            try {
+                eckit::message::Message msg;
+                while (input[i]->pop(msg) != -1) {
+                    DecodedMessage decoded;
+                    decoded.archive_ = decode(msg, decoded.key_);
+                    decoded.msg_ = msg;
+                    output[i]->emplace(std::move(decoded));
+                }
+                output[i]->close();
+            }
+            catch (...) {
+                interrupt(std::current_exception());
             }
+        });
+    }
 
-            if (verbose_) {
-                Log::info() << "Archiving " << key << std::endl;
-            } else {
-                LOG_DEBUG_LIB(LibFdb5) << "Archiving " << key << std::endl;
+    try {
+        DecodedMessage decoded;
+        for (size_t n = 0; output[n % threads]->pop(decoded) != -1; ++n) {
+            if (decoded.archive_) {
+                archive(decoded.msg_, decoded.key_);
             }
+        }
+    }
+    catch (...) {
+        interrupt(std::current_exception());
+        for (std::thread& t : pipeline) {
+            t.join();
+        }
+        throw;
+    }
 
-            fdb_.archive(key, msg.data(), msg.length());
+    for (std::thread& t : pipeline) {
+        t.join();
+    }
+}
 
-            total_size += msg.length();
-            count++;
-            progress(total_size);
+eckit::Length MessageArchiver::archive(eckit::DataHandle& source) {
 
-            // flush();
+    static size_t fdbArchiveDecodeThreads = eckit::Resource<size_t>("fdbArchiveDecodeThreads;$FDB_ARCHIVE_DECODE_THREADS", 0);
+
+    eckit::Timer timer("fdb::service::archive");
+
+    eckit::message::Reader reader(source);
+
+    size_t count = 0;
+    size_t total_size = 0;
+
+    eckit::Progress progress("FDB archive", 0, source.estimate());
+
+    auto archiveMessage = [&](const eckit::message::Message& msg, const Key& key) {
+
+        if (verbose_) {
+            Log::info() << "Archiving " << key << std::endl;
+        } else {
+            LOG_DEBUG_LIB(LibFdb5) << "Archiving " << key << std::endl;
+        }
+
+        fdb_.archive(key, msg.data(), msg.length());
+
+        total_size += msg.length();
+        count++;
+        progress(total_size);
+    };
+
+    try {
+
+        if (fdbArchiveDecodeThreads) {
+            decodeInParallel(reader, fdbArchiveDecodeThreads, archiveMessage);
+        }
+        else {
+            eckit::message::Message msg;
+            Key key;
+
+            while ( (msg = reader.next()) ) {
+                if (decode(msg, key)) {
+                    archiveMessage(msg, key);
+                }
+            }
         }
 
     } catch (...) {
@@ -15,7 +15,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <iosfwd>
+#include <mutex>
+#include <set>
 
 #include "eckit/io/Length.h"
 
@@ -29,6 +33,9 @@
 
 namespace eckit {
 class DataHandle;
+namespace message {
+class Reader;
+}
 }
 
 namespace fdb5 {
@@ -57,8 +64,22 @@ private: // protected
 
     eckit::message::Message transform(eckit::message::Message&);
 
+    /// Makes the key of the message, transforming it if asked to. Returns false if the message is filtered out
+    bool decode(eckit::message::Message& msg, Key& key);
+
+    /// Adds to the keywords decoded those of the schema of the existing database the key belongs to, the first time
+    /// it is seen. Returns true if keywords were added since the generation the key was decoded with, in which case
+    /// the message must be decoded again
+    bool addDatabaseKeywords(const Key& key, size_t generation);
+
+    /// Reads the messages from a thread, decodes them on others, and archives them from this one, in the order read
+    void decodeInParallel(eckit::message::Reader& reader, size_t threads,
+                          const std::function<void(const eckit::message::Message&, const Key&)>& archive);
+
 private: // members
 
+    Config config_;
+
     FDB fdb_;
 
     fdb5::Key key_;
@@ -68,6 +89,13 @@ private: // members
 
     eckit::StringDict modifiers_;
 
+    bool schemaKeywords_;       ///< only the keywords used are decoded from the messages
+    eckit::StringSet decoded_;  ///< keywords decoded from the messages, if only those used are
+
+    std::mutex mutex_;        ///< guards the keywords decoded, as messages may be decoded in parallel
+    std::set<Key> databases_; ///< databases whose schema keywords have been added to those decoded
+    std::atomic<size_t> generation_;  ///< of the keywords decoded, counting the changes
+
     bool completeTransfers_;
 
     bool verbose_;
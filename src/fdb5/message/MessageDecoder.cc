@@ -9,10 +9,13 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <memory>
 
 #include "fdb5/message/MessageDecoder.h"
 
+#include "eckit/exception/Exceptions.h"
 #include "eckit/message/Reader.h"
 #include "eckit/message/Message.h"
 
@@ -25,6 +28,8 @@ namespace fdb5 {
 namespace  {
 class KeySetter : public eckit::message::MetadataGatherer {
 
+protected:
+
     void setValue(const std::string& key, const std::string& value) override {
         key_.set(key, value);
     }
@@ -41,7 +46,6 @@ class KeySetter : public eckit::message::MetadataGatherer {
         }
     }
 
-protected:
     Key& key_;
 
 public:
@@ -51,6 +55,34 @@ public:
     }
 };
 
+/// Only sets the keywords asked for. Those the message does not have are simply never seen
+class KeywordSetter : public KeySetter {
+
+    void setValue(const std::string& key, const std::string& value) override {
+        if (keywords_.find(key) != keywords_.end()) {
+            KeySetter::setValue(key, value);
+        }
+    }
+
+    void setValue(const std::string& key, long value) override {
+        if (keywords_.find(key) != keywords_.end()) {
+            KeySetter::setValue(key, value);
+        }
+    }
+
+    void setValue(const std::string& key, double value) override {
+        if (keywords_.find(key) != keywords_.end()) {
+            KeySetter::setValue(key, value);
+        }
+    }
+
+    const eckit::StringSet& keywords_;
+
+public:
+
+    KeywordSetter(Key& key, const eckit::StringSet& keywords): KeySetter(key), keywords_(keywords) {}
+};
+
 }  // namespace
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -76,11 +108,36 @@ void MessageDecoder::msgToKey(const eckit::message::Message& msg, Key& key) {
     key.unset("stepunits");
 }
 
+void MessageDecoder::keywordsToKey(const eckit::message::Message& msg, const eckit::StringSet& keywords, Key& key) {
+
+    KeywordSetter setter(key, keywords);
+    msg.getMetadata(setter);
+}
+
+void MessageDecoder::keywords(const eckit::StringSet& keywords) {
+
+    std::shared_ptr<eckit::StringSet> decoded;
+
+    if (!keywords.empty()) {
+        decoded = std::make_shared<eckit::StringSet>(keywords);
+        decoded->erase("stepunits");
+    }
+
+    std::atomic_store(&keywords_, std::shared_ptr<const eckit::StringSet>(decoded));
+}
+
 void MessageDecoder::messageToKey(const eckit::message::Message& msg, Key& key) {
 
     eckit::message::Message patched = patch(msg);
 
-    msgToKey(patched, key);
+    std::shared_ptr<const eckit::StringSet> keywords = std::atomic_load(&keywords_);
+
+    if (keywords) {
+        keywordsToKey(patched, *keywords, key);
+    }
+    else {
+        msgToKey(patched, key);
+    }
 
     if ( checkDuplicates_ ) {
         if ( seen_.find(key) != seen_.end() ) {
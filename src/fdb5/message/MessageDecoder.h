@@ -18,7 +18,10 @@
 
 
 #include "eckit/io/Buffer.h"
+#include "eckit/types/Types.h"
 #include "metkit/mars/MarsRequest.h"
+#include <memory>
+#include <string>
 #include <vector>
 
 struct grib_handle;
@@ -53,14 +56,21 @@ public:
     metkit::mars::MarsRequest messageToRequest(const eckit::PathName &path, const char *verb = "retrieve");
     std::vector<metkit::mars::MarsRequest> messageToRequests(const eckit::PathName &path, const char *verb = "retrieve");
 
+    /// Keeps only these keywords of the MARS metadata of the messages in their keys. Keywords missing from a message
+    /// are left out of its key. An empty set keeps them all again. May be called while messages are being decoded
+    void keywords(const eckit::StringSet& keywords);
 
 private:
 
     virtual eckit::message::Message patch(const eckit::message::Message& msg);
     static void msgToKey(const eckit::message::Message& msg, Key& key);
+    static void keywordsToKey(const eckit::message::Message& msg, const eckit::StringSet& keywords, Key& key);
 
     bool checkDuplicates_;
     std::set<Key> seen_;
+
+    /// Keywords to decode, or null for all of them. Replaced as a whole, so that a decoding thread keeps its own copy
+    std::shared_ptr<const eckit::StringSet> keywords_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -182,6 +182,7 @@ private:
 
 RemoteHandler::RemoteHandler(eckit::net::TCPSocket& socket, const Config& config) :
     config_(config),
+    remoteProtocolVersion_(LibFdb5::instance().remoteProtocolVersion().used()),
     controlSocket_(socket),
     dataSocket_(selectDataPort()),
     dataListenHostname_(config.getString("dataListenHostname", "")),
@@ -261,6 +262,8 @@ void RemoteHandler::initialiseConnections() {
     }
 
     if (errorMsg.empty()) {
+        remoteProtocolVersion_ = remoteProtocolVersion;
+
         LocalConfiguration clientAvailableFunctionality(s1);
         LocalConfiguration serverConf = availableFunctionality();
         agreedConf_ = LocalConfiguration();
@@ -579,6 +582,7 @@ void RemoteHandler::forwardApiCall(const MessageHeader& hdr) {
 
     workerThreads_.emplace(
         hdr.requestID, std::async(std::launch::async, [request, hdr, helper, this]() {
+            RemoteProtocolVersion::Streamed streamed(remoteProtocolVersion_);
             try {
                 auto iterator = helper.apiCall(fdb_, request);
 
@@ -798,6 +802,7 @@ void RemoteHandler::read(const MessageHeader& hdr) {
     Buffer payload(receivePayload(hdr, controlSocket_));
     MemoryStream s(payload);
 
+    RemoteProtocolVersion::Streamed streamed(remoteProtocolVersion_);
     std::unique_ptr<FieldLocation> location(eckit::Reanimator<FieldLocation>::reanimate(s));
 
     LOG_DEBUG_LIB(LibFdb5) << "Queuing for read: " << hdr.requestID << " " << *location << std::endl;
@@ -104,6 +104,7 @@ private:  // members
     eckit::SessionID sessionID_;
 
     eckit::LocalConfiguration agreedConf_;
+    unsigned int remoteProtocolVersion_; ///< that of the client, which objects are streamed with
 
     eckit::net::TCPSocket controlSocket_;
     eckit::net::EphemeralTCPServer dataSocket_;
@@ -33,6 +33,10 @@ bool MatchHidden::match(const std::string&, const Key&) const {
     return true;
 }
 
+bool MatchHidden::discriminating() const {
+    return false;
+}
+
 bool MatchHidden::optional() const {
     return true;
 }
@@ -36,6 +36,10 @@ bool MatchOptional::match(const std::string&, const Key&) const {
     return true;
 }
 
+bool MatchOptional::discriminating() const {
+    return false;
+}
+
 bool MatchOptional::optional() const {
     return true;
 }
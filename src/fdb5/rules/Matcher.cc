@@ -29,6 +29,10 @@ bool Matcher::optional() const {
     return false;
 }
 
+bool Matcher::discriminating() const {
+    return true;
+}
+
 const std::string &Matcher::value(const Key &key, const std::string &keyword) const {
     return key.get(keyword);
 }
@@ -45,6 +45,9 @@ public: // methods
 
     virtual bool optional() const;
 
+    /// Whether match() may reject a key, depending on the value of the keyword
+    virtual bool discriminating() const;
+
     virtual const std::string &value(const Key &, const std::string &keyword) const;
     virtual const std::vector<std::string>& values(const metkit::mars::MarsRequest& rq, const std::string& keyword) const;
     virtual const std::string &defaultValue() const;
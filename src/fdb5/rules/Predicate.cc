@@ -31,6 +31,10 @@ bool Predicate::match(const Key &key) const {
     return matcher_->match(keyword_, key);
 }
 
+bool Predicate::discriminating() const {
+    return matcher_->discriminating();
+}
+
 void Predicate::dump(std::ostream &s, const TypesRegistry &registry) const {
     matcher_->dump(s, keyword_, registry);
 }
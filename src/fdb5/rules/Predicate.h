@@ -41,6 +41,7 @@ public: // methods
     ~Predicate();
 
     bool match(const Key &key) const;
+    bool discriminating() const;
 
     void dump( std::ostream &s, const TypesRegistry &registry ) const;
     void fill(Key &key, const std::string& value) const;
@@ -129,8 +129,101 @@ void Rule::expand( const metkit::mars::MarsRequest &request,
 
 }
 
+void Rule::expandDatums(const metkit::mars::MarsRequest &request,
+                        std::vector<Key> &keys,
+                        Key &full,
+                        ReadVisitor &visitor) const {
+
+    // Neither the values offered for a keyword nor the matchers depend on the values of the other
+    // keywords of the level, so each predicate is resolved once
+
+    std::vector<std::string> keywords;
+    std::vector<eckit::StringList> values(predicates_.size());
+
+    keywords.reserve(predicates_.size());
+
+    Key probe;
+    for (size_t p = 0; p < predicates_.size(); ++p) {
+
+        const Predicate& predicate = *predicates_[p];
+        keywords.push_back(predicate.keyword());
+        const std::string &keyword = keywords.back();
+
+        eckit::StringList candidates;
+        visitor.values(request, keyword, *registry_, candidates);
+
+        if (candidates.empty() && predicate.optional()) {
+            candidates.push_back(predicate.defaultValue());
+        }
+
+        values[p].reserve(candidates.size());
+        for (const std::string& v : candidates) {
+            probe.set(keyword, v);
+            if (predicate.match(probe)) {
+                values[p].push_back(v);
+            }
+        }
+
+        if (values[p].empty()) {
+            return;
+        }
+    }
+
+    Key &k = keys[2];
+    k.registry(registry());
+
+    // Enumerate with the last predicate varying fastest, as the recursive expansion does, updating
+    // the keys in place
+
+    for (size_t p = 0; p < predicates_.size(); ++p) {
+        k.push(keywords[p], values[p].front());
+        full.push(keywords[p], values[p].front());
+    }
+
+    std::vector<size_t> current(predicates_.size(), 0);
+
+    while (true) {
+
+        visitor.selectDatum(k, full);
+
+        size_t p = predicates_.size();
+        while (p > 0) {
+            --p;
+            if (++current[p] < values[p].size()) {
+                break;
+            }
+            current[p] = 0;
+            if (p == 0) {
+                break;
+            }
+        }
+
+        if (p == 0 && current[0] == 0) {
+            break;
+        }
+
+        for (size_t q = p; q < predicates_.size(); ++q) {
+            const std::string &v = values[q][current[q]];
+            k.set(keywords[q], v);
+            full.set(keywords[q], v);
+        }
+    }
+
+    for (size_t p = predicates_.size(); p > 0; --p) {
+        full.pop(keywords[p - 1]);
+        k.pop(keywords[p - 1]);
+    }
+}
+
 void Rule::expand(const metkit::mars::MarsRequest &request, ReadVisitor &visitor, size_t depth, std::vector<Key> &keys, Key &full) const {
     ASSERT(keys.size() == 3);
+
+    if (rules_.empty() && !predicates_.empty()) {
+        ASSERT(depth == 2); /// we have 3 levels ATM
+        expandDatums(request, keys, full, visitor);
+        return;
+    }
+
     expand(request, predicates_.begin(), depth, keys, full, visitor);
 }
 
@@ -139,7 +232,8 @@ void Rule::expand( const Key &field,
                    size_t depth,
                    std::vector<Key> &keys,
                    Key &full,
-                   WriteVisitor &visitor) const {
+                   WriteVisitor &visitor,
+                   const Rule* child) const {
 
     static bool matchFirstFdbRule = eckit::Resource<bool>("matchFirstFdbRule", true);
 
@@ -194,6 +288,12 @@ void Rule::expand( const Key &field,
                 break;
             }
 
+            if (child) {
+                ASSERT(child->parent_ == this);
+                child->expand(field, visitor, depth + 1, keys, full);
+                return;
+            }
+
             for (std::vector<Rule *>::const_iterator i = rules_.begin(); i != rules_.end(); ++i ) {
                 (*i)->expand(field, visitor, depth + 1, keys, full);
             }
@@ -213,7 +313,7 @@ void Rule::expand( const Key &field,
     full.push(keyword, value);
 
     if ((*cur)->match(k)) {
-        expand(field, next, depth, keys, full, visitor);
+        expand(field, next, depth, keys, full, visitor, child);
     }
 
     full.pop(keyword);
@@ -221,9 +321,9 @@ void Rule::expand( const Key &field,
 
 
 }
-void Rule::expand(const Key &field, WriteVisitor &visitor, size_t depth, std::vector<Key> &keys, Key &full) const {
+void Rule::expand(const Key &field, WriteVisitor &visitor, size_t depth, std::vector<Key> &keys, Key &full, const Rule* child) const {
     ASSERT(keys.size() == 3);
-    expand(field, predicates_.begin(), depth, keys, full, visitor);
+    expand(field, predicates_.begin(), depth, keys, full, visitor, child);
 }
 
 void Rule::expandFirstLevel( const Key &dbKey, std::vector<Predicate *>::const_iterator cur, Key &result, bool& found) const {
@@ -470,6 +570,26 @@ void Rule::updateParent(const Rule *parent) {
     }
 }
 
+void Rule::discriminatingKeywords(eckit::StringSet &result) const {
+    for (const Predicate* p : predicates_) {
+        if (p->discriminating()) {
+            result.insert(p->keyword());
+        }
+    }
+    for (const Rule* r : rules_) {
+        r->discriminatingKeywords(result);
+    }
+}
+
+void Rule::keywords(eckit::StringSet &result) const {
+    for (const Predicate* p : predicates_) {
+        result.insert(p->keyword());
+    }
+    for (const Rule* r : rules_) {
+        r->keywords(result);
+    }
+}
+
 const std::shared_ptr<TypesRegistry> Rule::registry() const {
     return registry_;
 }
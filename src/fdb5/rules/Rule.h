@@ -66,11 +66,13 @@ public: // methods
                 std::vector<fdb5::Key> &keys,
                 Key &full) const;
 
+    /// If child is given, the expansion continues below this rule only through that one of its rules
     void expand(const Key &field,
                 WriteVisitor &Visitor,
                 size_t depth,
                 std::vector<fdb5::Key> &keys,
-                Key &full) const;
+                Key &full,
+                const Rule* child = nullptr) const;
 
     const Rule* ruleFor(const std::vector<fdb5::Key> &keys, size_t depth) const;
     void fill(Key& key, const eckit::StringList& values) const;
@@ -100,7 +102,15 @@ private: // methods
                 size_t depth,
                 std::vector<Key> &keys,
                 Key &full,
-                WriteVisitor &Visitor) const;
+                WriteVisitor &Visitor,
+                const Rule* child) const;
+
+    /// Expands the datum level as a cartesian product over the values of each predicate, computed and
+    /// matched once, rather than per combination of the values of the predicates before it
+    void expandDatums(const metkit::mars::MarsRequest &request,
+                      std::vector<Key> &keys,
+                      Key &full,
+                      ReadVisitor &visitor) const;
 
     void expandFirstLevel(const Key &dbKey, std::vector<Predicate *>::const_iterator cur, Key &result, bool& done) const;
     void expandFirstLevel(const Key &dbKey,  Key &result, bool& done) const ;
@@ -115,6 +125,12 @@ private: // methods
 
     void keys(size_t level, size_t depth, eckit::StringList &result, eckit::StringSet &seen) const;
 
+    /// Collects the keywords, in this rule and the rules below it, whose values may make a predicate fail
+    void discriminatingKeywords(eckit::StringSet &result) const;
+
+    /// Collects the keywords of every predicate, in this rule and the rules below it
+    void keywords(eckit::StringSet &result) const;
+
     friend std::ostream &operator<<(std::ostream &s, const Rule &x);
 
     void print( std::ostream &out ) const;
@@ -10,6 +10,8 @@
 
 #include <fstream>
 
+#include "eckit/config/Resource.h"
+
 #include "fdb5/LibFdb5.h"
 #include "fdb5/rules/Schema.h"
 #include "fdb5/rules/Rule.h"
@@ -21,6 +23,19 @@ namespace fdb5 {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+/// Routes are only valid if the expansion stops at the first rule matching a field
+size_t maxRoutes() {
+    static bool matchFirstFdbRule = eckit::Resource<bool>("matchFirstFdbRule", true);
+    static size_t fdbSchemaRoutes = eckit::Resource<size_t>("fdbSchemaRoutes;$FDB_SCHEMA_ROUTES", 1024);
+    return matchFirstFdbRule ? fdbSchemaRoutes : 0;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 Schema::Schema() : registry_(new TypesRegistry()) {
 
 }
@@ -70,8 +85,32 @@ void Schema::expand(const Key &field, WriteVisitor &visitor) const {
 
     visitor.rule(0); // reset to no rule so we verify that we pick at least one
 
+    bool routing = maxRoutes() > 0;
+    std::string sig;
+
+    if (routing) {
+        sig = signature(field);
+        const Rule* top = firstRoute(sig);
+        if (top) {
+            top->expand(field, visitor, 0, keys, full);
+            if (visitor.rule()) {
+                return;
+            }
+        }
+    }
+
+    const Rule* taken = nullptr;
     for (std::vector<Rule *>::const_iterator i = rules_.begin(); i != rules_.end(); ++i ) {
         (*i)->expand(field, visitor, 0, keys, full);
+        if (!taken && visitor.rule()) {
+            taken = *i;
+        }
+    }
+
+    // Only route straight to the rule taken if every rule before it fails on its own predicates, so that
+    // no database selected on the way is skipped
+    if (routing && taken && firstMatching(rules_, field) == taken) {
+        addFirstRoute(sig, taken);
     }
 }
 
@@ -99,6 +138,26 @@ void Schema::expandSecond(const metkit::mars::MarsRequest& request, ReadVisitor&
 
 void Schema::expandSecond(const Key& field, WriteVisitor& visitor, const Key& dbKey) const {
 
+    Key full = dbKey;
+    std::vector<Key> keys(3);
+    keys[0] = dbKey;
+    keys[1].registry(registry());
+    keys[2].registry(registry());
+
+    bool routing = maxRoutes() > 0;
+    std::string sig;
+
+    if (routing) {
+        sig = signature(field);
+        Route route;
+        if (secondRoute(sig, route)) {
+            route.index_->expand(field, visitor, 1, keys, full, route.datum_);
+            if (visitor.rule()) {
+                return;
+            }
+        }
+    }
+
     const Rule* dbRule = nullptr;
     for (const Rule* r : rules_) {
         if (r->match(dbKey)) {
@@ -108,15 +167,77 @@ void Schema::expandSecond(const Key& field, WriteVisitor& visitor, const Key& db
     }
     ASSERT(dbRule);
 
-    Key full = dbKey;
-    std::vector<Key> keys(3);
-    keys[0] = dbKey;
-    keys[1].registry(registry());
-    keys[2].registry(registry());
-
     for (std::vector<Rule*>:: const_iterator i = dbRule->rules_.begin(); i != dbRule->rules_.end(); ++i) {
         (*i)->expand(field, visitor, 1, keys, full);
     }
+
+    // As above, the route must not skip an index selected on the way to the rule taken
+    if (routing && visitor.rule()) {
+        const Rule* datum = visitor.rule();
+        const Rule* index = datum->parent_;
+        if (index && index->parent_ == dbRule && firstMatching(dbRule->rules_, field) == index) {
+            addSecondRoute(sig, Route{index, datum});
+        }
+    }
+}
+
+std::string Schema::signature(const Key& field) const {
+    std::string result;
+    for (Key::const_iterator i = field.begin(); i != field.end(); ++i) {
+        result += i->first;
+        if (discriminating_.find(i->first) != discriminating_.end()) {
+            result += '=';
+            result += std::to_string(i->second.size());
+            result += ':';
+            result += i->second;
+        }
+        result += ',';
+    }
+    return result;
+}
+
+const Rule* Schema::firstRoute(const std::string& signature) const {
+    std::lock_guard<std::mutex> lock(routesMutex_);
+    auto it = firstRoutes_.find(signature);
+    return (it == firstRoutes_.end()) ? nullptr : it->second;
+}
+
+void Schema::addFirstRoute(const std::string& signature, const Rule* rule) const {
+    std::lock_guard<std::mutex> lock(routesMutex_);
+    if (firstRoutes_.size() >= maxRoutes()) {
+        firstRoutes_.clear();
+    }
+    firstRoutes_[signature] = rule;
+}
+
+bool Schema::secondRoute(const std::string& signature, Route& route) const {
+    std::lock_guard<std::mutex> lock(routesMutex_);
+    auto it = secondRoutes_.find(signature);
+    if (it == secondRoutes_.end()) {
+        return false;
+    }
+    route = it->second;
+    return true;
+}
+
+void Schema::addSecondRoute(const std::string& signature, const Route& route) const {
+    std::lock_guard<std::mutex> lock(routesMutex_);
+    if (secondRoutes_.size() >= maxRoutes()) {
+        secondRoutes_.clear();
+    }
+    secondRoutes_[signature] = route;
+}
+
+const Rule* Schema::firstMatching(const std::vector<Rule*>& rules, const Key& field) {
+    for (const Rule* r : rules) {
+        Key tmp;
+        bool found = false;
+        r->expandFirstLevel(field, tmp, found);
+        if (found) {
+            return r;
+        }
+    }
+    return nullptr;
 }
 
 bool Schema::expandFirstLevel(const Key &dbKey,  Key &result) const {
@@ -198,6 +319,15 @@ void Schema::check() {
         (*i)->registry_->updateParent(registry_);
         (*i)->updateParent(0);
     }
+
+    discriminating_.clear();
+    for (const Rule* r : rules_) {
+        r->discriminatingKeywords(discriminating_);
+    }
+
+    std::lock_guard<std::mutex> lock(routesMutex_);
+    firstRoutes_.clear();
+    secondRoutes_.clear();
 }
 
 void Schema::print(std::ostream &out) const {
@@ -213,6 +343,12 @@ bool Schema::empty() const {
     return rules_.empty();
 }
 
+void Schema::keywords(eckit::StringSet& result) const {
+    for (const Rule* r : rules_) {
+        r->keywords(result);
+    }
+}
+
 const std::string &Schema::path() const {
     return path_;
 }
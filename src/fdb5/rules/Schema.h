@@ -19,11 +19,15 @@
 #include <iosfwd>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/DataHandle.h"
 #include "eckit/memory/NonCopyable.h"
+#include "eckit/types/Types.h"
 
 #include "fdb5/types/TypesRegistry.h"
 
@@ -72,6 +76,9 @@ public: // methods
 
     bool empty() const;
 
+    /// Collects the keywords the rules use, which an archived field is expected to have
+    void keywords(eckit::StringSet& result) const;
+
     const Type &lookupType(const std::string &keyword) const;
 
     const std::string &path() const;
@@ -79,11 +86,31 @@ public: // methods
     const std::shared_ptr<TypesRegistry> registry() const;
 
 
+private: // types
+
+    /// The rules an archived field went through below the top rule of a database schema
+    struct Route {
+        const Rule* index_;
+        const Rule* datum_;
+    };
+
 private: // methods
 
     void clear();
     void check();
 
+    /// Archived fields with the same keywords, and the same values for the keywords on which some
+    /// predicate may fail, go through the same rules. The signature identifies that class of fields
+    std::string signature(const Key& field) const;
+
+    const Rule* firstRoute(const std::string& signature) const;
+    void addFirstRoute(const std::string& signature, const Rule* rule) const;
+    bool secondRoute(const std::string& signature, Route& route) const;
+    void addSecondRoute(const std::string& signature, const Route& route) const;
+
+    /// The first of the rules whose own predicates match the field
+    static const Rule* firstMatching(const std::vector<Rule*>& rules, const Key& field);
+
     friend std::ostream &operator<<(std::ostream &s, const Schema &x);
 
     void print( std::ostream &out ) const;
@@ -94,6 +121,12 @@ private: // members
     std::vector<Rule *>  rules_;
     std::string path_;
 
+    eckit::StringSet discriminating_;
+
+    mutable std::mutex routesMutex_;
+    mutable std::unordered_map<std::string, const Rule*> firstRoutes_;
+    mutable std::unordered_map<std::string, Route> secondRoutes_;
+
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -43,6 +43,7 @@ private:  // methods
     virtual void funlock();
     virtual void visit(BTreeIndexVisitor& visitor) const;
     virtual void preload();
+    virtual size_t pageSize() const { return RECSIZE; }
 
 private:  // members
     mutable BTreeStore btree_;
@@ -142,6 +143,8 @@ void TBTreeIndex<KEYSIZE, RECSIZE, PAYLOAD>::preload() {
 BTREE(32, 65536, FieldRefReduced);
 BTREE(32, 65536, FieldRefFull);
 BTREE(32, 4194304, FieldRefReduced);
+BTREE(32, 65536, FieldRefChecksummed);
+BTREE(32, 65536, FieldRefStored);
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -151,15 +154,23 @@ BTreeIndex::~BTreeIndex() {
 
 
 const std::string& BTreeIndex::defaulType() {
-    static std::string fdbIndexType = eckit::Resource<std::string>("fdbIndexType;$FDB_INDEX_TYPE", "BTreeIndex");
+    static bool fdbFieldChecksums = eckit::Resource<bool>("fdbFieldChecksums;$FDB_FIELD_CHECKSUMS", true);
+    static std::string fdbIndexType = eckit::Resource<std::string>("fdbIndexType;$FDB_INDEX_TYPE",
+                                                                   fdbFieldChecksums ? "BTreeIndexChecksum" : "BTreeIndex");
     // gesalous hack
     // static std::string fdbIndexType = eckit::Resource<std::string>("fdbIndexType;$FDB_INDEX_TYPE", "LSMIndex");
     return fdbIndexType;
 }
 
+bool BTreeIndex::storesChecksums(const std::string& type) {
+    return type == "BTreeIndexChecksum" || type == "BTreeIndexStored";
+}
+
 static BTreeIndexBuilder<BTreeIndex_32_65536_FieldRefReduced> defaultIndex("BTreeIndex");
 static BTreeIndexBuilder<BTreeIndex_32_65536_FieldRefFull> PointDBIndex("PointDBIndex");
 static BTreeIndexBuilder<BTreeIndex_32_4194304_FieldRefReduced> BTreeIndex4MB("BTreeIndex4MB");
+static BTreeIndexBuilder<BTreeIndex_32_65536_FieldRefChecksummed> BTreeIndexChecksum("BTreeIndexChecksum");
+static BTreeIndexBuilder<BTreeIndex_32_65536_FieldRefStored> BTreeIndexStored("BTreeIndexStored");
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -50,9 +50,16 @@ public:
     virtual void funlock() = 0;
     virtual void preload() = 0;
 
+    /// Size of a page, of which the open BTree holds at least one in memory
+    virtual size_t pageSize() const = 0;
 
+    /// Index type set by fdbIndexType (or $FDB_INDEX_TYPE). Unset, it is BTreeIndexChecksum if field checksums are
+    /// computed (fdbFieldChecksums, on by default), so that they are recorded, and BTreeIndex otherwise.
     static const std::string& defaulType();
 
+    /// Whether indexes of the given type store the checksums of the fields
+    static bool storesChecksums(const std::string& type);
+
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -51,28 +51,160 @@ FieldRefReduced::FieldRefReduced() {
 
 }
 
+namespace {
+
+void checkUncompressed(const FieldRef& ref) {
+    if (!ref.codec().empty()) {
+        throw eckit::UserError("Field is stored compressed but the index type cannot record it (use BTreeIndexStored)", Here());
+    }
+}
+
+} // namespace
+
 FieldRefReduced::FieldRefReduced(const FieldRef &other):
     location_(other.location()) {
+    checkUncompressed(other);
 }
 
 void FieldRefReduced::print(std::ostream &s) const {
     s << location_;
 }
 
-FieldRef::FieldRef() {
+FieldRefFull::FieldRefFull() {
+}
+
+FieldRefFull::FieldRefFull(const FieldRef &other):
+    location_(other.location()),
+    details_(other.details()) {
+    checkUncompressed(other);
+}
+
+void FieldRefFull::print(std::ostream &s) const {
+    s << location_;
+}
+
+FieldRefChecksummed::FieldRefChecksummed():
+    checksum_(0) {
+}
+
+FieldRefChecksummed::FieldRefChecksummed(const FieldRef &other):
+    location_(other.location()),
+    checksum_(other.checksum()) {
+    if (!other.hasChecksum()) {
+        throw eckit::UserError("Field has no checksum but the index type stores checksums (is fdbFieldChecksums disabled?)", Here());
+    }
+    checkUncompressed(other);
+}
+
+void FieldRefChecksummed::print(std::ostream &s) const {
+    s << location_ << ",crc32c=" << std::hex << checksum_ << std::dec;
+}
+
+FieldRefStored::FieldRefStored():
+    storedLength_(0),
+    checksum_(0),
+    hasChecksum_(0),
+    blockSize_(0) {
+}
+
+FieldRefStored::FieldRefStored(const FieldRef &other):
+    location_(other.location()),
+    storedLength_(other.storedLength()),
+    checksum_(other.checksum()),
+    hasChecksum_(other.hasChecksum() ? 1 : 0),
+    blockSize_(other.blockSize()) {
+    if (other.codec().size() > size_t(codecSize)) {
+        throw eckit::UserError("Compression codec name too long to index: " + other.codec(), Here());
+    }
+    codec_ = eckit::FixedString<codecSize>(other.codec());
+}
+
+void FieldRefStored::print(std::ostream &s) const {
+    s << location_ << ",stored=" << storedLength_;
+    if (hasChecksum_) {
+        s << ",crc32c=" << std::hex << checksum_ << std::dec;
+    }
+    std::string c = codec();
+    if (!c.empty()) {
+        s << ",codec=" << c;
+    }
+    if (blockSize_) {
+        s << ",blockSize=" << blockSize_;
+    }
+}
+
+FieldRef::FieldRef():
+    checksum_(0),
+    hasChecksum_(false),
+    storedLength_(0),
+    blockSize_(0) {
 }
 
 FieldRef::FieldRef(UriStore &store, const Field &field):
     location_(store, field),
-    details_(field.details()) {
+    details_(field.details()),
+    checksum_(0),
+    hasChecksum_(false),
+    storedLength_(field.location().length()),
+    blockSize_(0) {
+
+    const TocFieldLocation* tocfloc = dynamic_cast<const TocFieldLocation*>(&field.location());
+    if (tocfloc) {
+        if (tocfloc->hasChecksum()) {
+            checksum_ = tocfloc->checksum();
+            hasChecksum_ = true;
+        }
+        codec_ = tocfloc->codec();
+        storedLength_ = tocfloc->storedLength();
+        blockSize_ = tocfloc->blockSize();
+    }
 }
 
 FieldRef::FieldRef(const FieldRefReduced& other):
-    location_(other.location()) {
+    location_(other.location()),
+    checksum_(0),
+    hasChecksum_(false),
+    storedLength_(other.location().length()),
+    blockSize_(0) {
+}
+
+FieldRef::FieldRef(const FieldRefFull& other):
+    location_(other.location()),
+    details_(other.details()),
+    checksum_(0),
+    hasChecksum_(false),
+    storedLength_(other.location().length()),
+    blockSize_(0) {
+}
+
+FieldRef::FieldRef(const FieldRefChecksummed& other):
+    location_(other.location()),
+    checksum_(other.checksum()),
+    hasChecksum_(true),
+    storedLength_(other.location().length()),
+    blockSize_(0) {
+}
+
+FieldRef::FieldRef(const FieldRefStored& other):
+    location_(other.location()),
+    checksum_(other.checksum()),
+    hasChecksum_(other.hasChecksum()),
+    codec_(other.codec()),
+    storedLength_(other.storedLength()),
+    blockSize_(other.blockSize()) {
 }
 
 void FieldRef::print(std::ostream &s) const {
     s << location_;
+    if (hasChecksum_) {
+        s << ",crc32c=" << std::hex << checksum_ << std::dec;
+    }
+    if (!codec_.empty()) {
+        s << ",codec=" << codec_ << ",stored=" << storedLength_;
+    }
+    if (blockSize_) {
+        s << ",blockSize=" << blockSize_;
+    }
 }
 
 
@@ -15,6 +15,8 @@
 #ifndef fdb5_FieldRef_H
 #define fdb5_FieldRef_H
 
+#include <cstdint>
+
 #include "eckit/eckit.h"
 
 #include "eckit/io/DataHandle.h"
@@ -22,6 +24,7 @@
 #include "eckit/memory/NonCopyable.h"
 #include "eckit/io/Offset.h"
 #include "eckit/filesystem/PathName.h"
+#include "eckit/types/FixedString.h"
 
 #include "fdb5/database/FieldDetails.h"
 
@@ -66,6 +69,7 @@ protected:
 
 class FieldRef;
 
+/// Index payloads. These are stored verbatim in the index files, so their layout must not change.
 
 class FieldRefReduced {
     FieldRefLocation location_;
@@ -84,15 +88,98 @@ private: // methods
     }
 };
 
+class FieldRefFull {
+    FieldRefLocation location_;
+    FieldDetails details_;
+public:
+    FieldRefFull();
+    FieldRefFull(const FieldRef&);
+    const FieldRefLocation& location() const { return location_; }
+    const FieldDetails& details() const { return details_; }
+
+private: // methods
+
+    void print(std::ostream &s) const;
+
+    friend std::ostream &operator<<(std::ostream &s, const FieldRefFull &x) {
+        x.print(s);
+        return s;
+    }
+};
+
+/// Location plus a CRC-32C of the field contents
+
+class FieldRefChecksummed {
+    FieldRefLocation location_;
+    uint32_t checksum_;
+public:
+    FieldRefChecksummed();
+    FieldRefChecksummed(const FieldRef&);
+    const FieldRefLocation& location() const { return location_; }
+    uint32_t checksum() const { return checksum_; }
+
+private: // methods
+
+    void print(std::ostream &s) const;
+
+    friend std::ostream &operator<<(std::ostream &s, const FieldRefChecksummed &x) {
+        x.print(s);
+        return s;
+    }
+};
+
+/// Location plus how the field is stored in the data file: its checksum, the block size of the file layout,
+/// and for compressed fields the codec and stored length. The location length is always the field size.
+
+class FieldRefStored {
+    static constexpr int codecSize = 16;
+    FieldRefLocation location_;
+    uint64_t storedLength_;
+    uint32_t checksum_;
+    uint32_t hasChecksum_;
+    uint32_t blockSize_;
+    eckit::FixedString<codecSize> codec_;
+public:
+    FieldRefStored();
+    FieldRefStored(const FieldRef&);
+    const FieldRefLocation& location() const { return location_; }
+    uint64_t storedLength() const { return storedLength_; }
+    bool hasChecksum() const { return hasChecksum_ != 0; }
+    uint32_t checksum() const { return checksum_; }
+    uint32_t blockSize() const { return blockSize_; }
+    std::string codec() const { return codec_.asString(); }
+
+private: // methods
+
+    void print(std::ostream &s) const;
+
+    friend std::ostream &operator<<(std::ostream &s, const FieldRefStored &x) {
+        x.print(s);
+        return s;
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// In-memory reference to a field, converted to and from whichever payload the index stores
+
 class FieldRef  {
     FieldRefLocation location_;
     FieldDetails details_;
+    uint32_t checksum_;
+    bool hasChecksum_;
+    std::string codec_;
+    eckit::Length storedLength_;
+    size_t blockSize_;
 public:
 
     FieldRef();
     FieldRef(UriStore &, const Field &);
 
     FieldRef(const FieldRefReduced&);
+    FieldRef(const FieldRefFull&);
+    FieldRef(const FieldRefChecksummed&);
+    FieldRef(const FieldRefStored&);
 
     FieldRefLocation::UriID uriId() const { return location_.uriId(); }
     const eckit::Offset &offset() const { return location_.offset(); }
@@ -101,6 +188,16 @@ public:
     const FieldRefLocation& location() const { return location_; }
     const FieldDetails& details() const { return details_; }
 
+    bool hasChecksum() const { return hasChecksum_; }
+    uint32_t checksum() const { return checksum_; }
+
+    /// Compression codec, empty if the field is stored uncompressed
+    const std::string& codec() const { return codec_; }
+    const eckit::Length& storedLength() const { return storedLength_; }
+
+    /// Block size of the data file layout, 0 if not laid out in blocks
+    size_t blockSize() const { return blockSize_; }
+
 private: // methods
 
     void print(std::ostream &s) const;
@@ -111,8 +208,6 @@ private: // methods
     }
 };
 
-typedef FieldRef FieldRefFull;
-
 //----------------------------------------------------------------------------------------------------------------------
 
 } // namespace fdb5
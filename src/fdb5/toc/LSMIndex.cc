@@ -180,15 +180,17 @@ public:
         parallax_key.data       = key_str;
 
         struct par_value value;
+        FieldRefFull payload;
         // Obtaining a char* pointer to the copy
-        value.val_buffer = reinterpret_cast<char*>(&data);
-        value.val_buffer_size = sizeof(FieldRef);
+        value.val_buffer = reinterpret_cast<char*>(&payload);
+        value.val_buffer_size = sizeof(FieldRefFull);
         const char *error = NULL;
         par_get(this->parallax_handle, &parallax_key, &value, &error);
         if (error) {
             LSM_DEBUG("Key not found!");
             return false;
         }
+        data = FieldRef(payload);
         return true;
     }
 
@@ -211,9 +213,9 @@ public:
         KV.k.data       = key_str;
         // KV.v.val_size   = serializer.getSize();
         // KV.v.val_buffer = (char*)serializer.getBuffer();
-        KV.v.val_size = sizeof(FieldRef);
-        // Creating a copy of FieldRef
-        FieldRef dataCopy = data;  // Copy constructor is used here
+        KV.v.val_size = sizeof(FieldRefFull);
+        // Creating the stored payload from the FieldRef
+        FieldRefFull dataCopy(data);
         // Obtaining a char* pointer to the copy
         KV.v.val_buffer = reinterpret_cast<char*>(&dataCopy);
         
@@ -257,14 +259,14 @@ public:
             struct par_key parallax_key     = par_get_key(scanner);
             struct par_value parallax_value = par_get_value(scanner);
             const std::string key           = std::string(parallax_key.data, parallax_key.size);
-            if (parallax_value.val_size != sizeof(FieldRef))
+            if (parallax_value.val_size != sizeof(FieldRefFull))
                 LSM_FATAL("Values of FieldRef is wrong");
 
-            // Cast parallax_value.data to a FieldRef pointer
-            const FieldRef* fieldRefPtr = reinterpret_cast<const FieldRef*>(parallax_value.val_buffer);
+            // Cast parallax_value.data to a FieldRefFull pointer
+            const FieldRefFull* fieldRefPtr = reinterpret_cast<const FieldRefFull*>(parallax_value.val_buffer);
 
-            // Make a copy of the FieldRef object
-            FieldRef fieldRefCopy = *fieldRefPtr;
+            // Make a FieldRef from the stored payload
+            FieldRef fieldRefCopy(*fieldRefPtr);
             visitor.visit(key, fieldRefCopy);
             par_get_next(scanner);
         }
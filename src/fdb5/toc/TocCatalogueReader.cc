@@ -9,11 +9,16 @@
  */
 
 #include <algorithm>
+#include <set>
 
 #include "eckit/log/Log.h"
+#include "eckit/os/Stat.h"
 
 #include "fdb5/LibFdb5.h"
+#include "fdb5/database/CatalogueCache.h"
+#include "fdb5/toc/RootManager.h"
 #include "fdb5/toc/TocCatalogueReader.h"
+#include "fdb5/toc/TocEngine.h"
 #include "fdb5/toc/TocIndex.h"
 #include "fdb5/toc/TocStats.h"
 
@@ -26,6 +31,11 @@ TocCatalogueReader::TocCatalogueReader(const Key& key, const fdb5::Config& confi
     loadIndexesAndRemap();
 }
 
+TocCatalogueReader::TocCatalogueReader(const Key& key, const TocPath& tocPath, const fdb5::Config& config) :
+    TocCatalogue(key, tocPath, config) {
+    loadIndexesAndRemap();
+}
+
 TocCatalogueReader::TocCatalogueReader(const eckit::URI& uri, const fdb5::Config& config) :
     TocCatalogue(uri.path(), ControlIdentifiers{}, config) {
     loadIndexesAndRemap();
@@ -36,14 +46,54 @@ TocCatalogueReader::~TocCatalogueReader() {
 }
 
 void TocCatalogueReader::loadIndexesAndRemap() {
+
+    // Stamp the TOC before reading it, so that records appended meanwhile show up as a change
+    FileStamp tocStamp = FileStamp::of(tocPath());
+
     std::vector<Key> remapKeys;
-    std::vector<Index> indexes = loadIndexes(false, nullptr, nullptr, &remapKeys);
+    std::set<std::string> subTocs;
+    std::vector<Index> indexes = loadIndexes(false, &subTocs, nullptr, &remapKeys);
 
     ASSERT(remapKeys.size() == indexes.size());
     indexes_.reserve(remapKeys.size());
     for (size_t i = 0; i < remapKeys.size(); ++i) {
         indexes_.emplace_back(indexes[i], remapKeys[i]);
     }
+
+    stamps_.emplace_back(tocPath(), tocStamp);
+    for (const std::string& subToc : subTocs) {
+        stamps_.emplace_back(subToc, FileStamp::of(subToc));
+    }
+}
+
+TocCatalogueReader::FileStamp TocCatalogueReader::FileStamp::of(const eckit::PathName& path) {
+    FileStamp stamp{false, 0, 0, 0};
+    eckit::Stat::Struct info;
+    if (eckit::Stat::stat(path.localPath(), &info) == 0) {
+        stamp.exists_ = true;
+        stamp.inode_ = info.st_ino;
+        stamp.size_ = info.st_size;
+        stamp.modified_ = info.st_mtime;
+    }
+    return stamp;
+}
+
+bool TocCatalogueReader::upToDate() const {
+    for (const auto& s : stamps_) {
+        if (!(FileStamp::of(s.first) == s.second)) {
+            return false;
+        }
+    }
+    return !stamps_.empty() && stamps_.front().second.exists_;
+}
+
+size_t TocCatalogueReader::footprint() const {
+    // The decoded TOC and subtoc records, indexes included, grow with the files they were read from
+    size_t result = sizeof(*this);
+    for (const auto& s : stamps_) {
+        result += s.second.size_;
+    }
+    return result;
 }
 
 bool TocCatalogueReader::selectIndex(const Key &key) {
@@ -141,7 +191,39 @@ std::vector<Index> TocCatalogueReader::indexes(bool sorted) const {
     return returnedIndexes;
 }
 
-static CatalogueBuilder<TocCatalogueReader> builder("toc.reader");
+namespace {
+
+/// Reuses the readers kept in the CatalogueCache, and checks whether a database may exist without loading its TOC
+class TocCatalogueReaderBuilder : public CatalogueBuilderBase {
+public:
+    TocCatalogueReaderBuilder() : CatalogueBuilderBase("toc.reader") {}
+
+    std::unique_ptr<Catalogue> make(const Key& key, const fdb5::Config& config) override {
+        TocPath path = CatalogueRootManager(config).directory(key);
+        if (CatalogueCache::instance().enabled()) {
+            // Cached readers are keyed by their uri(), which is built from the real path
+            eckit::URI uri(TocEngine::typeName(), TocCommon::findRealPath(path.directory_));
+            std::unique_ptr<Catalogue> cached = CatalogueCache::instance().take(uri, config);
+            if (cached) {
+                return cached;
+            }
+        }
+        return std::unique_ptr<Catalogue>(new TocCatalogueReader(key, path, config));
+    }
+
+    std::unique_ptr<Catalogue> make(const eckit::URI& uri, const fdb5::Config& config) override {
+        return std::unique_ptr<Catalogue>(new TocCatalogueReader(uri, config));
+    }
+
+    bool mayExist(const Key& key, const fdb5::Config& config) override {
+        TocPath path = CatalogueRootManager(config).directory(key);
+        return (path.directory_ / "toc").exists();
+    }
+};
+
+TocCatalogueReaderBuilder builder;
+
+}
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -16,6 +16,10 @@
 #ifndef fdb5_TocCatalogueReader_H
 #define fdb5_TocCatalogueReader_H
 
+#include <sys/types.h>
+
+#include <ctime>
+
 #include "fdb5/toc/TocCatalogue.h"
 
 namespace fdb5 {
@@ -30,12 +34,33 @@ public: // methods
 
     TocCatalogueReader(const Key& key, const fdb5::Config& config);
     TocCatalogueReader(const eckit::URI& uri, const fdb5::Config& config);
+    TocCatalogueReader(const Key& key, const TocPath& tocPath, const fdb5::Config& config);
 
     ~TocCatalogueReader() override;
 
     std::vector<Index> indexes(bool sorted) const override;
     DbStats stats() const override { return TocHandler::stats(); }
 
+    /// Compares the TOC and the subtocs read with their state when the indexes were loaded
+    bool upToDate() const override;
+    size_t footprint() const override;
+
+private: // types
+
+    struct FileStamp {
+        bool exists_;
+        ino_t inode_;
+        off_t size_;
+        time_t modified_;
+
+        static FileStamp of(const eckit::PathName& path);
+
+        bool operator==(const FileStamp& other) const {
+            return exists_ == other.exists_ && inode_ == other.inode_ && size_ == other.size_ &&
+                   modified_ == other.modified_;
+        }
+    };
+
 private: // methods
 
     void loadIndexesAndRemap();
@@ -63,6 +88,9 @@ private: // members
     // If there is a key remapping for a mounted SubToc, this is stored alongside
     std::vector<std::pair<Index, Key>> indexes_;
 
+    // State of the TOC and subtocs the indexes were loaded from
+    std::vector<std::pair<eckit::PathName, FileStamp>> stamps_;
+
 };
 
 //----------------------------------------------------------------------------------------------------------------------
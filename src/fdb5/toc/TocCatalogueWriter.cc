@@ -8,15 +8,22 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
 #include "fdb5/fdb5_config.h"
 
 #include "eckit/config/Resource.h"
 #include "eckit/log/Log.h"
 #include "eckit/log/Bytes.h"
 #include "eckit/io/EmptyHandle.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/serialisation/Reanimator.h"
 
 #include "fdb5/database/EntryVisitMechanism.h"
 #include "fdb5/io/FDBFileHandle.h"
+#include "fdb5/io/StagingLog.h"
 #include "fdb5/LibFdb5.h"
 #include "fdb5/toc/TocCatalogueWriter.h"
 #include "fdb5/toc/TocFieldLocation.h"
@@ -29,9 +36,39 @@ namespace fdb5 {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+/// The indexes in key order, so that the records written to the toc do not depend on the hashing of the keys
+template <typename IndexStore>
+std::vector<Index*> inKeyOrder(IndexStore& indexes) {
+
+    std::vector<typename IndexStore::value_type*> entries;
+    entries.reserve(indexes.size());
+    for (auto& entry : indexes) {
+        entries.push_back(&entry);
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const typename IndexStore::value_type* a, const typename IndexStore::value_type* b) {
+                  return a->first < b->first;
+              });
+
+    std::vector<Index*> result;
+    result.reserve(entries.size());
+    for (auto* entry : entries) {
+        result.push_back(&entry->second);
+    }
+    return result;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 
 TocCatalogueWriter::TocCatalogueWriter(const Key &key, const fdb5::Config& config) :
     TocCatalogue(key, config),
+    staging_(StagingLog::enabled() && !stripeLustre()),
     umask_(config.umask()) {
     writeInitRecord(key);
     TocCatalogue::loadSchema();
@@ -40,6 +77,7 @@ TocCatalogueWriter::TocCatalogueWriter(const Key &key, const fdb5::Config& confi
 
 TocCatalogueWriter::TocCatalogueWriter(const eckit::URI &uri, const fdb5::Config& config) :
     TocCatalogue(uri.path(), ControlIdentifiers{}, config),
+    staging_(StagingLog::enabled() && !stripeLustre()),
     umask_(config.umask()) {
     writeInitRecord(TocCatalogue::key());
     TocCatalogue::loadSchema();
@@ -62,7 +100,7 @@ bool TocCatalogueWriter::selectIndex(const Key& key) {
             fdb5LustreapiFileCreate(indexPath.localPath(), stripeIndexLustreSettings());
         }
 
-        indexes_[key] = Index(new TocIndex(key, indexPath, 0, TocIndex::WRITE));
+        indexes_[key] = Index(new TocIndex(key, indexPath, 0, TocIndex::WRITE, TocIndex::defaulType(config_)));
     }
 
     current_ = indexes_[key];
@@ -84,7 +122,7 @@ bool TocCatalogueWriter::selectIndex(const Key& key) {
                 fdb5LustreapiFileCreate(indexPath.localPath(), stripeIndexLustreSettings());
             }
 
-            fullIndexes_[key] = Index(new TocIndex(key, indexPath, 0, TocIndex::WRITE));
+            fullIndexes_[key] = Index(new TocIndex(key, indexPath, 0, TocIndex::WRITE, TocIndex::defaulType(config_)));
         }
 
         currentFull_ = fullIndexes_[key];
@@ -121,6 +159,46 @@ void TocCatalogueWriter::close() {
     closeIndexes();
 }
 
+bool TocCatalogueWriter::archived(const Key& key, Field& field) {
+
+    if (currentIndex().get(key, Key(), field)) {
+        return true;
+    }
+
+    if (!archivedLoaded_) {
+        std::vector<Key> remapKeys;
+        std::vector<Index> indexes = loadIndexes(false, nullptr, nullptr, &remapKeys);
+        ASSERT(remapKeys.size() == indexes.size());
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            archived_.emplace_back(indexes[i], remapKeys[i]);
+        }
+        archivedLoaded_ = true;
+    }
+
+    // As TocCatalogueReader::retrieve, the first index holding the key has the latest field
+    for (auto& i : archived_) {
+        Index& idx = i.first;
+        if (idx.key() == currentIndexKey_ && idx.mayContain(key)) {
+            idx.open();
+            if (idx.get(key, i.second, field)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+size_t TocCatalogueWriter::footprint() const {
+    size_t total = 0;
+    for (const auto& i : indexes_) {
+        total += i.second.footprint();
+    }
+    for (const auto& i : fullIndexes_) {
+        total += i.second.footprint();
+    }
+    return total;
+}
+
 void TocCatalogueWriter::index(const Key &key, const eckit::URI &uri, eckit::Offset offset, eckit::Length length) {
     dirty_ = true;
 
@@ -135,6 +213,61 @@ void TocCatalogueWriter::index(const Key &key, const eckit::URI &uri, eckit::Off
 
     if (useSubToc())
         currentFull_.put(key, field);
+
+    if (staging_) {
+        stage(key, field.location());
+    }
+}
+
+void TocCatalogueWriter::stage(const Key& key, const FieldLocation& location) {
+
+    if (stagedEntry_.empty()) {
+        stagedEntry_.resize(64 * 1024);
+    }
+
+    // The location is streamed with the version recorded, which the process replaying the entry may not use
+    static const unsigned int version = RemoteProtocolVersion().latest();
+    RemoteProtocolVersion::Streamed streamed(version);
+
+    eckit::MemoryStream s(stagedEntry_.data(), stagedEntry_.size());
+    s << version;
+    s << currentIndexKey_;
+    s << key;
+    s << location;
+
+    StagingLog::instance().index(directory_, reinterpret_cast<uintptr_t>(this), stagedEntry_.data(),
+                                 static_cast<long long>(s.position()));
+    staged_ = true;
+}
+
+size_t TocCatalogueWriter::reindex(const eckit::PathName& directory, const std::vector<std::string>& entries) {
+
+    TocCatalogueWriter writer(eckit::URI("toc", directory), LibFdb5::instance().defaultConfig());
+
+    // Not staged again, as this runs while the StagingLog is created
+    writer.staging_ = false;
+
+    for (const std::string& entry : entries) {
+        eckit::MemoryStream s(entry.data(), entry.size());
+
+        unsigned int version;
+        s >> version;
+        RemoteProtocolVersion::Streamed streamed(version);
+
+        Key index(s);
+        Key key(s);
+        std::unique_ptr<FieldLocation> location(eckit::Reanimator<FieldLocation>::reanimate(s));
+
+        if (index != writer.currentIndexKey_) {
+            writer.selectIndex(index);
+        }
+        writer.archive(key, std::move(location));
+    }
+
+    LOG_DEBUG_LIB(LibFdb5) << "Indexed " << entries.size() << " staged entries again in " << directory << std::endl;
+
+    // Flushed by the destructor
+    return entries.size();
 }
 
 void TocCatalogueWriter::reconsolidateIndexesAndTocs() {
@@ -317,9 +450,18 @@ void TocCatalogueWriter::flush() {
 
     flushIndexes();
 
+    if (staged_) {
+        StagingLog::instance().indexed(reinterpret_cast<uintptr_t>(this));
+        staged_ = false;
+    }
+
     dirty_ = false;
     current_ = Index();
     currentFull_ = Index();
+
+    // The entries flushed are now only found in the TOC
+    archived_.clear();
+    archivedLoaded_ = false;
 }
 
 eckit::PathName TocCatalogueWriter::generateIndexPath(const Key &key) const {
@@ -335,8 +477,8 @@ eckit::PathName TocCatalogueWriter::generateIndexPath(const Key &key) const {
 // the data that is indexes thorughout the lifetime of the DBWriter, which can be
 // compacted later for read performance.
 void TocCatalogueWriter::flushIndexes() {
-    for (IndexStore::iterator j = indexes_.begin(); j != indexes_.end(); ++j ) {
-        Index& idx = j->second;
+    for (Index* j : inKeyOrder(indexes_)) {
+        Index& idx = *j;
 
         if (idx.dirty()) {
             idx.flush();
@@ -376,8 +518,8 @@ void TocCatalogueWriter::compactSubTocIndexes() {
 
         LOG_DEBUG_LIB(LibFdb5) << "compacting sub tocs" << std::endl;
 
-        for (IndexStore::iterator j = fullIndexes_.begin(); j != fullIndexes_.end(); ++j) {
-            Index& idx = j->second;
+        for (Index* j : inKeyOrder(fullIndexes_)) {
+            Index& idx = *j;
 
             if (idx.dirty()) {
 
@@ -16,6 +16,10 @@
 #ifndef fdb5_TocCatalogueWriter_H
 #define fdb5_TocCatalogueWriter_H
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "eckit/os/AutoUmask.h"
 
 #include "fdb5/database/Index.h"
@@ -58,8 +62,16 @@ public: // methods
     bool enabled(const ControlIdentifier& controlIdentifier) const override;
 
     const Index& currentIndex() override;
+
+    size_t footprint() const override;
+
+    bool archived(const Key& key, Field& field) override;
     const TocSerialisationVersion& serialisationVersion() const;
 
+    /// Indexes again, in the database in the directory, the entries staged by a catalogue that never flushed them.
+    /// Called by the StagingLog replaying the log of a process that died. Returns the number of entries
+    static size_t reindex(const eckit::PathName& directory, const std::vector<std::string>& entries);
+
 protected: // methods
 
     virtual bool selectIndex(const Key &key) override;
@@ -83,10 +95,14 @@ private: // methods
 
     eckit::PathName generateIndexPath(const Key &key) const;
 
+    /// Stages the entry archived to the current index, for the StagingLog to index it again should the process die
+    /// before it is flushed
+    void stage(const Key& key, const FieldLocation& location);
+
 private: // types
 
     typedef std::map< std::string, eckit::DataHandle * >  HandleStore;
-    typedef std::map< Key, Index> IndexStore;
+    typedef std::unordered_map< Key, Index> IndexStore;
     typedef std::map< Key, std::string > PathStore;
 
 private: // members
@@ -104,6 +120,15 @@ private: // members
     Index current_;
     Index currentFull_;
 
+    // Indexes of the TOC, with their remap keys, loaded by the first lookup of archived() since the last flush
+    std::vector<std::pair<Index, Key>> archived_;
+    bool archivedLoaded_ = false;
+
+    // Whether the data archived is staged, and so the entries pointing to it, and whether some are not flushed yet
+    bool staging_;
+    bool staged_ = false;
+    std::vector<char> stagedEntry_;
+
     eckit::AutoUmask umask_;
 };
 
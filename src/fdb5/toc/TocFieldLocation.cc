@@ -12,6 +12,12 @@
 #include "fdb5/LibFdb5.h"
 #include "fdb5/fdb5_config.h"
 
+#include "eckit/config/Resource.h"
+
+#include "fdb5/io/BlockPartFileHandle.h"
+#include "fdb5/io/ChecksumCheckingHandle.h"
+#include "fdb5/io/CompressedPartFileHandle.h"
+
 #if fdb5_HAVE_GRIB
 #include "fdb5/io/SingleGribMungePartFileHandle.h"
 #endif
@@ -26,29 +32,84 @@ namespace fdb5 {
 //TocFieldLocation::TocFieldLocation() {}
 
 TocFieldLocation::TocFieldLocation(const eckit::PathName path, eckit::Offset offset, eckit::Length length, const Key& remapKey) :
-    FieldLocation(eckit::URI("file", path), offset, length, remapKey) {}
+    FieldLocation(eckit::URI("file", path), offset, length, remapKey), checksum_(0), hasChecksum_(false), storedLength_(0), blockSize_(0) {}
 
 TocFieldLocation::TocFieldLocation(const eckit::URI &uri) :
-    FieldLocation(uri) {}
+    FieldLocation(uri), checksum_(0), hasChecksum_(false), storedLength_(0), blockSize_(0) {}
 
 TocFieldLocation::TocFieldLocation(const eckit::URI &uri, eckit::Offset offset, eckit::Length length, const Key& remapKey) :
-    FieldLocation(uri, offset, length, remapKey) {}
+    FieldLocation(uri, offset, length, remapKey), checksum_(0), hasChecksum_(false), storedLength_(0), blockSize_(0) {}
 
 TocFieldLocation::TocFieldLocation(const TocFieldLocation& rhs) :
-    FieldLocation(rhs.uri_, rhs.offset_, rhs.length_, rhs.remapKey_) {}
+    FieldLocation(rhs.uri_, rhs.offset_, rhs.length_, rhs.remapKey_),
+    checksum_(rhs.checksum_),
+    hasChecksum_(rhs.hasChecksum_),
+    codec_(rhs.codec_),
+    storedLength_(rhs.storedLength_),
+    blockSize_(rhs.blockSize_) {}
 
 TocFieldLocation::TocFieldLocation(const UriStore &store, const FieldRef &ref) :
-    FieldLocation(store.get(ref.uriId()), ref.offset(), ref.length(), Key()) {}
+    FieldLocation(store.get(ref.uriId()), ref.offset(), ref.length(), Key()),
+    checksum_(ref.checksum()),
+    hasChecksum_(ref.hasChecksum()),
+    codec_(ref.codec()),
+    storedLength_(ref.storedLength()),
+    blockSize_(ref.blockSize()) {}
 
 TocFieldLocation::TocFieldLocation(eckit::Stream& s) :
-    FieldLocation(s) {}
+    FieldLocation(s), checksum_(0), hasChecksum_(false), storedLength_(0), blockSize_(0) {
+    // Peers of remote protocol version 3 stream the location only
+    if (RemoteProtocolVersion::streamed() < 4) {
+        return;
+    }
+    unsigned int crc;
+    unsigned long blockSize;
+    s >> hasChecksum_;
+    s >> crc;
+    checksum_ = crc;
+    s >> codec_;
+    s >> storedLength_;
+    s >> blockSize;
+    blockSize_ = blockSize;
+}
 
 std::shared_ptr<FieldLocation> TocFieldLocation::make_shared() const {
     return std::make_shared<TocFieldLocation>(std::move(*this));
 }
 
+static bool verifyChecksums() {
+    static bool fdbVerifyChecksums = eckit::Resource<bool>("fdbVerifyChecksums;$FDB_VERIFY_CHECKSUMS", false);
+    return fdbVerifyChecksums;
+}
+
+bool TocFieldLocation::plainFileRange() const {
+    if (!remapKey_.empty() || !codec_.empty() || (hasChecksum_ && verifyChecksums())) {
+        return false;
+    }
+    size_t blockSize = BlockPartFileHandle::readBlockSize(blockSize_);
+    return !(blockSize && length() < eckit::Length(blockSize));
+}
+
 eckit::DataHandle *TocFieldLocation::dataHandle() const {
+
+    if (hasChecksum_ && verifyChecksums() && remapKey_.empty()) {
+        return new ChecksumCheckingHandle(rawDataHandle(), checksum_);
+    }
+    return rawDataHandle();
+}
+
+eckit::DataHandle *TocFieldLocation::rawDataHandle() const {
+    if (!codec_.empty()) {
+        if (!remapKey_.empty()) {
+            NOTIMP;
+        }
+        return new CompressedPartFileHandle(uri_.path(), offset(), storedLength_, length(), codec_);
+    }
     if (remapKey_.empty()) {
+        size_t blockSize = BlockPartFileHandle::readBlockSize(blockSize_);
+        if (blockSize && length() < eckit::Length(blockSize)) {
+            return new BlockPartFileHandle(uri_.path(), offset(), length(), blockSize);
+        }
         return uri_.path().partHandle(offset(), length());
     } else {
 #if fdb5_HAVE_GRIB
@@ -60,7 +121,17 @@ eckit::DataHandle *TocFieldLocation::dataHandle() const {
 }
 
 void TocFieldLocation::print(std::ostream &out) const {
-    out << "TocFieldLocation[uri=" << uri_ << ",offset=" << offset() << ",length=" << length() << ",remapKey=" << remapKey_ << "]";
+    out << "TocFieldLocation[uri=" << uri_ << ",offset=" << offset() << ",length=" << length() << ",remapKey=" << remapKey_;
+    if (hasChecksum_) {
+        out << ",crc32c=" << std::hex << checksum_ << std::dec;
+    }
+    if (!codec_.empty()) {
+        out << ",codec=" << codec_ << ",stored=" << storedLength_;
+    }
+    if (blockSize_) {
+        out << ",blockSize=" << blockSize_;
+    }
+    out << "]";
 }
 
 void TocFieldLocation::visit(FieldLocationVisitor& visitor) const {
@@ -71,6 +142,14 @@ void TocFieldLocation::encode(eckit::Stream& s) const {
     LOG_DEBUG(LibFdb5::instance().debug(), LibFdb5) << "TocFieldLocation encode URI " << uri_.asRawString() << std::endl;
 
     FieldLocation::encode(s);
+    if (RemoteProtocolVersion::streamed() < 4) {
+        return;
+    }
+    s << hasChecksum_;
+    s << static_cast<unsigned int>(checksum_);
+    s << codec_;
+    s << storedLength_;
+    s << static_cast<unsigned long>(blockSize_);
 }
 
 static FieldLocationBuilder<TocFieldLocation> builder("file");
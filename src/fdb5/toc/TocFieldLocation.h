@@ -18,6 +18,8 @@
 #include "eckit/io/Length.h"
 #include "eckit/io/Offset.h"
 
+#include <cstdint>
+
 #include "fdb5/database/FieldLocation.h"
 #include "fdb5/database/UriStore.h"
 #include "fdb5/toc/FieldRef.h"
@@ -39,6 +41,26 @@ public:
 
     eckit::DataHandle* dataHandle() const override;
 
+    bool plainFileRange() const override;
+
+    /// Compression codec of the field, empty if stored uncompressed
+    const std::string& codec() const { return codec_; }
+
+    /// Number of bytes the field occupies in the data file. Differs from length() if compressed
+    eckit::Length storedLength() const { return codec_.empty() ? length_ : storedLength_; }
+    void compressed(const std::string& codec, eckit::Length storedLength) { codec_ = codec; storedLength_ = storedLength; }
+
+    /// Block size of the data file layout the field was archived in, 0 if not laid out in blocks
+    size_t blockSize() const { return blockSize_; }
+    void blockSize(size_t value) { blockSize_ = value; }
+
+    /// CRC-32C of the (uncompressed) field contents, if recorded at archive time
+    bool hasChecksum() const { return hasChecksum_; }
+    uint32_t checksum() const { return checksum_; }
+    void checksum(uint32_t value) { checksum_ = value; hasChecksum_ = true; }
+
+    bool recordedChecksum(uint32_t& crc) const override { crc = checksum_; return hasChecksum_; }
+
     virtual std::shared_ptr<FieldLocation> make_shared() const override;
 
     virtual void visit(FieldLocationVisitor& visitor) const override;
@@ -57,8 +79,21 @@ protected: // For Streamable
 
 private: // methods
 
+    /// Handle on the stored field, without checksum verification
+    eckit::DataHandle* rawDataHandle() const;
+
     void print(std::ostream &out) const override;
 
+private: // members
+
+    uint32_t checksum_;
+    bool hasChecksum_;
+
+    std::string codec_;
+    eckit::Length storedLength_;
+
+    size_t blockSize_;
+
 };
 
 
@@ -16,6 +16,7 @@
 #include "fdb5/toc/BTreeIndex.h"
 #include "fdb5/toc/FieldRef.h"
 #include "fdb5/toc/TocFieldLocation.h"
+#include "fdb5/toc/TocStore.h"
 
 namespace fdb5 {
 
@@ -86,6 +87,17 @@ bool TocIndex::get(const Key &key, const Key &remapKey, Field &field) const {
     if ( found ) {
         const eckit::URI& uri = files_.get(ref.uriId());
         FieldLocation* loc = FieldLocationFactory::instance().build(uri.scheme(), uri, ref.offset(), ref.length(), remapKey);
+        // All that the payload records about how the field is stored is needed to read it back
+        TocFieldLocation* tocloc = dynamic_cast<TocFieldLocation*>(loc);
+        if (tocloc) {
+            if (ref.hasChecksum()) {
+                tocloc->checksum(ref.checksum());
+            }
+            if (!ref.codec().empty()) {
+                tocloc->compressed(ref.codec(), ref.storedLength());
+            }
+            tocloc->blockSize(ref.blockSize());
+        }
         field = Field(std::move(*loc), timestamp_, ref.details());
         delete(loc);
     }
@@ -199,6 +211,13 @@ std::string TocIndex::defaulType() {
     return BTreeIndex::defaulType();
 }
 
+std::string TocIndex::defaulType(const Config& config) {
+    if (!TocStore::dataCompression(config).empty() || TocStore::dataBlockSize(config)) {
+        return "BTreeIndexStored";
+    }
+    return defaulType();
+}
+
 const std::vector<eckit::URI> TocIndex::dataPaths() const {
     return files_.paths();
 }
@@ -243,6 +262,10 @@ void TocIndex::dump(std::ostream &out, const char* indent, bool simple, bool dum
     }
 }
 
+size_t TocIndex::footprint() const {
+    return btree_ ? btree_->pageSize() : 0;
+}
+
 IndexStats TocIndex::statistics() const
 {
     IndexStats s(new TocIndexStats());
@@ -24,6 +24,7 @@
 
 #include "eckit/types/FixedString.h"
 
+#include "fdb5/config/Config.h"
 #include "fdb5/database/Index.h"
 #include "fdb5/database/UriStore.h"
 #include "fdb5/toc/TocIndexLocation.h"
@@ -78,6 +79,10 @@ public: // methods
 
     static std::string defaulType();
 
+    /// Index type for a DB written with the given configuration. Compressed or block laid out data needs
+    /// an index type that records how each field is stored.
+    static std::string defaulType(const Config& config);
+
     eckit::PathName path() const { return location_.uri().path(); }
     off_t offset() const { return location_.offset(); }
 
@@ -108,6 +113,8 @@ private: // methods
 
     IndexStats statistics() const override;
 
+    size_t footprint() const override;
+
 private: // members
 
     std::unique_ptr<BTreeIndex>  btree_;
@@ -14,6 +14,7 @@
 #include "eckit/log/Plural.h"
 
 #include "fdb5/toc/TocHandler.h"
+#include "fdb5/toc/TocStore.h"
 #include "fdb5/LibFdb5.h"
 
 using namespace eckit;
@@ -48,13 +49,30 @@ bool TocPurgeVisitor::visitDatabase(const Catalogue& catalogue, const Store& sto
         dataUsage_[path.path()] += 0;
     }
 
+    const TocCatalogue* tocCatalogue = dynamic_cast<const TocCatalogue*>(&catalogue);
+    ASSERT(tocCatalogue);
+    stripePaths_ = TocStore::stripeDirectories(catalogue.key(), catalogue.config(), tocCatalogue->basePath());
+
     return true;
 }
 
+bool TocPurgeVisitor::ownsDataFile(const eckit::PathName& path) const {
 
-void TocPurgeVisitor::report(std::ostream& out) const {
+    const eckit::PathName dir = path.dirName();
+
+    if (dir.sameAs(dynamic_cast<const TocCatalogue*>(currentCatalogue_)->basePath())) {
+        return true;
+    }
+    for (const eckit::PathName& stripe : stripePaths_) {
+        if (dir.sameAs(stripe)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    const eckit::PathName& directory(((TocCatalogue*) currentCatalogue_)->basePath());
+
+void TocPurgeVisitor::report(std::ostream& out) const {
 
     out << std::endl;
     out << "Index Report:" << std::endl;
@@ -88,7 +106,7 @@ void TocPurgeVisitor::report(std::ostream& out) const {
     out << "Unreferenced owned data files:" << std::endl;
     for (const auto& it : dataUsage_) { // <std::string, size_t>
         if (it.second == 0) {
-            if (eckit::PathName(it.first).dirName().sameAs(directory)) {
+            if (ownsDataFile(it.first)) {
                 out << "    " << it.first << std::endl;
                 cnt++;
             }
@@ -103,7 +121,7 @@ void TocPurgeVisitor::report(std::ostream& out) const {
     out << "Unreferenced adopted data files:" << std::endl;
     for (const auto& it : dataUsage_) { // <std::string, size_t>
         if (it.second == 0) {
-            if (!eckit::PathName(it.first).dirName().sameAs(directory)) {
+            if (!ownsDataFile(it.first)) {
                 out << "    " << it.first << std::endl;
                 cnt2++;
             }
@@ -157,7 +175,7 @@ void TocPurgeVisitor::purge(std::ostream& out, bool porcelain, bool doit) const
     for (const auto& it : dataUsage_) { // <std::string, size_t>
         if (it.second == 0) {
             eckit::PathName path(it.first);
-            if (path.dirName().sameAs(directory)) {
+            if (ownsDataFile(path)) {
                 store_.remove(eckit::URI(store_.type(), path), logAlways, logVerbose, doit);
             }
         }
@@ -36,9 +36,16 @@ public:
     void report(std::ostream& out) const override;
     void purge(std::ostream& out, bool porcelain, bool doit) const override;
 
+private: // methods
+
+    /// Whether the data file is in the DB directory, or in one of its stripe directories on other roots
+    bool ownsDataFile(const eckit::PathName& path) const;
+
 private: // members
 
     const Store& store_;
+
+    std::vector<eckit::PathName> stripePaths_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
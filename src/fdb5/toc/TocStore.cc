@@ -11,19 +11,32 @@
 #include <dirent.h>
 #include <fcntl.h>
 
+#include <functional>
+#include <sstream>
+
 #include "eckit/log/Timer.h"
 
 #include "eckit/config/Resource.h"
 #include "eckit/io/AIOHandle.h"
+#include "eckit/io/AutoCloser.h"
 #include "eckit/io/EmptyHandle.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/types/Types.h"
 
 #include "fdb5/LibFdb5.h"
 #include "fdb5/database/FieldLocation.h"
+#include "fdb5/io/BlockPartFileHandle.h"
+#include "fdb5/io/CompressedPartFileHandle.h"
+#include "fdb5/io/Crc32c.h"
 #include "fdb5/io/FDBFileHandle.h"
 #include "fdb5/io/LustreFileHandle.h"
+#include "fdb5/io/StagedFileHandle.h"
+#include "fdb5/io/StagingLog.h"
 #include "fdb5/rules/Rule.h"
+#include "fdb5/toc/BTreeIndex.h"
 #include "fdb5/toc/RootManager.h"
 #include "fdb5/toc/TocFieldLocation.h"
+#include "fdb5/toc/TocIndex.h"
 #include "fdb5/toc/TocPurgeVisitor.h"
 #include "fdb5/toc/TocStats.h"
 #include "fdb5/toc/TocStore.h"
@@ -34,11 +47,103 @@ namespace fdb5 {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+/// Checksums are only worth computing if the indexes created for the fields store them
+bool fieldChecksums(const Config& config) {
+    static bool fdbFieldChecksums = eckit::Resource<bool>("fdbFieldChecksums;$FDB_FIELD_CHECKSUMS", true);
+    return fdbFieldChecksums && BTreeIndex::storesChecksums(TocIndex::defaulType(config));
+}
+
+/// Memory buffered by each data handle made by TocStore::createDataHandle
+size_t dataHandleBufferSize() {
+
+    static bool fdbWriteToNull = eckit::Resource<bool>("fdbWriteToNull;$FDB_WRITE_TO_NULL", false);
+    if (fdbWriteToNull)
+        return 0;
+
+    // Staged data is held in the staging log, not in memory
+    if (StagingLog::enabled() && !stripeLustre())
+        return 0;
+
+    static bool fdbAsyncWrite = eckit::Resource<bool>("fdbAsyncWrite;$FDB_ASYNC_WRITE", false);
+    if (fdbAsyncWrite) {
+        static size_t nbBuffers  = eckit::Resource<unsigned long>("fdbNbAsyncBuffers", 4);
+        static size_t sizeBuffer = eckit::Resource<unsigned long>("fdbSizeAsyncBuffer", 64 * 1024 * 1024);
+        return nbBuffers * sizeBuffer;
+    }
+
+    static size_t sizeBuffer = eckit::Resource<unsigned long>("fdbBufferSize", 64 * 1024 * 1024);
+    return sizeBuffer;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 TocStore::TocStore(const Schema& schema, const Key& key, const Config& config) :
-    Store(schema), TocCommon(StoreRootManager(config).directory(key).directory_) {}
+    Store(schema),
+    TocCommon(StoreRootManager(config).directory(key).directory_),
+    config_(config),
+    hashStriping_(false),
+    nextDataDirectory_(0),
+    checksums_(fieldChecksums(config)),
+    codec_(dataCompression(config)),
+    compressBuffer_(0),
+    blockSize_(dataBlockSize(config)) {
+
+    dataDirectories_.push_back(directory_);
+
+    if (!codec_.empty()) {
+        compressor_.reset(eckit::CompressorFactory::instance().build(codec_));
+    }
+
+    static std::string fdbDataStriping = eckit::Resource<std::string>("fdbDataStriping;$FDB_DATA_STRIPING", "none");
+    std::string striping = config.getString("dataStriping", fdbDataStriping);
+
+    if (striping == "none") {
+        return;
+    }
+
+    if (striping != "round-robin" && striping != "hash") {
+        std::ostringstream ss;
+        ss << "Unknown data striping mode '" << striping << "', expected one of none, round-robin, hash";
+        throw eckit::UserError(ss.str(), Here());
+    }
+
+    hashStriping_ = (striping == "hash");
+
+    StoreRootManager rootManager(config);
+    std::string dbName = rootManager.dbPathName(key);
+
+    for (const eckit::PathName& root : rootManager.canArchiveRoots(key)) {
+        eckit::PathName dir = root / dbName;
+        // Another DB of the same name may live under that root, and its directory must be left alone
+        if (dir != directory_ && !(dir / "toc").exists()) {
+            dataDirectories_.push_back(dir);
+        }
+    }
+
+    LOG_DEBUG_LIB(LibFdb5) << "TocStore striping (" << striping << ") data files over "
+                           << dataDirectories_ << std::endl;
+}
 
 TocStore::TocStore(const Schema& schema, const eckit::URI& uri, const Config& config) :
-    Store(schema), TocCommon(uri.path().dirName()) {}
+    Store(schema), TocCommon(uri.path().dirName()), config_(config), hashStriping_(false), nextDataDirectory_(0),
+    checksums_(false), compressBuffer_(0),
+    blockSize_(dataBlockSize(config)) {
+    dataDirectories_.push_back(directory_);
+}
+
+std::string TocStore::dataCompression(const Config& config) {
+    static std::string fdbDataCompression = eckit::Resource<std::string>("fdbDataCompression;$FDB_DATA_COMPRESSION", "none");
+    std::string compression = config.getString("dataCompression", fdbDataCompression);
+    return compression == "none" ? std::string() : compression;
+}
+
+size_t TocStore::dataBlockSize(const Config& config) {
+    return config.getLong("dataBlockSize", static_cast<long>(BlockPartFileHandle::blockSize()));
+}
 
 eckit::URI TocStore::uri() const {
     return URI("file", directory_);
@@ -59,16 +164,93 @@ std::unique_ptr<FieldLocation> TocStore::archive(const Key& key, const void* dat
 
     eckit::DataHandle& dh = getDataHandle(dataPath);
 
-    eckit::Offset position = dh.position();
+    std::unique_ptr<TocFieldLocation> location = archiveData(dh, dataPath, data, length);
+
+    if (checksums_) {
+        location->checksum(Crc32c::compute(data, length));
+    }
+
+    return location;
+}
+
+std::vector<std::unique_ptr<FieldLocation>> TocStore::archive(const Key& key, const std::vector<ArchiveItem>& fields) {
+
+    std::vector<std::unique_ptr<FieldLocation>> result;
+    result.reserve(fields.size());
+
+    if (fields.empty()) {
+        return result;
+    }
+
+    dirty_ = true;
+
+    // The data path and handle are looked up once, and the fields appended back to back
+    eckit::PathName dataPath = getDataPath(key);
+
+    eckit::DataHandle& dh = getDataHandle(dataPath);
+
+    for (const ArchiveItem& field : fields) {
+        std::unique_ptr<TocFieldLocation> location = archiveData(dh, dataPath, field.data_, field.length_);
+        if (checksums_) {
+            location->checksum(field.hasChecksum_ ? field.checksum_ : Crc32c::compute(field.data_, field.length_));
+        }
+        result.emplace_back(std::move(location));
+    }
+
+    return result;
+}
+
+std::unique_ptr<TocFieldLocation> TocStore::archiveData(eckit::DataHandle& dh, const eckit::PathName& dataPath,
+                                                        const void* data, eckit::Length length) {
+    if (compressor_) {
+        size_t payloadLength;
+        const void* payload = CompressedPartFileHandle::compress(*compressor_, data, length, compressBuffer_, payloadLength);
+
+        eckit::Offset position = alignToBlock(dh, payloadLength);
+
+        ASSERT(dh.write(payload, payloadLength) == long(payloadLength));
+
+        std::unique_ptr<TocFieldLocation> location(new TocFieldLocation(dataPath, position, length, Key()));
+        location->compressed(codec_, payloadLength);
+        return location;
+    }
+
+    eckit::Offset position = alignToBlock(dh, length);
+
     // gesalous hack
     //long len = length;
     long len = dh.write(data, length);
 
     ASSERT(len == length);
 
-    return std::unique_ptr<TocFieldLocation>(new TocFieldLocation(dataPath, position, length, Key()));
+    std::unique_ptr<TocFieldLocation> location(new TocFieldLocation(dataPath, position, length, Key()));
+    location->blockSize(blockSize_);
+    return location;
 }
 
+eckit::Offset TocStore::alignToBlock(eckit::DataHandle& dh, size_t length) {
+
+    eckit::Offset position = dh.position();
+
+    if (!blockSize_) {
+        return position;
+    }
+
+    // A field that fits in a block must not straddle two, a larger one starts on a block boundary
+
+    size_t inBlock = static_cast<unsigned long long>(static_cast<long long>(position)) % blockSize_;
+    if (inBlock == 0 || (length <= blockSize_ && inBlock + length <= blockSize_)) {
+        return position;
+    }
+
+    size_t pad = blockSize_ - inBlock;
+    if (padding_.size() < pad) {
+        padding_.assign(blockSize_, 0);
+    }
+    ASSERT(dh.write(padding_.data(), pad) == long(pad));
+
+    return position + eckit::Offset(pad);
+}
 
 void TocStore::flush() {
     // gesalous
@@ -90,6 +272,10 @@ void TocStore::close() {
     closeDataHandles();
 }
 
+size_t TocStore::footprint() const {
+    return handles_.size() * dataHandleBufferSize() + compressBuffer_.size();
+}
+
 void TocStore::remove(const eckit::URI& uri, std::ostream& logAlways, std::ostream& logVerbose, bool doit) const {
     ASSERT(uri.scheme() == type());
 
@@ -169,6 +355,12 @@ eckit::DataHandle* TocStore::createDataHandle(const eckit::PathName& path) {
     if (fdbWriteToNull)
         return new eckit::EmptyHandle();
 
+    // Lustre data files are created striped by their handle, so are not staged
+    if (StagingLog::enabled() && !stripeLustre()) {
+        LOG_DEBUG_LIB(LibFdb5) << "Creating StagedFileHandle to " << path << std::endl;
+        return new StagedFileHandle(path);
+    }
+
     static bool fdbAsyncWrite = eckit::Resource<bool>("fdbAsyncWrite;$FDB_ASYNC_WRITE", false);
     if (fdbAsyncWrite)
         return createAsyncHandle(path);
@@ -187,11 +379,93 @@ eckit::DataHandle& TocStore::getDataHandle(const eckit::PathName& path) {
     return *dh;
 }
 
+const eckit::PathName& TocStore::selectDataDirectory(const Key& key) const {
+
+    ASSERT(!dataDirectories_.empty());
+
+    if (dataDirectories_.size() == 1) {
+        return dataDirectories_.front();
+    }
+
+    size_t idx;
+    if (hashStriping_) {
+        idx = std::hash<std::string>()(key.valuesToString()) % dataDirectories_.size();
+    }
+    else {
+        idx = nextDataDirectory_++ % dataDirectories_.size();
+    }
+
+    const eckit::PathName& dir = dataDirectories_[idx];
+
+    // The DB directory itself is created with the TOC. Stripe directories on other roots only hold data files.
+    if (idx != 0) {
+        if (!dir.exists()) {
+            dir.mkdir();
+        }
+        markStripe(dir);
+    }
+
+    return dir;
+}
+
+void TocStore::markStripe(const eckit::PathName& dir) const {
+
+    eckit::PathName marker = stripeMarker(dir);
+    if (marker.exists()) {
+        return;
+    }
+
+    // Written aside and renamed, so that the marker is never seen partially written
+    const std::string& owner = directory_.asString();
+    eckit::PathName tmp = eckit::PathName::unique(marker);
+    {
+        eckit::FileHandle fh(tmp);
+        fh.openForWrite(owner.size());
+        eckit::AutoClose closer(fh);
+        ASSERT(fh.write(owner.data(), owner.size()) == long(owner.size()));
+    }
+    eckit::PathName::rename(tmp, marker);
+}
+
+eckit::PathName TocStore::stripeMarker(const eckit::PathName& dir) {
+    return dir / "stripe";
+}
+
+std::vector<eckit::PathName> TocStore::stripeDirectories(const Key& key, const Config& config,
+                                                         const eckit::PathName& dbDirectory) {
+    std::vector<eckit::PathName> dirs;
+    for (const eckit::PathName& root : StoreRootManager(config).allRoots(key)) {
+        eckit::PathName dir = root / dbDirectory.baseName();
+        if (!dir.exists() || dir.sameAs(dbDirectory) || (dir / "toc").exists()) {
+            continue;
+        }
+
+        eckit::PathName marker = stripeMarker(dir);
+        if (!marker.exists()) {
+            continue;
+        }
+
+        std::string owner(static_cast<long long>(marker.size()), '\0');
+        eckit::FileHandle fh(marker);
+        fh.openForRead();
+        eckit::AutoClose closer(fh);
+        ASSERT(fh.read(&owner[0], owner.size()) == long(owner.size()));
+
+        if (eckit::PathName(owner).sameAs(dbDirectory)) {
+            dirs.push_back(dir);
+        }
+    }
+    return dirs;
+}
+
 eckit::PathName TocStore::generateDataPath(const Key& key) const {
 
-    eckit::PathName dpath(directory_);
+    eckit::PathName dpath(selectDataDirectory(key));
     dpath /= key.valuesToString();
     dpath = eckit::PathName::unique(dpath) + ".data";
+    if (!codec_.empty()) {
+        dpath = dpath + "." + codec_;
+    }
     return dpath;
 }
 
@@ -216,6 +490,21 @@ void TocStore::flushDataHandles() {
 }
 
 bool TocStore::canMoveTo(const Key& key, const Config& config, const eckit::URI& dest) const {
+
+    // Indexes record data files striped to other roots by their full path, which moving the DB would not update
+    eckit::PathName dbDirectory = StoreRootManager(config).directory(key).directory_;
+    for (const eckit::PathName& dir : stripeDirectories(key, config, dbDirectory)) {
+        std::vector<eckit::PathName> files;
+        std::vector<eckit::PathName> dirs;
+        dir.children(files, dirs);
+        // Besides its marker
+        if (files.size() > 1) {
+            std::stringstream ss;
+            ss << "DB with key " << key << " has data files striped to " << dir << ", and cannot be moved";
+            throw eckit::UserError(ss.str(), Here());
+        }
+    }
+
     if (dest.scheme().empty() || dest.scheme() == "toc" || dest.scheme() == "file" || dest.scheme() == "unix") {
         eckit::PathName destPath = dest.path();
         for (const eckit::PathName& root : StoreRootManager(config).canMoveToRoots(key)) {
@@ -271,16 +560,30 @@ void TocStore::remove(const Key& key) const {
 
     eckit::PathName src_db = directory_ / key.valuesToString();
 
-    DIR* dirp = ::opendir(src_db.asString().c_str());
-    struct dirent* dp;
-    while ((dp = ::readdir(dirp)) != NULL) {
-        if (strstr(dp->d_name, ".data")) {
-            eckit::PathName dataFile = src_db / dp->d_name;
-            LOG_DEBUG_LIB(LibFdb5) << "Removing " << dataFile << std::endl;
-            dataFile.unlink(false);
+    std::vector<eckit::PathName> stripes = stripeDirectories(key, config_, src_db);
+
+    std::vector<eckit::PathName> dbDirectories{src_db};
+    dbDirectories.insert(dbDirectories.end(), stripes.begin(), stripes.end());
+
+    for (const eckit::PathName& dir : dbDirectories) {
+        DIR* dirp = ::opendir(dir.asString().c_str());
+        struct dirent* dp;
+        while ((dp = ::readdir(dirp)) != NULL) {
+            if (strstr(dp->d_name, ".data")) {
+                eckit::PathName dataFile = dir / dp->d_name;
+                LOG_DEBUG_LIB(LibFdb5) << "Removing " << dataFile << std::endl;
+                dataFile.unlink(false);
+            }
         }
+        closedir(dirp);
+    }
+
+    // Stripe directories only ever hold data files, and their marker
+    for (const eckit::PathName& dir : stripes) {
+        LOG_DEBUG_LIB(LibFdb5) << "Removing " << dir << std::endl;
+        stripeMarker(dir).unlink(false);
+        dir.rmdir(false);
     }
-    closedir(dirp);
 }
 
 void TocStore::print(std::ostream& out) const {
@@ -16,18 +16,41 @@
 #ifndef fdb5_TocStore_H
 #define fdb5_TocStore_H
 
+#include <memory>
+#include <unordered_map>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/utils/Compressor.h"
+
 #include "fdb5/database/DB.h"
 #include "fdb5/database/Index.h"
 #include "fdb5/database/Store.h"
 #include "fdb5/rules/Schema.h"
 #include "fdb5/toc/TocCommon.h"
 #include "fdb5/toc/TocEngine.h"
+#include "fdb5/toc/TocFieldLocation.h"
 
 namespace fdb5 {
 
 //----------------------------------------------------------------------------------------------------------------------
 
 /// DB that implements the FDB on POSIX filesystems
+///
+/// Data files are normally placed in the DB directory. With the "dataStriping" option (or $FDB_DATA_STRIPING)
+/// set to "round-robin" or "hash", data files of one DB are spread over the DB directory under every root that
+/// can archive the DB, so that a single DB may use the bandwidth of several filesystems. The full path of each
+/// data file is recorded in the index UriStore, so readers need no knowledge of the striping. The directories
+/// created on other roots hold a marker file naming the DB directory they belong to, so that they are never mistaken
+/// for another DB of the same name.
+///
+/// With the "dataCompression" option (or $FDB_DATA_COMPRESSION) naming an eckit compressor, each field is
+/// compressed before being appended to a data file named <name>.data.<codec>. The codec and stored length are
+/// recorded in the field location (and in a BTreeIndexStored index), which decompresses transparently on retrieval.
+///
+/// With the "dataBlockSize" option (or fdbDataBlockSize) set, data files are laid out in aligned blocks: a field
+/// smaller than a block never straddles a block boundary, and larger fields start on one. The block size is
+/// recorded with each field (in a BTreeIndexStored index), and readers fetch small fields a whole block at a
+/// time (see BlockPartFileHandle).
 
 class TocStore : public Store, public TocCommon {
 
@@ -44,12 +67,29 @@ public: // methods
     void flush() override;
     void close() override;
 
+    size_t footprint() const override;
+
     void checkUID() const override { TocCommon::checkUID(); }
 
     bool canMoveTo(const Key& key, const Config& config, const eckit::URI& dest) const override;
     void moveTo(const Key& key, const Config& config, const eckit::URI& dest, eckit::Queue<MoveElement>& queue) const override;
     void remove(const Key& key) const override;
 
+    /// The existing directories of the DB under roots other than its own, which may hold data files striped out
+    /// of the DB directory. They are found whatever the current striping setting, as it may have changed since.
+    /// Only directories marked as stripes of this DB are returned, never a DB of the same name under another root.
+    static std::vector<eckit::PathName> stripeDirectories(const Key& key, const Config& config,
+                                                          const eckit::PathName& dbDirectory);
+
+    /// The marker file of a stripe directory, holding the path of the DB directory it belongs to
+    static eckit::PathName stripeMarker(const eckit::PathName& dir);
+
+    /// Compression codec data is archived with, empty if stored uncompressed
+    static std::string dataCompression(const Config& config);
+
+    /// Block size data files are laid out with, 0 if not laid out in blocks
+    static size_t dataBlockSize(const Config& config);
+
 protected: // methods
 
     std::string type() const override { return "file"; }
@@ -58,6 +98,10 @@ protected: // methods
 
     eckit::DataHandle* retrieve(Field& field) const override;
     std::unique_ptr<FieldLocation> archive(const Key &key, const void *data, eckit::Length length) override;
+    std::vector<std::unique_ptr<FieldLocation>> archive(const Key &key, const std::vector<ArchiveItem>& fields) override;
+    std::unique_ptr<TocFieldLocation> archiveData(eckit::DataHandle& dh, const eckit::PathName& dataPath,
+                                                  const void* data, eckit::Length length);
+    eckit::Offset alignToBlock(eckit::DataHandle& dh, size_t length);
 
     void remove(const eckit::URI& uri, std::ostream& logAlways, std::ostream& logVerbose, bool doit) const override;
 
@@ -69,21 +113,38 @@ protected: // methods
     eckit::DataHandle& getDataHandle( const eckit::PathName &path );
     eckit::PathName generateDataPath(const Key &key) const;
     eckit::PathName getDataPath(const Key &key) const;
+    const eckit::PathName& selectDataDirectory(const Key &key) const;
+    void markStripe(const eckit::PathName& dir) const;
     void flushDataHandles();
 
     void print( std::ostream &out ) const override;
 
 private: // types
 
-    typedef std::map< std::string, eckit::DataHandle * >  HandleStore;
-    typedef std::map< Key, std::string > PathStore;
+    typedef std::unordered_map< std::string, eckit::DataHandle * >  HandleStore;
+    typedef std::unordered_map< Key, std::string > PathStore;
 
 private: // members
 
+    Config config_;
+
     HandleStore handles_;    ///< stores the DataHandles being used by the Session
 
     mutable PathStore   dataPaths_;
 
+    std::vector<eckit::PathName> dataDirectories_; ///< DB directories over which data files are striped
+    bool hashStriping_;
+    mutable size_t nextDataDirectory_;
+
+    bool checksums_;                              ///< compute field checksums, if the indexes store them
+
+    std::string codec_;                           ///< empty if data is stored uncompressed
+    std::unique_ptr<eckit::Compressor> compressor_;
+    eckit::Buffer compressBuffer_;
+
+    size_t blockSize_;                            ///< 0 unless data files are laid out in aligned blocks
+    std::vector<char> padding_;
+
 };
 
 //----------------------------------------------------------------------------------------------------------------------
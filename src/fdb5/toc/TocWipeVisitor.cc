@@ -16,6 +16,7 @@
 #include "fdb5/api/helpers/ControlIterator.h"
 #include "fdb5/database/DB.h"
 #include "fdb5/toc/TocCatalogue.h"
+#include "fdb5/toc/TocStore.h"
 #include "fdb5/toc/TocWipeVisitor.h"
 
 #include <dirent.h>
@@ -118,6 +119,7 @@ bool TocWipeVisitor::visitDatabase(const Catalogue& catalogue, const Store& stor
     ASSERT(dataPaths_.empty());
     ASSERT(safePaths_.empty());
     ASSERT(indexesToMask_.empty());
+    ASSERT(stripePaths_.empty());
 
     ASSERT(!tocPath_.asString().size());
     ASSERT(!schemaPath_.asString().size());
@@ -130,6 +132,8 @@ bool TocWipeVisitor::visitDatabase(const Catalogue& catalogue, const Store& stor
         indexRequest_.unsetValues(kv.first);
     }
 
+    stripePaths_ = TocStore::stripeDirectories(catalogue.key(), catalogue.config(), catalogue_.basePath());
+
     return true; // Explore contained indexes
 }
 
@@ -164,7 +168,7 @@ bool TocWipeVisitor::visitIndex(const Index& index) {
 
     std::vector<eckit::URI> indexDataPaths(index.dataPaths());
     for (const eckit::URI& uri : indexDataPaths) {
-        if (include && uri.path().dirName().sameAs(basePath)) {
+        if (include && isDataDirectory(uri.path().dirName())) {
             dataPaths_.insert(uri.path());
         } else {
             safePaths_.insert(uri.path());
@@ -174,6 +178,19 @@ bool TocWipeVisitor::visitIndex(const Index& index) {
     return true; // Explore contained entries
 }
 
+bool TocWipeVisitor::isDataDirectory(const eckit::PathName& dir) const {
+
+    if (dir.sameAs(catalogue_.basePath())) {
+        return true;
+    }
+    for (const eckit::PathName& stripe : stripePaths_) {
+        if (dir.sameAs(stripe)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void TocWipeVisitor::addMaskedPaths() {
 
     //ASSERT(indexRequest_.empty());
@@ -192,7 +209,7 @@ void TocWipeVisitor::addMaskedPaths() {
         }
     }
     for (const auto& uri : data) {
-        if (uri.path().dirName().sameAs(catalogue_.basePath())) dataPaths_.insert(uri.path());
+        if (isDataDirectory(uri.path().dirName())) dataPaths_.insert(uri.path());
     }
 }
 
@@ -256,9 +273,15 @@ void TocWipeVisitor::calculateResidualPaths() {
     if (tocPath_.asString().size()) deletePaths.insert(tocPath_);
     if (schemaPath_.asString().size())
         deletePaths.insert(schemaPath_);
+    for (const eckit::PathName& stripe : stripePaths_) {
+        deletePaths.insert(TocStore::stripeMarker(stripe));
+    }
 
     std::vector<eckit::PathName> allPathsVector;
     StdDir(catalogue_.basePath()).children(allPathsVector);
+    for (const eckit::PathName& stripe : stripePaths_) {
+        StdDir(stripe).children(allPathsVector);
+    }
     std::set<eckit::PathName> allPaths(allPathsVector.begin(), allPathsVector.end());
 
     ASSERT(residualPaths_.empty());
@@ -329,6 +352,14 @@ void TocWipeVisitor::report() {
     }
     out_ << std::endl;
 
+    if (!stripePaths_.empty()) {
+        out_ << "Data stripe directories:" << std::endl;
+        for (const auto& f : stripePaths_) {
+            out_ << "    " << f << std::endl;
+        }
+        out_ << std::endl;
+    }
+
     out_ << "Protected files (explicitly untouched):" << std::endl;
     if (safePaths_.empty()) out_ << " - NONE - " << std::endl;
     for (const auto& f : safePaths_) {
@@ -397,6 +428,18 @@ void TocWipeVisitor::wipe(bool wipeAll) {
             store_.remove(eckit::URI(store_.type(), path), logAlways, logVerbose, doit_);
     }
 
+    if (wipeAll) {
+        for (const PathName& path : stripePaths_) {
+            PathName marker = TocStore::stripeMarker(path);
+            if (marker.exists()) {
+                store_.remove(eckit::URI(store_.type(), marker), logAlways, logVerbose, doit_);
+            }
+            if (path.exists()) {
+                store_.remove(eckit::URI(store_.type(), path), logAlways, logVerbose, doit_);
+            }
+        }
+    }
+
     for (const std::set<PathName>& pathset : {indexPaths_,
                                               std::set<PathName>{schemaPath_}, subtocPaths_,
                                               std::set<PathName>{tocPath_}, lockfilePaths_,
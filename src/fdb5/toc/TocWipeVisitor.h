@@ -46,6 +46,8 @@ private: // methods
     void ensureSafePaths();
     void calculateResidualPaths();
 
+    bool isDataDirectory(const eckit::PathName& dir) const;
+
     bool anythingToWipe() const;
 
     void report();
@@ -69,6 +71,8 @@ private: // members
     std::set<eckit::PathName> indexPaths_;
     std::set<eckit::PathName> dataPaths_;
 
+    std::vector<eckit::PathName> stripePaths_;  ///< directories of the DB under other roots, holding striped data
+
     std::set<eckit::PathName> safePaths_;
     std::set<eckit::PathName> residualPaths_;
 
@@ -0,0 +1,185 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <memory>
+#include <sstream>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/log/Log.h"
+#include "eckit/option/CmdArgs.h"
+#include "eckit/option/SimpleOption.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/Mutex.h"
+#include "eckit/thread/ThreadPool.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/api/helpers/FDBToolRequest.h"
+#include "fdb5/io/Crc32c.h"
+#include "fdb5/toc/TocFieldLocation.h"
+#include "fdb5/tools/FDBVisitTool.h"
+
+using namespace eckit;
+using namespace eckit::option;
+
+namespace fdb5 {
+namespace tools {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct VerifyCounters {
+    std::atomic<size_t> verified{0};
+    std::atomic<size_t> unchecked{0};
+    std::atomic<size_t> failed{0};
+    eckit::Mutex mutex;
+};
+
+class VerifyField : public eckit::ThreadPoolTask {
+public:
+
+    VerifyField(const ListElement& elem, VerifyCounters& counters, bool verbose) :
+        elem_(elem), counters_(counters), verbose_(verbose) {}
+
+    void execute() override {
+
+        const TocFieldLocation* location = dynamic_cast<const TocFieldLocation*>(&elem_.location());
+        if (!location || !location->hasChecksum()) {
+            counters_.unchecked++;
+            return;
+        }
+
+        Crc32c crc;
+        try {
+            std::unique_ptr<DataHandle> dh(location->dataHandle());
+            dh->openForRead();
+            AutoClose closer(*dh);
+
+            Buffer buffer(1024 * 1024);
+            long len;
+            while ((len = dh->read(buffer, buffer.size())) > 0) {
+                crc.update(buffer, len);
+            }
+        }
+        catch (eckit::Exception& e) {
+            report(e.what());
+            return;
+        }
+
+        if (crc.value() != location->checksum()) {
+            std::ostringstream ss;
+            ss << "checksum mismatch, expected crc32c " << std::hex << location->checksum() << ", found " << crc.value();
+            report(ss.str());
+            return;
+        }
+
+        counters_.verified++;
+
+        if (verbose_) {
+            AutoLock<Mutex> lock(counters_.mutex);
+            Log::info() << "OK: " << elem_.combinedKey() << std::endl;
+        }
+    }
+
+private: // methods
+
+    void report(const std::string& what) {
+        counters_.failed++;
+        AutoLock<Mutex> lock(counters_.mutex);
+        Log::error() << "FAILED: " << elem_.combinedKey() << " " << elem_.location() << ": " << what << std::endl;
+    }
+
+private: // members
+
+    ListElement elem_;
+    VerifyCounters& counters_;
+    bool verbose_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class FDBVerify : public FDBVisitTool {
+
+public: // methods
+
+    FDBVerify(int argc, char **argv) :
+        FDBVisitTool(argc, argv, "class,expver"),
+        threads_(1),
+        verbose_(false) {
+
+        options_.push_back(new SimpleOption<long>("threads", "Number of fields verified concurrently (default: 1)"));
+        options_.push_back(new SimpleOption<bool>("verbose", "Print every field verified"));
+    }
+
+private: // methods
+
+    void execute(const CmdArgs& args) override;
+    void init(const CmdArgs &args) override;
+
+    size_t threads_;
+    bool verbose_;
+};
+
+void FDBVerify::init(const CmdArgs& args) {
+
+    FDBVisitTool::init(args);
+
+    long threads = args.getLong("threads", 1);
+    if (threads < 1) {
+        throw UserError("--threads must be positive", Here());
+    }
+    threads_ = threads;
+    verbose_ = args.getBool("verbose", false);
+}
+
+void FDBVerify::execute(const CmdArgs& args) {
+
+    FDB fdb(config(args));
+
+    VerifyCounters counters;
+
+    for (const FDBToolRequest& request : requests()) {
+
+        Log::info() << "Verifying fields for request" << std::endl;
+        request.print(Log::info());
+        Log::info() << std::endl;
+
+        eckit::ThreadPool pool("verify", threads_);
+
+        auto listObject = fdb.list(request, true);
+
+        ListElement elem;
+        while (listObject.next(elem)) {
+            pool.push(new VerifyField(elem, counters, verbose_));
+        }
+
+        pool.wait();
+    }
+
+    Log::info() << "Fields verified: " << counters.verified
+                << ", without checksum: " << counters.unchecked
+                << ", failed: " << counters.failed << std::endl;
+
+    if (counters.failed) {
+        std::ostringstream ss;
+        ss << counters.failed << " field(s) failed verification";
+        throw eckit::Exception(ss.str(), Here());
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace tools
+} // namespace fdb5
+
+int main(int argc, char **argv) {
+    fdb5::tools::FDBVerify app(argc, argv);
+    return app.start();
+}
@@ -0,0 +1,95 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   LocalFdb.h
+/// @date   Oct 2026
+
+#ifndef fdb_testing_LocalFdb_H
+#define fdb_testing_LocalFdb_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/config/YAMLConfiguration.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/DataHandle.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/config/Config.h"
+#include "fdb5/database/Key.h"
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Helpers shared by the tests that archive to, and retrieve from, a local toc FDB in a temporary directory
+
+/// The key of a field with the default schema, varying only by expver and param
+inline fdb5::Key fieldKey(const std::string& expver, const std::string& param) {
+    fdb5::Key key;
+    key.set("class", "rd");
+    key.set("expver", expver);
+    key.set("stream", "oper");
+    key.set("date", "20191110");
+    key.set("time", "0000");
+    key.set("domain", "g");
+    key.set("type", "an");
+    key.set("levtype", "pl");
+    key.set("step", "0");
+    key.set("levelist", "300");
+    key.set("param", param);
+    return key;
+}
+
+/// A local toc FDB with a single space over the given roots. Any extra YAML lines, each ending with a newline, are
+/// added to the top level of the configuration.
+inline fdb5::Config makeConfig(const std::vector<eckit::PathName>& roots, const std::string& extra = "") {
+    std::string yaml = "---\n"
+                       "type: local\n"
+                       "engine: toc\n" +
+                       extra +
+                       "spaces:\n"
+                       "- roots:\n";
+    for (const eckit::PathName& root : roots) {
+        yaml += "  - path: " + root.asString() + "\n";
+    }
+    return fdb5::Config(eckit::YAMLConfiguration(yaml)).expandConfig();
+}
+
+inline fdb5::Config makeConfig(const eckit::PathName& root, const std::string& extra = "") {
+    return makeConfig(std::vector<eckit::PathName>{root}, extra);
+}
+
+inline std::string readAll(eckit::DataHandle& dh) {
+    dh.openForRead();
+    eckit::AutoClose closer(dh);
+    std::string result;
+    std::vector<char> buffer(1024);
+    long n;
+    while ((n = dh.read(buffer.data(), buffer.size())) > 0) {
+        result.append(buffer.data(), n);
+    }
+    return result;
+}
+
+inline std::string retrieve(fdb5::FDB& fdb, const fdb5::Key& key) {
+    std::unique_ptr<eckit::DataHandle> dh(fdb.retrieve(key.request()));
+    return readAll(*dh);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+#endif
@@ -8,6 +8,7 @@
  * does it submit to any jurisdiction.
  */
 
+#include <memory>
 #include <string.h>
 
 #include "eckit/config/Resource.h"
@@ -62,6 +63,27 @@ void key_compare(const std::vector<fdb5::Key>& keys, fdb_listiterator_t *it, boo
     err = fdb_delete_splitkey(sk);
 }
 
+std::string fileContents(const std::string& path) {
+    eckit::PathName file(path);
+    eckit::Buffer buf(file.size());
+    std::unique_ptr<DataHandle> dh(file.fileHandle());
+    dh->openForRead();
+    dh->read(buf, buf.size());
+    dh->close();
+    return std::string(static_cast<const char*>(buf.data()), buf.size());
+}
+
+/// Reads an open DataReader from its current position to the end
+std::string readAll(fdb_datareader_t* dr) {
+    std::string result;
+    char buf[65536];
+    long read = 0;
+    while (fdb_datareader_read(dr, buf, sizeof(buf), &read) == FDB_SUCCESS && read > 0) {
+        result.append(buf, read);
+    }
+    return result;
+}
+
 CASE( "fdb_c - archive & list" ) {
     size_t length;
     DataHandle *dh;
@@ -217,6 +239,83 @@ CASE( "fdb_c - archive & list" ) {
 
 }
 
+CASE( "fdb_c - archive batch" ) {
+
+    fdb_handle_t* fdb;
+    fdb_new_handle(&fdb);
+
+    const char* levels[] = {"300", "400"};
+    const char* files[] = {"x138-300.grib", "x138-400.grib"};
+
+    fdb_key_t* keys[2];
+    eckit::Buffer bufs[] = {eckit::Buffer(eckit::PathName(files[0]).size()), eckit::Buffer(eckit::PathName(files[1]).size())};
+    const char* data[2];
+    size_t lengths[2];
+
+    for (size_t i = 0; i < 2; ++i) {
+        fdb_new_key(&keys[i]);
+        fdb_key_add(keys[i], "domain", "g");
+        fdb_key_add(keys[i], "stream", "oper");
+        fdb_key_add(keys[i], "levtype", "pl");
+        fdb_key_add(keys[i], "levelist", levels[i]);
+        fdb_key_add(keys[i], "date", "20191110");
+        fdb_key_add(keys[i], "time", "0000");
+        fdb_key_add(keys[i], "step", "0");
+        fdb_key_add(keys[i], "param", "138");
+        fdb_key_add(keys[i], "class", "rd");
+        fdb_key_add(keys[i], "type", "an");
+        fdb_key_add(keys[i], "expver", "xxxz");
+
+        lengths[i] = bufs[i].size();
+        std::unique_ptr<DataHandle> dh(eckit::PathName(files[i]).fileHandle());
+        dh->openForRead();
+        dh->read(bufs[i], lengths[i]);
+        dh->close();
+        data[i] = bufs[i];
+    }
+
+    EXPECT(FDB_SUCCESS == fdb_archive_batch(fdb, keys, data, lengths, 2));
+    EXPECT(FDB_SUCCESS == fdb_flush(fdb));
+
+    fdb_request_t* request;
+    fdb_new_request(&request);
+    fdb_request_add1(request, "domain", "g");
+    fdb_request_add1(request, "stream", "oper");
+    fdb_request_add1(request, "levtype", "pl");
+    fdb_request_add(request, "levelist", levels, 2);
+    fdb_request_add1(request, "date", "20191110");
+    fdb_request_add1(request, "time", "0000");
+    fdb_request_add1(request, "step", "0");
+    fdb_request_add1(request, "param", "138");
+    fdb_request_add1(request, "class", "rd");
+    fdb_request_add1(request, "type", "an");
+    fdb_request_add1(request, "expver", "xxxz");
+
+    fdb_listiterator_t* it;
+    fdb_list(fdb, request, &it, true);
+
+    // Listed in the order of the levels requested, as archived
+
+    size_t count = 0;
+    while (fdb_listiterator_next(it) == FDB_SUCCESS) {
+        const char *uri;
+        size_t off, attr_len;
+        fdb_listiterator_attrs(it, &uri, &off, &attr_len);
+        EXPECT(count < 2);
+        if (count < 2) {
+            EXPECT(attr_len == lengths[count]);
+        }
+        ++count;
+    }
+    EXPECT(count == 2);
+
+    fdb_delete_listiterator(it);
+    fdb_delete_request(request);
+    fdb_delete_key(keys[0]);
+    fdb_delete_key(keys[1]);
+    fdb_delete_handle(fdb);
+}
+
 
 #if fdb5_HAVE_GRIB
 CASE( "fdb_c - multiple archive & list" ) {
@@ -449,6 +548,96 @@ CASE( "fdb_c - retrieve" ) {
 }
 
 
+CASE( "fdb_c - retrieve multiple" ) {
+
+    fdb_handle_t* fdb;
+    fdb_new_handle(&fdb);
+
+    // Requests alternate between the databases xxxx (archived above) and xxxw, archived here from the same files,
+    // so the lookups grouped per database must not change the order in which the fields come out
+
+    const char* archived[] = {"300", "400"};
+    for (const char* level : archived) {
+        std::string data = fileContents(std::string("x138-") + level + ".grib");
+        fdb_key_t* key;
+        fdb_new_key(&key);
+        fdb_key_add(key, "domain", "g");
+        fdb_key_add(key, "stream", "oper");
+        fdb_key_add(key, "levtype", "pl");
+        fdb_key_add(key, "levelist", level);
+        fdb_key_add(key, "date", "20191110");
+        fdb_key_add(key, "time", "0000");
+        fdb_key_add(key, "step", "0");
+        fdb_key_add(key, "param", "138");
+        fdb_key_add(key, "class", "rd");
+        fdb_key_add(key, "type", "an");
+        fdb_key_add(key, "expver", "xxxw");
+        EXPECT(FDB_SUCCESS == fdb_archive(fdb, key, data.data(), data.size()));
+        fdb_delete_key(key);
+    }
+    EXPECT(FDB_SUCCESS == fdb_flush(fdb));
+
+    const size_t nreq = 4;
+    fdb_request_t* requests[nreq];
+    const char* levels[] = {"400", "300", "300", "400"};
+    const char* expvers[] = {"xxxx", "xxxw", "xxxx", "xxxw"};
+    for (size_t i = 0; i < nreq; i++) {
+        fdb_new_request(&requests[i]);
+        fdb_request_add1(requests[i], "domain", "g");
+        fdb_request_add1(requests[i], "stream", "oper");
+        fdb_request_add1(requests[i], "levtype", "pl");
+        fdb_request_add1(requests[i], "levelist", levels[i]);
+        fdb_request_add1(requests[i], "date", "20191110");
+        fdb_request_add1(requests[i], "time", "0000");
+        fdb_request_add1(requests[i], "step", "0");
+        fdb_request_add1(requests[i], "param", "138");
+        fdb_request_add1(requests[i], "class", "rd");
+        fdb_request_add1(requests[i], "type", "an");
+        fdb_request_add1(requests[i], "expver", expvers[i]);
+    }
+
+    std::string expected;
+    for (size_t i = 0; i < nreq; i++) {
+        expected += fileContents(std::string("x138-") + levels[i] + ".grib");
+    }
+
+    char grib[4];
+    long read = 0;
+    long size;
+    fdb_datareader_t* dr;
+    fdb_new_datareader(&dr);
+    EXPECT(fdb_retrieve(fdb, requests[1], dr) == FDB_SUCCESS);
+    fdb_datareader_open(dr, &size);
+    EXPECT_NOT_EQUAL(0, size);
+    EXPECT(readAll(dr) == fileContents("x138-300.grib"));
+    fdb_delete_datareader(dr);
+
+    long size2;
+    fdb_new_datareader(&dr);
+    EXPECT(fdb_retrieve_multiple(fdb, requests, 2, dr) == FDB_SUCCESS);
+    fdb_datareader_open(dr, &size2);
+    EXPECT_EQUAL(long(expected.size() / 2), size2);
+    fdb_datareader_seek(dr, size2 - size);
+    fdb_datareader_read(dr, grib, 4, &read);
+    EXPECT_EQUAL(4, read);
+    EXPECT_EQUAL(0, strncmp(grib, "GRIB", 4));
+    fdb_delete_datareader(dr);
+
+    long size4;
+    fdb_new_datareader(&dr);
+    EXPECT(fdb_retrieve_multiple(fdb, requests, nreq, dr) == FDB_SUCCESS);
+    fdb_datareader_open(dr, &size4);
+    EXPECT_EQUAL(long(expected.size()), size4);
+    EXPECT(readAll(dr) == expected);
+    fdb_delete_datareader(dr);
+
+    for (size_t i = 0; i < nreq; i++) {
+        fdb_delete_request(requests[i]);
+    }
+    fdb_delete_handle(fdb);
+}
+
+
 CASE( "fdb_c - expand" ) {
 
     fdb_handle_t* fdb;
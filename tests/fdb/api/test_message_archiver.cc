@@ -0,0 +1,229 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstring>
+#include <set>
+#include <string>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/message/Message.h"
+#include "eckit/message/Reader.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/message/MessageArchiver.h"
+#include "fdb5/message/MessageDecoder.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The databases written with the first schema select their fields on levelist, which the second one does not know
+
+const char* levelistSchema = "[ class, expver, stream, date, time, domain\n"
+                             "    [ type, levtype\n"
+                             "        [ step, levelist, param ]]]\n";
+
+const char* paramSchema = "[ class, expver, stream, date, time, domain\n"
+                          "    [ type, levtype\n"
+                          "        [ step, param ]]]\n";
+
+fdb5::Key levelKey(const std::string& expver, const std::string& levelist) {
+    fdb5::Key key = fieldKey(expver, "138");
+    key.set("levelist", levelist);
+    return key;
+}
+
+std::string fileContents(const PathName& path) {
+    std::string result(path.size(), '\0');
+    FileHandle fh(path);
+    fh.openForRead();
+    AutoClose closer(fh);
+    EXPECT(fh.read(&result[0], result.size()) == long(result.size()));
+    return result;
+}
+
+void writeFile(const PathName& path, const char* contents) {
+    FileHandle fh(path);
+    fh.openForWrite(0);
+    AutoClose closer(fh);
+    fh.write(contents, ::strlen(contents));
+}
+
+fdb5::Config schemaConfig(const PathName& root, const PathName& schema) {
+    return makeConfig(root, "schema: " + schema.asString() + "\n");
+}
+
+Length archive(fdb5::MessageArchiver& archiver, const std::string& messages) {
+    MemoryHandle source(messages.data(), messages.size());
+    Length length = archiver.archive(source);
+    archiver.flush();
+    return length;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Decoding keywords keeps only those of the message asked for") {
+
+    message::Reader reader(PathName("x138-300.grib"));
+    message::Message msg = reader.next();
+    EXPECT(msg);
+
+    fdb5::Key full = fdb5::MessageDecoder::messageToKey(msg);
+
+    fdb5::MessageDecoder decoder;
+    decoder.keywords({"class", "expver", "levelist", "param", "stepunits", "notakeyword"});
+
+    fdb5::Key key;
+    decoder.messageToKey(msg, key);
+
+    // Missing from the message, or never part of a key
+    EXPECT(key.keys() == std::set<std::string>({"class", "expver", "levelist", "param"}));
+    for (const std::string& keyword : key.keys()) {
+        EXPECT(key.get(keyword) == full.get(keyword));
+    }
+
+    // All of them again
+    decoder.keywords({});
+    key.clear();
+    decoder.messageToKey(msg, key);
+    EXPECT(key == full);
+}
+
+// Only the schema keywords are decoded, as set for this test in CMakeLists.txt
+
+CASE("Messages archived with the schema keywords decoded are stored under their full keys") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    PathName schema = tmp / "schema";
+    writeFile(schema, levelistSchema);
+    fdb5::Config config = schemaConfig(root, schema);
+
+    const std::string x300 = fileContents("x138-300.grib");
+    const std::string x400 = fileContents("x138-400.grib");
+    const std::string y400 = fileContents("y138-400.grib");
+
+    {
+        fdb5::MessageArchiver archiver(fdb5::Key(), false, false, config);
+        archive(archiver, x300 + y400 + x400);
+    }
+
+    fdb5::FDB fdb(config);
+    EXPECT(retrieve(fdb, levelKey("xxxx", "300")) == x300);
+    EXPECT(retrieve(fdb, levelKey("xxxx", "400")) == x400);
+    EXPECT(retrieve(fdb, levelKey("xxxy", "400")) == y400);
+}
+
+CASE("Messages archived to a database written with another schema are decoded with its keywords") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    PathName first = tmp / "schema.levelist";
+    writeFile(first, levelistSchema);
+    PathName second = tmp / "schema.param";
+    writeFile(second, paramSchema);
+
+    const std::string x300 = fileContents("x138-300.grib");
+    const std::string x400 = fileContents("x138-400.grib");
+
+    {
+        fdb5::MessageArchiver archiver(fdb5::Key(), false, false, schemaConfig(root, first));
+        archive(archiver, x300);
+    }
+
+    // The database keeps its schema, which needs levelist, whereas the current one does not decode it
+    {
+        fdb5::MessageArchiver archiver(fdb5::Key(), false, false, schemaConfig(root, second));
+        archive(archiver, x400);
+    }
+
+    fdb5::FDB fdb(schemaConfig(root, first));
+    EXPECT(retrieve(fdb, levelKey("xxxx", "300")) == x300);
+    EXPECT(retrieve(fdb, levelKey("xxxx", "400")) == x400);
+}
+
+// The same cases are run with the messages decoded by 3 threads, as set for this test in CMakeLists.txt
+
+CASE("Every message read is archived, whichever thread decodes it") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    PathName schema = tmp / "schema";
+    writeFile(schema, levelistSchema);
+    fdb5::Config config = schemaConfig(root, schema);
+
+    const std::string x300 = fileContents("x138-300.grib");
+    const std::string x400 = fileContents("x138-400.grib");
+    const std::string y400 = fileContents("y138-400.grib");
+
+    std::string messages;
+    for (size_t i = 0; i < 10; ++i) {
+        messages += x300 + x400 + y400;
+    }
+
+    {
+        fdb5::MessageArchiver archiver(fdb5::Key(), false, false, config);
+        EXPECT(archive(archiver, messages) == Length(messages.size()));
+    }
+
+    fdb5::FDB fdb(config);
+    EXPECT(retrieve(fdb, levelKey("xxxx", "300")) == x300);
+    EXPECT(retrieve(fdb, levelKey("xxxx", "400")) == x400);
+    EXPECT(retrieve(fdb, levelKey("xxxy", "400")) == y400);
+}
+
+CASE("A message failing to decode stops the archival") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    PathName schema = tmp / "schema";
+    writeFile(schema, levelistSchema);
+
+    const std::string x300 = fileContents("x138-300.grib");
+
+    std::string messages;
+    for (size_t i = 0; i < 10; ++i) {
+        messages += x300;
+    }
+
+    // None of the messages match the key the archiver is restricted to
+    fdb5::Key key;
+    key.set("class", "od");
+    fdb5::MessageArchiver archiver(key, false, false, schemaConfig(root, schema));
+
+    EXPECT_THROWS_AS(archive(archiver, messages), eckit::AssertionFailed);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
@@ -0,0 +1,114 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/api/FDB.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const std::vector<std::string> expvers{"xxxa", "xxxb", "xxxc", "xxxd", "xxxe"};
+const std::vector<std::string> params{"130", "131", "132", "133", "138", "155"};
+
+/// Set for one of the two targets of this test in CMakeLists.txt
+bool closingInBackground() {
+    const char* env = ::getenv("FDB_CLOSE_DBS_IN_BACKGROUND");
+    return env && std::string(env) == "1";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// At most 2 databases are open at once, as set for this test in CMakeLists.txt
+
+CASE("Databases evicted and opened again keep every field archived") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    fdb5::Config config = makeConfig(root);
+
+    {
+        fdb5::FDB fdb(config);
+
+        // Round robin over more databases than can be open, so that each is evicted and reopened
+
+        for (const std::string& param : params) {
+            for (const std::string& expver : expvers) {
+                std::string data = expver + "-" + param;
+                fdb.archive(fieldKey(expver, param), data.c_str(), data.size());
+            }
+        }
+        fdb.flush();
+    }
+
+    fdb5::FDB fdb(config);
+    for (const std::string& expver : expvers) {
+        for (const std::string& param : params) {
+            EXPECT(retrieve(fdb, fieldKey(expver, param)) == expver + "-" + param);
+        }
+    }
+}
+
+CASE("An evicted database is flushed") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    fdb5::Config config = makeConfig(root);
+
+    fdb5::FDB writer(config);
+
+    // Opening the two other databases evicts the first one, least recently used
+
+    for (const std::string& expver : {"xxxa", "xxxb", "xxxc"}) {
+        std::string data = "evicted-" + expver;
+        writer.archive(fieldKey(expver, "138"), data.c_str(), data.size());
+    }
+
+    if (!closingInBackground()) {
+        fdb5::FDB reader(config);
+        EXPECT(retrieve(reader, fieldKey("xxxa", "138")) == "evicted-xxxa");
+    }
+
+    // Reopening a database evicted, possibly still closing, sees what was archived before
+
+    std::string data = "reopened";
+    writer.archive(fieldKey("xxxa", "130"), data.c_str(), data.size());
+    writer.flush();
+
+    fdb5::FDB reader(config);
+    EXPECT(retrieve(reader, fieldKey("xxxa", "138")) == "evicted-xxxa");
+    EXPECT(retrieve(reader, fieldKey("xxxa", "130")) == "reopened");
+    EXPECT(retrieve(reader, fieldKey("xxxc", "138")) == "evicted-xxxc");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
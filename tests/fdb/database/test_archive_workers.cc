@@ -0,0 +1,144 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/database/ArchiveItem.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const std::vector<std::string> expvers{"xxxa", "xxxb", "xxxc", "xxxd", "xxxe"};
+const std::vector<std::string> params{"130", "131", "132", "133", "138", "155"};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// 3 workers with queues of 2 fields, as set for this test in CMakeLists.txt
+
+CASE("Fields of several databases archived by the workers are all stored") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    fdb5::Config config = makeConfig(root);
+
+    {
+        fdb5::FDB fdb(config);
+
+        // Interleaved, so that every worker has a queue to fill. The buffers are reused at once.
+
+        std::string data;
+        for (const std::string& param : params) {
+            for (const std::string& expver : expvers) {
+                data = expver + "-" + param;
+                fdb.archive(fieldKey(expver, param), data.c_str(), data.size());
+                data.assign(data.size(), '?');
+            }
+        }
+        fdb.flush();
+    }
+
+    fdb5::FDB fdb(config);
+    for (const std::string& expver : expvers) {
+        for (const std::string& param : params) {
+            EXPECT(retrieve(fdb, fieldKey(expver, param)) == expver + "-" + param);
+        }
+    }
+}
+
+CASE("Fields of a database are archived in order, and visible after flush") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    fdb5::Config config = makeConfig(root);
+
+    fdb5::FDB writer(config);
+
+    for (size_t round = 0; round < 3; ++round) {
+        for (const std::string& expver : expvers) {
+            std::string data = expver + "-" + std::to_string(round);
+            writer.archive(fieldKey(expver, "138"), data.c_str(), data.size());
+        }
+    }
+    writer.flush();
+
+    {
+        fdb5::FDB reader(config);
+        for (const std::string& expver : expvers) {
+            EXPECT(retrieve(reader, fieldKey(expver, "138")) == expver + "-2");
+        }
+    }
+
+    // The workers carry on after a flush
+
+    std::string data = "after";
+    writer.archive(fieldKey("xxxa", "138"), data.c_str(), data.size());
+    writer.flush();
+
+    fdb5::FDB reader(config);
+    EXPECT(retrieve(reader, fieldKey("xxxa", "138")) == "after");
+}
+
+CASE("Batches are archived through the workers") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    fdb5::Config config = makeConfig(root);
+
+    std::vector<fdb5::Key> keys;
+    std::vector<std::string> data;
+    for (const std::string& expver : expvers) {
+        for (const std::string& param : {"130", "138"}) {
+            keys.push_back(fieldKey(expver, param));
+            data.push_back(expver + "+" + param);
+        }
+    }
+
+    std::vector<fdb5::ArchiveItem> items;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        items.emplace_back(keys[i], data[i].c_str(), data[i].size());
+    }
+
+    {
+        fdb5::FDB fdb(config);
+        fdb.archive(items);
+        fdb.flush();
+    }
+
+    fdb5::FDB fdb(config);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT(retrieve(fdb, keys[i]) == data[i]);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
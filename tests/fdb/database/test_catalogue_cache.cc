@@ -0,0 +1,191 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/database/CatalogueCache.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+fdb5::Key dbKey(const std::string& expver) {
+    fdb5::Key key;
+    key.set("class", "rd");
+    key.set("expver", expver);
+    key.set("stream", "oper");
+    key.set("date", "20191110");
+    key.set("time", "0000");
+    key.set("domain", "g");
+    return key;
+}
+
+size_t count(fdb5::FDB& fdb, const fdb5::Key& key) {
+    size_t n = 0;
+    auto it = fdb.inspect(key.request());
+    fdb5::ListElement elem;
+    while (it.next(elem)) {
+        n++;
+    }
+    return n;
+}
+
+void archive(fdb5::FDB& fdb, const std::string& expver) {
+    const std::string data = "field";
+    fdb.archive(fieldKey(expver, "138"), data.c_str(), data.size());
+    fdb.flush();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The cache holds at most 2 readers and 16KiB, as set for this test in CMakeLists.txt
+
+CASE("Readers are reused while the database is unchanged") {
+
+    fdb5::CatalogueCache& cache = fdb5::CatalogueCache::instance();
+    EXPECT(cache.enabled());
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+
+    fdb5::FDB fdb(makeConfig(root));
+    archive(fdb, "xxxx");
+    cache.takeStatistics();
+
+    EXPECT(count(fdb, fieldKey("xxxx", "138")) == 1);
+    EXPECT(cache.size() == 1);
+    EXPECT(cache.bytes() > 0);
+
+    EXPECT(count(fdb, fieldKey("xxxx", "138")) == 1);
+    fdb5::CatalogueCache::Statistics stats = cache.takeStatistics();
+    EXPECT(stats.hits_ == 1);
+    EXPECT(stats.misses_ == 1);
+    EXPECT(stats.stale_ == 0);
+
+    // Statistics are reported once
+    stats = cache.takeStatistics();
+    EXPECT(stats.hits_ == 0);
+    EXPECT(stats.misses_ == 0);
+
+    // Archiving changes the TOC, so the cached reader is not handed out again
+
+    archive(fdb, "xxxx");
+    EXPECT(count(fdb, fieldKey("xxxx", "138")) == 1);
+    stats = cache.takeStatistics();
+    EXPECT(stats.hits_ == 0);
+    EXPECT(stats.stale_ == 1);
+}
+
+CASE("Readers built with another configuration are not shared") {
+
+    fdb5::CatalogueCache& cache = fdb5::CatalogueCache::instance();
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+
+    fdb5::Config config = makeConfig(root);
+    PathName schema = tmp / "schema";
+    {
+        FileHandle in(config.schemaPath());
+        FileHandle out(schema);
+        in.copyTo(out);
+    }
+
+    fdb5::FDB fdb(config);
+    fdb5::FDB other(makeConfig(root, "schema: " + schema.asString() + "\n"));
+
+    archive(fdb, "xxxx");
+    EXPECT(count(fdb, fieldKey("xxxx", "138")) == 1);
+    cache.takeStatistics();
+
+    EXPECT(count(other, fieldKey("xxxx", "138")) == 1);
+    fdb5::CatalogueCache::Statistics stats = cache.takeStatistics();
+    EXPECT(stats.hits_ == 0);
+    EXPECT(stats.misses_ == 1);
+
+    EXPECT(count(fdb, fieldKey("xxxx", "138")) == 1);
+    EXPECT(count(other, fieldKey("xxxx", "138")) == 1);
+    stats = cache.takeStatistics();
+    EXPECT(stats.hits_ == 2);
+}
+
+CASE("The cache is bounded by the number of readers and by their size") {
+
+    fdb5::CatalogueCache& cache = fdb5::CatalogueCache::instance();
+    const size_t maxBytes = 16 * 1024;
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+
+    fdb5::FDB fdb(makeConfig(root));
+    for (const char* expver : {"aaaa", "bbbb", "cccc"}) {
+        archive(fdb, expver);
+        EXPECT(count(fdb, fieldKey(expver, "138")) == 1);
+    }
+    cache.takeStatistics();
+
+    EXPECT(cache.size() == 2);
+    EXPECT(cache.bytes() <= maxBytes);
+
+    // Least recently used first
+
+    EXPECT(count(fdb, fieldKey("aaaa", "138")) == 1);
+    EXPECT(count(fdb, fieldKey("cccc", "138")) == 1);
+    fdb5::CatalogueCache::Statistics stats = cache.takeStatistics();
+    EXPECT(stats.hits_ == 1);
+    EXPECT(stats.evictions_ == 1);
+
+    // A database whose TOC alone is larger than the byte limit is not kept
+
+    for (size_t i = 0; i < 200; ++i) {
+        archive(fdb, "dddd");
+    }
+    std::vector<PathName> files;
+    std::vector<PathName> dirs;
+    root.children(files, dirs);
+    Length tocSize = 0;
+    for (const PathName& dir : dirs) {
+        if (dir.baseName().asString().find("dddd") != std::string::npos) {
+            tocSize = (dir / "toc").size();
+        }
+    }
+    EXPECT(tocSize > Length(maxBytes));
+
+    size_t before = cache.bytes();
+    EXPECT(count(fdb, fieldKey("dddd", "138")) == 1);
+    EXPECT(cache.bytes() == before);
+    EXPECT(cache.bytes() <= maxBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
@@ -0,0 +1,138 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "metkit/mars/MarsRequest.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/api/helpers/FDBToolRequest.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+fdb5::Key datumKey(const std::string& step, const std::string& levelist, const std::string& param) {
+    fdb5::Key key = fieldKey("xxxx", param);
+    key.set("step", step);
+    key.set("levelist", levelist);
+    return key;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("The datum level is expanded with the last keyword varying fastest, in request order") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+
+    fdb5::Config config = makeConfig(root);
+
+    // Every field has a 9-character payload naming its datum
+
+    {
+        fdb5::FDB fdb(config);
+        for (const char* step : {"0", "6"}) {
+            for (const char* levelist : {"300", "500", "850"}) {
+                for (const char* param : {"130", "138"}) {
+                    std::string data = std::string(step) + ":" + levelist + ":" + param;
+                    data.resize(9, '.');
+                    fdb.archive(datumKey(step, levelist, param), data.c_str(), data.size());
+                }
+            }
+        }
+        fdb.flush();
+    }
+
+    // Values that were not archived (step 12, levelist 1000, param 155) expand to nothing.
+    // The schema orders the datum as [ step, levelist?, param ].
+
+    const metkit::mars::MarsRequest request = fdb5::FDBToolRequest::requestsFromString(
+        "class=rd,expver=xxxx,stream=oper,date=20191110,time=0000,domain=g,type=an,levtype=pl,"
+        "step=6/12/0,levelist=850/1000/300,param=155/138/130")[0].request();
+
+    std::vector<std::string> expected;
+    std::string expectedData;
+    for (const char* step : {"6", "0"}) {
+        for (const char* levelist : {"850", "300"}) {
+            for (const char* param : {"138", "130"}) {
+                std::string datum = std::string(step) + ":" + levelist + ":" + param;
+                expected.push_back(datum);
+                datum.resize(9, '.');
+                expectedData += datum;
+            }
+        }
+    }
+
+    fdb5::FDB fdb(config);
+
+    std::vector<std::string> found;
+    auto it = fdb.inspect(request);
+    fdb5::ListElement elem;
+    while (it.next(elem)) {
+        fdb5::Key key = elem.combinedKey();
+        found.push_back(key.get("step") + ":" + key.get("levelist") + ":" + key.get("param"));
+    }
+
+    EXPECT(found == expected);
+
+    std::unique_ptr<DataHandle> dh(fdb.retrieve(request));
+    EXPECT(readAll(*dh) == expectedData);
+}
+
+CASE("A keyword with a single value leaves the others expanding in order") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+
+    fdb5::Config config = makeConfig(root);
+
+    {
+        fdb5::FDB fdb(config);
+        for (const char* param : {"130", "131", "132", "133"}) {
+            std::string data = param;
+            fdb.archive(datumKey("0", "300", param), data.c_str(), data.size());
+        }
+        fdb.flush();
+    }
+
+    const metkit::mars::MarsRequest request = fdb5::FDBToolRequest::requestsFromString(
+        "class=rd,expver=xxxx,stream=oper,date=20191110,time=0000,domain=g,type=an,levtype=pl,"
+        "step=0,levelist=300,param=133/131/130/132")[0].request();
+
+    fdb5::FDB fdb(config);
+    std::unique_ptr<DataHandle> dh(fdb.retrieve(request));
+    EXPECT(readAll(*dh) == "133131130132");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
@@ -0,0 +1,199 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/database/Key.h"
+#include "fdb5/types/TypesRegistry.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<std::string> keywords(const fdb5::Key& key) {
+    std::vector<std::string> result;
+    for (const auto& kv : key) {
+        result.push_back(kv.first);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Entries are kept sorted by keyword, and the order they were set in is remembered") {
+
+    fdb5::Key key;
+    key.set("param", "138");
+    key.set("class", "rd");
+    key.set("levelist", "300");
+    key.set("expver", "xxxx");
+
+    EXPECT(key.size() == 4);
+    EXPECT(keywords(key) == std::vector<std::string>({"class", "expver", "levelist", "param"}));
+    EXPECT(key.names() == eckit::StringList({"param", "class", "levelist", "expver"}));
+
+    EXPECT(key.get("levelist") == "300");
+    EXPECT(key.find("expver") != key.end());
+    EXPECT(key.find("expver")->second == "xxxx");
+    EXPECT(key.find("stream") == key.end());
+    EXPECT(key.find("zzz") == key.end());
+    EXPECT_THROWS_AS(key.get("stream"), eckit::SeriousBug);
+
+    // Setting an existing keyword replaces its value in place
+
+    key.set("levelist", "500");
+    EXPECT(key.size() == 4);
+    EXPECT(key.get("levelist") == "500");
+    EXPECT(key.names().size() == 4);
+
+    key.unset("class");
+    EXPECT(key.size() == 3);
+    EXPECT(key.find("class") == key.end());
+    EXPECT(keywords(key) == std::vector<std::string>({"expver", "levelist", "param"}));
+}
+
+CASE("Push and pop add and remove the last keyword") {
+
+    fdb5::Key key;
+    key.push("type", "an");
+    key.push("levtype", "pl");
+    key.push("step", "0");
+
+    EXPECT(keywords(key) == std::vector<std::string>({"levtype", "step", "type"}));
+    EXPECT(key.names() == eckit::StringList({"type", "levtype", "step"}));
+
+    key.pop("step");
+    EXPECT(key.size() == 2);
+    EXPECT(key.find("step") == key.end());
+    EXPECT(key.names() == eckit::StringList({"type", "levtype"}));
+
+    key.pop("levtype");
+    key.pop("type");
+    EXPECT(key.empty());
+    EXPECT(key.names().empty());
+}
+
+CASE("Keys compare by their entries") {
+
+    fdb5::Key a{{"class", "rd"}, {"expver", "xxxx"}};
+    fdb5::Key b;
+    b.set("expver", "xxxx");
+    b.set("class", "rd");
+
+    EXPECT(a == b);
+    EXPECT(!(a != b));
+    EXPECT(!(a < b) && !(b < a));
+
+    b.set("expver", "xxxy");
+    EXPECT(a != b);
+    EXPECT(a < b);
+
+    EXPECT(a.match(fdb5::Key{{"class", "rd"}}));
+    EXPECT(!a.match(fdb5::Key{{"class", "od"}}));
+    EXPECT(!a.match(fdb5::Key{{"stream", "oper"}}));
+}
+
+CASE("Equal keys hash equal, whatever the order their keywords were set in") {
+
+    fdb5::Key a;
+    a.set("class", "rd");
+    a.set("expver", "xxxx");
+    a.set("stream", "oper");
+
+    fdb5::Key b;
+    b.set("stream", "oper");
+    b.set("class", "rd");
+    b.set("expver", "xxxx");
+
+    EXPECT(a == b);
+    EXPECT(a.names() != b.names());
+    EXPECT(a.hash() == b.hash());
+    EXPECT(std::hash<fdb5::Key>()(a) == std::hash<fdb5::Key>()(b));
+
+    std::unordered_map<fdb5::Key, int> map;
+    map[a] = 1;
+    map[b] = 2;
+    EXPECT(map.size() == 1);
+    EXPECT(map[a] == 2);
+
+    // The memoised hash follows changes, and copies
+
+    size_t before = a.hash();
+    a.set("expver", "xxxy");
+    EXPECT(a.hash() != before);
+    EXPECT(map.find(a) == map.end());
+
+    fdb5::Key c(a);
+    EXPECT(c.hash() == a.hash());
+    c.set("expver", "xxxx");
+    EXPECT(c.hash() != a.hash());
+    EXPECT(map.find(c) != map.end());
+
+    // The same values under other keywords are another key
+
+    fdb5::Key d{{"class", "rd"}, {"expver", "oper"}, {"stream", "xxxx"}};
+    EXPECT(map.find(d) == map.end());
+}
+
+CASE("Keys equal as stored hash equal, whether or not they know the types of their values") {
+
+    std::shared_ptr<fdb5::TypesRegistry> registry = std::make_shared<fdb5::TypesRegistry>();
+    registry->addType("step", "Step");
+
+    // The step would be spelt otherwise once canonicalised
+    fdb5::Key typed{{"class", "rd"}, {"step", "00"}};
+    typed.registry(registry);
+    fdb5::Key untyped{{"class", "rd"}, {"step", "00"}};
+
+    EXPECT(typed == untyped);
+    EXPECT(typed.hash() == untyped.hash());
+
+    std::unordered_map<fdb5::Key, int> map;
+    map[typed] = 1;
+    EXPECT(map.find(untyped) != map.end());
+}
+
+CASE("A key survives encoding, with its keywords in order") {
+
+    fdb5::Key key{{"class", "rd"}, {"expver", "xxxx"}, {"stream", "oper"}};
+
+    char buffer[1024];
+    MemoryStream out(buffer, sizeof(buffer));
+    out << key;
+
+    MemoryStream in(buffer, sizeof(buffer));
+    fdb5::Key decoded(in);
+
+    EXPECT(decoded == key);
+    EXPECT(decoded.names() == key.names());
+    EXPECT(decoded.valuesToString() == "rd:xxxx:oper");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
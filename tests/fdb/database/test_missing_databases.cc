@@ -0,0 +1,108 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/database/MissingDatabases.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+fdb5::Key dbKey(const std::string& expver) {
+    fdb5::Key key;
+    key.set("class", "rd");
+    key.set("expver", expver);
+    key.set("stream", "oper");
+    key.set("date", "20191110");
+    key.set("time", "0000");
+    key.set("domain", "g");
+    return key;
+}
+
+size_t count(fdb5::FDB& fdb, const fdb5::Key& key) {
+    size_t n = 0;
+    auto it = fdb.inspect(key.request());
+    fdb5::ListElement elem;
+    while (it.next(elem)) {
+        n++;
+    }
+    return n;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The TTL (1 hour) and capacity (3) are set for this test in CMakeLists.txt
+
+CASE("Missing databases are remembered within the TTL, up to the capacity") {
+
+    fdb5::MissingDatabases missing;
+
+    missing.insert(dbKey("aaaa"));
+    missing.insert(dbKey("bbbb"));
+
+    EXPECT(missing.contains(dbKey("aaaa")));
+    EXPECT(missing.contains(dbKey("bbbb")));
+    EXPECT(!missing.contains(dbKey("cccc")));
+
+    missing.expire();
+    EXPECT(missing.contains(dbKey("aaaa")));
+
+    // Full: starts afresh rather than growing
+
+    missing.insert(dbKey("cccc"));
+    missing.insert(dbKey("dddd"));
+    EXPECT(!missing.contains(dbKey("aaaa")));
+    EXPECT(missing.contains(dbKey("dddd")));
+
+    missing.clear();
+    EXPECT(!missing.contains(dbKey("dddd")));
+}
+
+CASE("A database archived after it was found missing is then retrieved") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+
+    fdb5::Config config = makeConfig(root);
+
+    fdb5::FDB fdb(config);
+
+    EXPECT(count(fdb, fieldKey("xxxx", "138")) == 0);
+    EXPECT(count(fdb, fieldKey("xxxx", "138")) == 0);
+
+    const std::string data = "field";
+    fdb.archive(fieldKey("xxxx", "138"), data.c_str(), data.size());
+    fdb.flush();
+
+    EXPECT(count(fdb, fieldKey("xxxx", "138")) == 1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
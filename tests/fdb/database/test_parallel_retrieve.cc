@@ -0,0 +1,100 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/testing/Test.h"
+
+#include "metkit/mars/MarsRequest.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/api/helpers/FDBToolRequest.h"
+#include "fdb5/database/LookupPool.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Lookups of several databases run on the pool, and fields come out in request order") {
+
+    // Set for this test in CMakeLists.txt
+    EXPECT(fdb5::LookupPool::size() == 3);
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+
+    fdb5::Config config = makeConfig(root);
+
+    const std::vector<std::string> expvers{"xxxx", "yyyy", "zzzz", "wwww"};
+
+    {
+        fdb5::FDB fdb(config);
+        for (const std::string& expver : expvers) {
+            for (const char* param : {"130", "138", "155"}) {
+                std::string data = expver + param;
+                fdb.archive(fieldKey(expver, param), data.c_str(), data.size());
+            }
+        }
+        fdb.flush();
+    }
+
+    // One DB is missing, and is skipped
+
+    const metkit::mars::MarsRequest request = fdb5::FDBToolRequest::requestsFromString(
+        "class=rd,expver=zzzz/xxxx/vvvv/wwww/yyyy,stream=oper,date=20191110,time=0000,domain=g,"
+        "type=an,levtype=pl,step=0,levelist=300,param=155/130")[0].request();
+
+    // The order in which the request is expanded, missing DB aside
+
+    std::vector<std::string> expected;
+    for (const std::string& expver : request.values("expver")) {
+        if (expver == "vvvv") {
+            continue;
+        }
+        for (size_t i = 0; i < request.values("param").size(); ++i) {
+            expected.push_back(expver);
+        }
+    }
+
+    for (int i = 0; i < 3; ++i) {
+
+        fdb5::FDB fdb(config);
+
+        std::vector<std::string> found;
+        auto it = fdb.inspect(request);
+        fdb5::ListElement elem;
+        while (it.next(elem)) {
+            fdb5::Key key = elem.combinedKey();
+            found.push_back(key.get("expver"));
+        }
+
+        EXPECT(found == expected);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
@@ -0,0 +1,157 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+#include "eckit/utils/Tokenizer.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/api/helpers/FDBToolRequest.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Fields of class od go through the first rule, unless their stream is not one it accepts. Fields of
+// other classes go through the second rule, to its first index rule if on pressure levels.
+
+const char* schema = "step: Step;\n"
+                     "levelist: Double;\n"
+                     "date: Date;\n"
+                     "time: Time;\n"
+                     "expver: Expver;\n"
+                     "\n"
+                     "[ class=od, expver, stream=oper/enfo, date, time\n"
+                     "    [ type, levtype\n"
+                     "        [ step, levelist?, param ]]]\n"
+                     "\n"
+                     "[ class, expver, stream, date, time, domain?\n"
+                     "    [ type=an/fc, levtype=pl\n"
+                     "        [ step, levelist, param ]]\n"
+                     "    [ type, levtype\n"
+                     "        [ param, step ]]]\n";
+
+/// A key from "keyword=value,..."
+fdb5::Key makeKey(const std::string& s) {
+    fdb5::Key key;
+    std::vector<std::string> pairs;
+    Tokenizer(",")(s, pairs);
+    for (const std::string& p : pairs) {
+        std::vector<std::string> kv;
+        Tokenizer("=")(p, kv);
+        ASSERT(kv.size() == 2);
+        key.set(kv[0], kv[1]);
+    }
+    return key;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// At most 2 routes are kept per schema, as set for this test in CMakeLists.txt, so that they are also dropped
+// and learnt again
+
+CASE("Fields archived through the remembered routes are stored as by the full expansion") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+
+    PathName schemaPath = tmp / "schema";
+    {
+        FileHandle fh(schemaPath);
+        fh.openForWrite(0);
+        AutoClose closer(fh);
+        fh.write(schema, ::strlen(schema));
+    }
+
+    fdb5::Config config = makeConfig(root, "schema: " + schemaPath.asString() + "\n");
+
+    const std::string common = "expver=xxxx,date=20191110,time=0000,";
+
+    // Fields with the same keywords (0 and 4, 2 and 3) differ in values some predicate depends on
+
+    const std::vector<fdb5::Key> fields{
+        makeKey(common + "class=od,stream=oper,type=an,levtype=pl,step=0,levelist=300,param=138"),
+        makeKey(common + "class=rd,stream=oper,domain=g,type=an,levtype=pl,step=0,levelist=300,param=138"),
+        makeKey(common + "class=rd,stream=oper,domain=g,type=an,levtype=sfc,step=0,param=167"),
+        makeKey(common + "class=rd,stream=oper,domain=g,type=cf,levtype=sfc,step=0,param=167"),
+        makeKey(common + "class=od,stream=scda,type=an,levtype=pl,step=0,levelist=300,param=138"),
+        makeKey(common + "class=rd,stream=enfo,type=fc,levtype=pl,step=6,levelist=500,param=130"),
+    };
+
+    auto data = [](size_t field, size_t round) { return "field" + std::to_string(field) + "-" + std::to_string(round); };
+
+    // The second round goes through the routes learnt in the first one
+
+    for (size_t round = 0; round < 2; ++round) {
+        fdb5::FDB fdb(config);
+        for (size_t i = 0; i < fields.size(); ++i) {
+            std::string d = data(i, round);
+            fdb.archive(fields[i], d.c_str(), d.size());
+        }
+        fdb.flush();
+    }
+
+    fdb5::FDB fdb(config);
+
+    std::map<fdb5::Key, std::vector<fdb5::ListElement>> listed;
+    auto it = fdb.list(fdb5::FDBToolRequest::requestsFromString("class=od/rd,expver=xxxx")[0], false);
+    fdb5::ListElement elem;
+    while (it.next(elem)) {
+        listed[elem.combinedKey()].push_back(elem);
+    }
+
+    EXPECT(listed.size() == fields.size());
+
+    for (const auto& l : listed) {
+        const std::vector<fdb5::ListElement>& elements = l.second;
+        EXPECT(elements.size() == 2);
+        if (elements.size() != 2) {
+            continue;
+        }
+        EXPECT(elements[0].key() == elements[1].key());
+        EXPECT(elements[0].location().uri().path().dirName() == elements[1].location().uri().path().dirName());
+    }
+
+    // The od field of a stream the first rule does not accept is stored as the rd fields are
+
+    std::vector<PathName> files;
+    std::vector<PathName> dirs;
+    root.children(files, dirs);
+    EXPECT(dirs.size() == 4);
+
+    for (size_t i = 0; i < fields.size(); ++i) {
+        EXPECT(retrieve(fdb, fields[i]) == data(i, 1));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
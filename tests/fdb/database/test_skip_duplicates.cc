@@ -0,0 +1,180 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/io/Crc32c.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t duplicates(const fdb5::FDB& fdb) {
+    return fdb.internalStats().numDuplicatesSkipped();
+}
+
+/// Duplicates are only looked for if the index records the checksums of the fields, which the default index type
+/// does unless they are turned off. This test runs with and without them, as set in CMakeLists.txt
+bool checksums() {
+    static bool fdbFieldChecksums = eckit::Resource<bool>("fdbFieldChecksums;$FDB_FIELD_CHECKSUMS", true);
+    return fdbFieldChecksums;
+}
+
+/// Other data of the same length and CRC-32C. The CRC of data of a given length is affine in its bits, so flipping
+/// some combination of the first 64 bits leaves it unchanged.
+std::string collision(const std::string& data) {
+
+    ASSERT(data.size() >= 8);
+    const uint32_t crc = fdb5::Crc32c::compute(data.data(), data.size());
+
+    // By highest bit set, the change to the CRC made by flipping a set of bits
+    std::vector<std::pair<uint32_t, uint64_t>> basis(32, {0, 0});
+
+    for (size_t bit = 0; bit < 64; ++bit) {
+
+        std::string flipped = data;
+        flipped[bit / 8] ^= char(1 << (bit % 8));
+        uint32_t change = fdb5::Crc32c::compute(flipped.data(), flipped.size()) ^ crc;
+        uint64_t bits = uint64_t(1) << bit;
+
+        for (int p = 31; p >= 0 && change; --p) {
+            if (!(change >> p & 1)) {
+                continue;
+            }
+            if (!basis[p].first) {
+                basis[p] = {change, bits};
+                break;
+            }
+            change ^= basis[p].first;
+            bits ^= basis[p].second;
+        }
+
+        if (!change) {
+            std::string result = data;
+            for (size_t b = 0; b < 64; ++b) {
+                if (bits >> b & 1) {
+                    result[b / 8] ^= char(1 << (b % 8));
+                }
+            }
+            return result;
+        }
+    }
+
+    NOTIMP;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("A field archived again with the same data is skipped, if its checksum is recorded") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    fdb5::Config config = makeConfig(root);
+
+    const std::string data = "field data";
+
+    {
+        fdb5::FDB fdb(config);
+        fdb.archive(fieldKey("xxxx", "138"), data.c_str(), data.size());
+        fdb.flush();
+    }
+
+    // From another session, so that the field is found in the indexes written
+    {
+        fdb5::FDB fdb(config);
+        fdb.archive(fieldKey("xxxx", "138"), data.c_str(), data.size());
+        fdb.flush();
+        EXPECT(duplicates(fdb) == (checksums() ? 1 : 0));
+
+        // And in the index being written
+        fdb.archive(fieldKey("xxxx", "138"), data.c_str(), data.size());
+        fdb.flush();
+        EXPECT(duplicates(fdb) == (checksums() ? 2 : 0));
+    }
+
+    fdb5::FDB fdb(config);
+    EXPECT(retrieve(fdb, fieldKey("xxxx", "138")) == data);
+}
+
+CASE("A field archived again with other data is stored") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    fdb5::Config config = makeConfig(root);
+
+    const std::vector<std::string> data{"field data", "field date", "field data, longer"};
+
+    fdb5::FDB writer(config);
+
+    for (const std::string& d : data) {
+        writer.archive(fieldKey("xxxx", "138"), d.c_str(), d.size());
+        writer.flush();
+
+        fdb5::FDB reader(config);
+        EXPECT(retrieve(reader, fieldKey("xxxx", "138")) == d);
+    }
+
+    EXPECT(duplicates(writer) == 0);
+}
+
+CASE("A field archived again with other data of the same checksum is stored") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+    fdb5::Config config = makeConfig(root);
+
+    const std::string data = "field data, of a checksum found again";
+    const std::string other = collision(data);
+    EXPECT(other != data);
+    EXPECT(fdb5::Crc32c::compute(other.data(), other.size()) == fdb5::Crc32c::compute(data.data(), data.size()));
+
+    {
+        fdb5::FDB fdb(config);
+        fdb.archive(fieldKey("xxxx", "138"), data.c_str(), data.size());
+        fdb.flush();
+    }
+
+    fdb5::FDB writer(config);
+    writer.archive(fieldKey("xxxx", "138"), other.c_str(), other.size());
+    writer.flush();
+    EXPECT(duplicates(writer) == 0);
+
+    fdb5::FDB reader(config);
+    EXPECT(retrieve(reader, fieldKey("xxxx", "138")) == other);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
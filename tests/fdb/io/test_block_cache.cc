@@ -0,0 +1,148 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/io/BlockCache.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The cache is configured for this test in CMakeLists.txt: 16 blocks of 4 KiB
+
+const size_t blockSize = 4096;
+
+struct DataFile {
+
+    DataFile(const PathName& path, size_t size) : path_(path) {
+        for (size_t i = 0; i < size; ++i) {
+            contents_ += char(i % 251);
+        }
+        FileHandle fh(path);
+        fh.openForWrite(0);
+        AutoClose closer(fh);
+        fh.write(contents_.data(), contents_.size());
+
+        fd_ = ::open(path.localPath(), O_RDONLY);
+        ASSERT(fd_ >= 0);
+    }
+
+    ~DataFile() { ::close(fd_); }
+
+    std::shared_ptr<const fdb5::BlockCache::Block> get(size_t block) {
+        return fdb5::BlockCache::instance().get(path_, fd_, block * blockSize, blockSize, 1);
+    }
+
+    PathName path_;
+    std::string contents_;
+    int fd_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Blocks are cached from the second read, and statistics are reported once") {
+
+    fdb5::BlockCache& cache = fdb5::BlockCache::instance();
+    EXPECT(cache.enabled());
+    EXPECT(cache.blockSize() == blockSize);
+
+    TmpDir tmp;
+    DataFile file(tmp / "admission.data", 10 * blockSize + 100);
+
+    cache.takeStatistics();
+
+    auto b1 = file.get(3);
+    EXPECT(b1->length_ == blockSize);
+    EXPECT(std::string(b1->data_.data(), b1->length_) == file.contents_.substr(3 * blockSize, blockSize));
+
+    // First read: not admitted
+    auto b2 = file.get(3);
+    EXPECT(b2 != b1);
+
+    // Second read admitted it
+    auto b3 = file.get(3);
+    EXPECT(b3 == b2);
+
+    // Last, short block
+    auto last = file.get(10);
+    EXPECT(last->length_ == 100);
+
+    fdb5::BlockCache::Statistics s = cache.takeStatistics();
+    EXPECT(s.hits_ == 1);
+    EXPECT(s.misses_ == 3);
+    EXPECT(s.bytesRead_ == 2 * blockSize + 100);
+
+    s = cache.takeStatistics();
+    EXPECT(s.hits_ == 0);
+    EXPECT(s.misses_ == 0);
+    EXPECT(s.bytesRead_ == 0);
+}
+
+CASE("A single scan does not evict the blocks being reused") {
+
+    fdb5::BlockCache& cache = fdb5::BlockCache::instance();
+
+    TmpDir tmp;
+    DataFile hot(tmp / "hot.data", 4 * blockSize);
+    DataFile scan(tmp / "scan.data", 64 * blockSize);
+
+    for (size_t b = 0; b < 4; ++b) {
+        hot.get(b);
+        hot.get(b);
+    }
+
+    cache.takeStatistics();
+
+    for (size_t b = 0; b < 64; ++b) {
+        scan.get(b);
+    }
+
+    for (size_t b = 0; b < 4; ++b) {
+        hot.get(b);
+    }
+
+    fdb5::BlockCache::Statistics s = cache.takeStatistics();
+    EXPECT(s.hits_ == 4);
+    EXPECT(s.misses_ == 64);
+    EXPECT(s.evictions_ == 0);
+
+    // Blocks read again while still remembered are admitted, and displace the least recently used ones
+
+    for (size_t b = 48; b < 64; ++b) {
+        scan.get(b);
+    }
+
+    s = cache.takeStatistics();
+    EXPECT(s.evictions_ > 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
@@ -0,0 +1,121 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/io/CoalescedPartFileHandle.h"
+#include "fdb5/io/HandleGatherer.h"
+#include "fdb5/toc/TocFieldLocation.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string makeFile(const PathName& path, size_t size) {
+    std::string contents;
+    for (size_t i = 0; i < size; ++i) {
+        contents += char('a' + i % 26);
+    }
+    FileHandle fh(path);
+    fh.openForWrite(0);
+    AutoClose closer(fh);
+    fh.write(contents.data(), contents.size());
+    return contents;
+}
+
+std::string readAll(DataHandle& dh) {
+    Length len = dh.openForRead();
+    AutoClose closer(dh);
+    std::string result(len, '\0');
+    long n = 0;
+    long total = 0;
+    while (total < long(len) && (n = dh.read(&result[total], long(len) - total)) > 0) {
+        total += n;
+    }
+    EXPECT(total == long(len));
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Coalesced handle returns the ranges and skips the gaps") {
+
+    TmpDir tmp;
+    PathName path = tmp / "coalesced.data";
+    std::string contents = makeFile(path, 4000);
+
+    fdb5::CoalescedPartFileHandle dh(path, {Offset(10), Offset(500), Offset(3000)}, {Length(90), Length(1000), Length(5)});
+
+    EXPECT(!dh.moveable());
+    EXPECT(dh.estimate() == Length(1095));
+    EXPECT(readAll(dh) == contents.substr(10, 90) + contents.substr(500, 1000) + contents.substr(3000, 5));
+}
+
+CASE("Sorted gathering coalesces close fields of a file, whatever the order they are added in") {
+
+    // Before the first HandleGatherer reads fdbReadCoalesceGap
+    SetEnv gap("FDB_READ_COALESCE_GAP", "1000");
+
+    TmpDir tmp;
+    PathName path = tmp / "sorted.data";
+    std::string contents = makeFile(path, 4000);
+
+    fdb5::HandleGatherer gatherer(true);
+    gatherer.add(fdb5::TocFieldLocation(path, 2000, 100, fdb5::Key()));
+    gatherer.add(fdb5::TocFieldLocation(path, 1000, 100, fdb5::Key()));
+    gatherer.add(fdb5::TocFieldLocation(path, 0, 100, fdb5::Key()));
+
+    EXPECT(gatherer.count() == 3);
+
+    std::unique_ptr<DataHandle> dh(gatherer.dataHandle());
+    EXPECT(readAll(*dh) == contents.substr(0, 100) + contents.substr(1000, 100) + contents.substr(2000, 100));
+
+    // Fields are delivered in file order, last added first
+    EXPECT(gatherer.order() == std::vector<size_t>({2, 1, 0}));
+}
+
+CASE("Unsorted gathering keeps the request order") {
+
+    TmpDir tmp;
+    PathName path = tmp / "unsorted.data";
+    std::string contents = makeFile(path, 4000);
+
+    fdb5::HandleGatherer gatherer(false);
+    gatherer.add(fdb5::TocFieldLocation(path, 0, 100, fdb5::Key()));
+    gatherer.add(fdb5::TocFieldLocation(path, 2000, 100, fdb5::Key()));
+    gatherer.add(fdb5::TocFieldLocation(path, 1000, 100, fdb5::Key()));
+    gatherer.add(fdb5::TocFieldLocation(path, 1100, 50, fdb5::Key()));
+
+    std::unique_ptr<DataHandle> dh(gatherer.dataHandle());
+    EXPECT(readAll(*dh) == contents.substr(0, 100) + contents.substr(2000, 100) + contents.substr(1000, 150));
+    EXPECT(gatherer.order() == std::vector<size_t>({0, 1, 2, 3}));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
@@ -0,0 +1,96 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/io/PrefetchingMultiHandle.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string readAll(DataHandle& dh, long chunk) {
+    std::string result;
+    dh.openForRead();
+    AutoClose closer(dh);
+    std::vector<char> buffer(chunk);
+    long n;
+    while ((n = dh.read(buffer.data(), chunk)) > 0) {
+        result.append(buffer.data(), n);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Parts are delivered in order, whether prefetched or read when reached") {
+
+    std::vector<std::string> parts;
+    for (size_t i = 0; i < 20; ++i) {
+        // Every fifth part is larger than the prefetch limit
+        parts.push_back(std::string(i % 5 == 0 ? 5000 : 100 + i, char('a' + i)));
+    }
+
+    std::string expected;
+    for (const std::string& p : parts) {
+        expected += p;
+    }
+
+    for (size_t inFlight : {1, 3, 8}) {
+        for (long chunk : {7L, 1000L, 100000L}) {
+
+            std::vector<DataHandle*> handles;
+            for (const std::string& p : parts) {
+                handles.push_back(new MemoryHandle(p.data(), p.size()));
+            }
+
+            fdb5::PrefetchingMultiHandle dh(handles, inFlight, 1024);
+            EXPECT(dh.estimate() == Length(expected.size()));
+            EXPECT(readAll(dh, chunk) == expected);
+        }
+    }
+}
+
+CASE("An error reading a part reaches the consumer") {
+
+    TmpDir tmp;
+
+    std::string first(100, 'x');
+
+    std::vector<DataHandle*> handles;
+    handles.push_back(new MemoryHandle(first.data(), first.size()));
+    handles.push_back((tmp / "missing.data").partHandle(0, 100));
+    handles.push_back(new MemoryHandle(first.data(), first.size()));
+
+    fdb5::PrefetchingMultiHandle dh(handles, 2, 1024);
+
+    EXPECT_THROWS(readAll(dh, 1000));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
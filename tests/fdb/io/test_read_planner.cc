@@ -0,0 +1,186 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/io/HandleGatherer.h"
+#include "fdb5/io/ReadPlanner.h"
+#include "fdb5/toc/TocFieldLocation.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set for this test in CMakeLists.txt
+const size_t threads = 4;
+const long long parallelBytes = 1000000;
+
+fdb5::ReadPlanner::Profile profile(size_t files, long long bytes, size_t seeksOrdered, size_t seeksSorted,
+                                   bool parallelFileSystem = false) {
+    return fdb5::ReadPlanner::Profile{10, files, bytes, seeksOrdered, seeksSorted, parallelFileSystem};
+}
+
+std::string makeFile(const PathName& path, size_t size, char first) {
+    std::string contents;
+    for (size_t i = 0; i < size; ++i) {
+        contents += char(first + (i / 1000) % 26);
+    }
+    FileHandle fh(path);
+    fh.openForWrite(0);
+    AutoClose closer(fh);
+    fh.write(contents.data(), contents.size());
+    return contents;
+}
+
+std::string readAll(DataHandle& dh) {
+    std::string result;
+    dh.openForRead();
+    AutoClose closer(dh);
+    std::vector<char> buffer(65536);
+    long n;
+    while ((n = dh.read(buffer.data(), buffer.size())) > 0) {
+        result.append(buffer.data(), n);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Request order is kept unless sorting is requested, or tolerated and cheaper") {
+
+    // 1000 bytes, 10 discontinuities in request order, 1 when sorted
+    fdb5::ReadPlanner::Profile scattered = profile(1, 1000, 10, 1);
+
+    fdb5::ReadPlanner::Decision d = fdb5::ReadPlanner(false, false).plan(scattered);
+    EXPECT(d.plan_ == fdb5::ReadPlanner::REQUEST_ORDERED);
+    EXPECT(!d.sorted_);
+    EXPECT(d.threads_ == 1);
+
+    d = fdb5::ReadPlanner(true, false).plan(scattered);
+    EXPECT(d.plan_ == fdb5::ReadPlanner::SORTED_MERGED);
+    EXPECT(d.sorted_);
+
+    d = fdb5::ReadPlanner(false, true).plan(scattered);
+    EXPECT(d.plan_ == fdb5::ReadPlanner::SORTED_MERGED);
+    EXPECT(d.sorted_);
+
+    // Sorting saves nothing when the fields are already in file order
+
+    d = fdb5::ReadPlanner(false, true).plan(profile(1, 1000, 1, 1));
+    EXPECT(d.plan_ == fdb5::ReadPlanner::REQUEST_ORDERED);
+    EXPECT(!d.sorted_);
+
+    d = fdb5::ReadPlanner(true, false).plan(profile(1, 1000, 1, 1));
+    EXPECT(d.plan_ == fdb5::ReadPlanner::SORTED_MERGED);
+}
+
+CASE("Parts are read concurrently across files, on parallel filesystems or for enough data") {
+
+    fdb5::ReadPlanner planner(false, false);
+
+    // One file: nothing to read concurrently
+    fdb5::ReadPlanner::Decision d = planner.plan(profile(1, 2 * parallelBytes, 3, 3));
+    EXPECT(d.plan_ == fdb5::ReadPlanner::REQUEST_ORDERED);
+
+    d = planner.plan(profile(3, 2 * parallelBytes, 3, 3));
+    EXPECT(d.plan_ == fdb5::ReadPlanner::PARALLEL_STRIPED);
+    EXPECT(!d.sorted_);
+    EXPECT(d.threads_ == 3);
+
+    d = planner.plan(profile(8, 2 * parallelBytes, 8, 8));
+    EXPECT(d.plan_ == fdb5::ReadPlanner::PARALLEL_STRIPED);
+    EXPECT(d.threads_ == threads);
+
+    // Below fdbReadPlannerParallelBytes, only on a parallel filesystem
+
+    d = planner.plan(profile(3, parallelBytes / 10, 3, 3));
+    EXPECT(d.plan_ == fdb5::ReadPlanner::REQUEST_ORDERED);
+
+    d = planner.plan(profile(3, parallelBytes / 10, 3, 3, true));
+    EXPECT(d.plan_ == fdb5::ReadPlanner::PARALLEL_STRIPED);
+
+    // ... and only if it saves more than the cost of the threads
+    d = planner.plan(profile(3, 10, 3, 3, true));
+    EXPECT(d.plan_ == fdb5::ReadPlanner::REQUEST_ORDERED);
+
+    // Sorting still applies to each part
+    d = fdb5::ReadPlanner(true, false).plan(profile(3, 2 * parallelBytes, 9, 3));
+    EXPECT(d.plan_ == fdb5::ReadPlanner::PARALLEL_STRIPED);
+    EXPECT(d.sorted_);
+
+    std::ostringstream s;
+    s << d;
+    EXPECT(s.str() == "parallel-striped(sorted, 3 threads)");
+}
+
+CASE("Fields read concurrently are delivered in request order") {
+
+    TmpDir tmp;
+
+    const size_t nfiles = 3;
+    const size_t fields = 4;
+    const size_t fieldSize = parallelBytes / (nfiles * fields) + 1000;
+
+    std::vector<PathName> paths;
+    std::vector<std::string> contents;
+    for (size_t f = 0; f < nfiles; ++f) {
+        paths.push_back(tmp / ("data." + std::to_string(f)));
+        contents.push_back(makeFile(paths.back(), fields * fieldSize, char('a' + f)));
+    }
+
+    // Interleaved across the files, and backwards within each of them
+
+    fdb5::HandleGatherer gatherer(false);
+    std::string expected;
+    for (size_t i = fields; i > 0; --i) {
+        for (size_t f = 0; f < nfiles; ++f) {
+            gatherer.add(fdb5::TocFieldLocation(paths[f], (i - 1) * fieldSize, fieldSize, fdb5::Key()));
+            expected += contents[f].substr((i - 1) * fieldSize, fieldSize);
+        }
+    }
+
+    std::unique_ptr<DataHandle> dh(gatherer.dataHandle());
+
+    EXPECT(gatherer.plan().plan_ == fdb5::ReadPlanner::PARALLEL_STRIPED);
+    EXPECT(!gatherer.plan().sorted_);
+    EXPECT(gatherer.plan().threads_ == nfiles);
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < nfiles * fields; ++i) {
+        order.push_back(i);
+    }
+    EXPECT(gatherer.order() == order);
+
+    EXPECT(readAll(*dh) == expected);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
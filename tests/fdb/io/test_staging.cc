@@ -0,0 +1,320 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/runtime/Main.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/LibFdb5.h"
+#include "fdb5/api/FDB.h"
+#include "fdb5/database/Key.h"
+#include "fdb5/io/Crc32c.h"
+#include "fdb5/io/StagingLog.h"
+#include "fdb5/toc/TocFieldLocation.h"
+#include "fdb5/types/TypesRegistry.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// As written by StagingLog before each record
+struct RecordHeader {
+    uint32_t magic_;
+    uint32_t pathLength_;
+    uint64_t offset_;
+    uint64_t length_;
+    uint32_t crc_;
+    uint32_t unused_;
+};
+
+std::string record(const PathName& path, uint64_t offset, const std::string& data, uint32_t magic = 0x46444253) {
+    const std::string& name = path.asString();
+    fdb5::Crc32c crc;
+    crc.update(name.data(), name.size());
+    crc.update(data.data(), data.size());
+    RecordHeader header{magic, uint32_t(name.size()), offset, data.size(), crc.value(), 0};
+    return std::string(reinterpret_cast<const char*>(&header), sizeof(header)) + name + data;
+}
+
+/// An index entry of the database in the directory, as staged by the catalogue given, of the field of
+/// fieldKey("xxxx", param) at the offset in the data file
+std::string entry(const PathName& directory, uint64_t catalogue, const std::string& param, const PathName& data,
+                  uint64_t offset, size_t length) {
+
+    // In the order of the schema
+    std::shared_ptr<fdb5::TypesRegistry> registry = std::make_shared<fdb5::TypesRegistry>();
+
+    fdb5::Key index(registry);
+    index.set("type", "an");
+    index.set("levtype", "pl");
+
+    fdb5::Key datum(registry);
+    datum.set("step", "0");
+    datum.set("levelist", "300");
+    datum.set("param", param);
+
+    unsigned int version = fdb5::RemoteProtocolVersion().latest();
+    fdb5::RemoteProtocolVersion::Streamed streamed(version);
+
+    std::vector<char> buffer(64 * 1024);
+    MemoryStream s(buffer.data(), buffer.size());
+    s << version;
+    s << index;
+    s << datum;
+    s << fdb5::TocFieldLocation(data, offset, length, fdb5::Key());
+
+    return record(directory, catalogue, std::string(buffer.data(), size_t(static_cast<long long>(s.position()))),
+                  0x46444249);
+}
+
+/// The flush of the entries staged by the catalogue
+std::string flushed(uint64_t catalogue) {
+    return record(PathName(""), catalogue, "", 0x46444246);
+}
+
+void writeFile(const PathName& path, const std::string& contents) {
+    FileHandle fh(path);
+    fh.openForWrite(0);
+    AutoClose closer(fh);
+    fh.write(contents.data(), contents.size());
+}
+
+std::string readFile(const PathName& path) {
+    std::string result(path.size(), '\0');
+    FileHandle fh(path);
+    fh.openForRead();
+    AutoClose closer(fh);
+    EXPECT(fh.read(&result[0], result.size()) == long(result.size()));
+    return result;
+}
+
+/// Outlive the staging log, which is only destroyed at exit
+const PathName& stagingDirectory() {
+    static TmpDir dir;
+    return dir;
+}
+
+const PathName& dataDirectory() {
+    static TmpDir dir;
+    return dir;
+}
+
+const PathName& rootDirectory() {
+    static TmpDir dir;
+    return dir;
+}
+
+fdb5::StagingLog& staging() {
+    SetEnv directory("FDB_STAGING_DIRECTORY", stagingDirectory().asString().c_str());
+    return fdb5::StagingLog::instance();
+}
+
+PathName logPath() {
+    return stagingDirectory() / (Main::hostname() + "." + std::to_string(::getpid()) + ".staging");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Runs first, as the logs are only replayed when the staging log of this process is created
+
+CASE("The logs of dead processes are replayed, up to a torn record, and their unflushed entries indexed again") {
+
+    PathName replayed = dataDirectory() / "replayed.data";
+    PathName gone = dataDirectory() / "gone" / "wiped.data";
+    PathName directory = dataDirectory() / "directory";
+    directory.mkdir();
+
+    PathName dead = stagingDirectory() / "dead.1.staging";
+    std::string torn = record(replayed, 10, "lost");
+    writeFile(dead, record(replayed, 0, "hello") + record(gone, 0, "skipped") + record(replayed, 5, "world") +
+                        torn.substr(0, torn.size() - 2));
+
+    // Its target is a directory, which cannot be written to
+    PathName broken = stagingDirectory() / "broken.1.staging";
+    writeFile(broken, record(directory, 0, "never"));
+
+    // Locked by its live process
+    PathName alive = stagingDirectory() / "alive.1.staging";
+    writeFile(alive, record(replayed, 0, "ignored"));
+    int fd = ::open(alive.localPath(), O_RDWR);
+    EXPECT(fd >= 0);
+    EXPECT(::flock(fd, LOCK_EX) == 0);
+
+    // Staged to a database, of which only the second catalogue did not flush its entries. Created by the archive
+    // that creates the staging log, before its data file is opened
+    PathName db = rootDirectory() / "rd:xxxx:oper:20191110:0000:g";
+    PathName indexedData = db / "indexed.data";
+    PathName indexing = stagingDirectory() / "indexing.1.staging";
+    writeFile(indexing, record(indexedData, 0, "flushed") + entry(db, 1, "130", indexedData, 0, 7) + flushed(1) +
+                            record(indexedData, 7, "unflushed") + entry(db, 2, "131", indexedData, 7, 9));
+
+    // Left unnamed by processes that died before locking their logs, on this host and another
+    pid_t child = ::fork();
+    if (child == 0) {
+        ::_exit(0);
+    }
+    EXPECT(::waitpid(child, nullptr, 0) == child);
+    PathName unnamed = stagingDirectory() / (Main::hostname() + "." + std::to_string(child) + ".staging.tmp");
+    writeFile(unnamed, "");
+    PathName elsewhere = stagingDirectory() / ("elsewhere." + std::to_string(child) + ".staging.tmp");
+    writeFile(elsewhere, "");
+
+    fdb5::Config config = makeConfig(rootDirectory());
+    {
+        SetEnv env("FDB_STAGING_DIRECTORY", stagingDirectory().asString().c_str());
+        fdb5::FDB fdb(config);
+        fdb.archive(fieldKey("xxxx", "138"), "archived", 8);
+        fdb.flush();
+    }
+
+    EXPECT(readFile(replayed) == "helloworld");
+    EXPECT(!dead.exists());
+    EXPECT(!gone.dirName().exists());
+
+    EXPECT(!broken.exists());
+    EXPECT(PathName(broken + ".failed").exists());
+
+    EXPECT(alive.exists());
+    ::close(fd);
+
+    EXPECT(!indexing.exists());
+    EXPECT(readFile(indexedData) == "flushedunflushed");
+
+    fdb5::FDB fdb(config);
+    EXPECT(retrieve(fdb, fieldKey("xxxx", "131")) == "unflushed");
+    EXPECT(retrieve(fdb, fieldKey("xxxx", "138")) == "archived");
+
+    // Not indexed again, as flushed before the process died
+    EXPECT(retrieve(fdb, fieldKey("xxxx", "130")) == "");
+
+    EXPECT(!unnamed.exists());
+    EXPECT(elsewhere.exists());
+}
+
+CASE("Staged data is written to the data files, at the offsets returned") {
+
+    fdb5::StagingLog& log = staging();
+
+    PathName a = dataDirectory() / "a.data";
+    PathName b = dataDirectory() / "b.data";
+
+    EXPECT(log.end(a) == Offset(0));
+    EXPECT(log.append(a, "abc", 3) == Offset(0));
+    EXPECT(log.append(b, "xy", 2) == Offset(0));
+    EXPECT(log.append(a, "def", 3) == Offset(3));
+    EXPECT(log.end(a) == Offset(6));
+
+    log.flush(a, true);
+    log.flush(b, false);
+    EXPECT(readFile(a) == "abcdef");
+    EXPECT(readFile(b) == "xy");
+
+    // Caught up
+    EXPECT(logPath().size() == Length(0));
+
+    log.close(a, false);
+    log.close(b, false);
+
+    // Appending to an existing file
+    EXPECT(log.end(a) == Offset(6));
+    EXPECT(log.append(a, "g", 1) == Offset(6));
+    log.close(a, false);
+    EXPECT(readFile(a) == "abcdefg");
+}
+
+// The log holds 4096 bytes, as set for this test in CMakeLists.txt
+
+CASE("Appends wait for the log to be written once it is full") {
+
+    fdb5::StagingLog& log = staging();
+
+    PathName c = dataDirectory() / "c.data";
+
+    std::string expected;
+    for (size_t i = 0; i < 50; ++i) {
+        std::string data(1000, char('a' + i % 26));
+        EXPECT(log.append(c, data.data(), data.size()) == Offset(expected.size()));
+        expected += data;
+    }
+
+    // Larger than the log
+    std::string large(10000, 'z');
+    EXPECT(log.append(c, large.data(), large.size()) == Offset(expected.size()));
+    expected += large;
+
+    log.close(c, false);
+    EXPECT(readFile(c) == expected);
+    EXPECT(logPath().size() == Length(0));
+}
+
+// Runs last, as the log is no longer emptied once writing to a data file has failed
+
+CASE("A data file that cannot be written reports its error, and the log is kept") {
+
+    fdb5::StagingLog& log = staging();
+
+    PathName bad = dataDirectory() / "missing" / "bad.data";
+    PathName good = dataDirectory() / "good.data";
+
+    log.append(bad, "lost", 4);
+    log.append(good, "kept", 4);
+
+    log.flush(good, false);
+    EXPECT_THROWS_AS(log.flush(bad, false), eckit::CantOpenFile);
+    EXPECT_THROWS_AS(log.close(bad, false), eckit::CantOpenFile);
+    EXPECT_THROWS_AS(log.append(bad, "more", 4), eckit::CantOpenFile);
+
+    // Other files are still written
+    log.append(good, "more", 4);
+    log.close(good, false);
+    EXPECT(readFile(good) == "keptmore");
+
+    // With the records of the failed file, to be replayed
+    EXPECT(logPath().size() > Length(0));
+
+    // Until it is full
+    std::string data(1000, 'x');
+    auto fill = [&] {
+        for (size_t i = 0; i < 5; ++i) {
+            log.append(good, data.data(), data.size());
+        }
+    };
+    EXPECT_THROWS_AS(fill(), eckit::WriteError);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
@@ -0,0 +1,162 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/api/helpers/ListIterator.h"
+#include "fdb5/io/StreamingRetrieveHandle.h"
+#include "fdb5/toc/TocFieldLocation.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Lists a fixed sequence of fields
+class VectorIterator : public fdb5::APIIteratorBase<fdb5::ListElement> {
+public:
+    VectorIterator(std::vector<fdb5::ListElement> elements) : elements_(std::move(elements)), next_(0) {}
+
+    bool next(fdb5::ListElement& elem) override {
+        if (next_ == elements_.size()) {
+            return false;
+        }
+        elem = elements_[next_++];
+        return true;
+    }
+
+private:
+    std::vector<fdb5::ListElement> elements_;
+    size_t next_;
+};
+
+/// The fields are 10-byte records of the file, the n-th holding 10 times the letter 'a' + n
+class Fields {
+public:
+    Fields(const PathName& path, size_t count) : path_(path) {
+        std::string contents;
+        for (size_t i = 0; i < count; ++i) {
+            contents += std::string(10, char('a' + i));
+        }
+        FileHandle fh(path_);
+        fh.openForWrite(0);
+        AutoClose closer(fh);
+        fh.write(contents.data(), contents.size());
+    }
+
+    fdb5::ListElement element(const std::string& param, size_t record, time_t timestamp) const {
+        fdb5::Key db;
+        db.set("class", "rd");
+        fdb5::Key index;
+        index.set("type", "an");
+        fdb5::Key datum;
+        datum.set("param", param);
+        auto location = std::make_shared<const fdb5::TocFieldLocation>(path_, record * 10, 10, fdb5::Key());
+        return fdb5::ListElement({db, index, datum}, location, timestamp);
+    }
+
+private:
+    PathName path_;
+};
+
+fdb5::ListIterator listing(std::vector<fdb5::ListElement> elements) {
+    return fdb5::ListIterator(fdb5::APIIterator<fdb5::ListElement>(new VectorIterator(std::move(elements))));
+}
+
+std::string readAll(DataHandle& dh, long chunk) {
+    std::string result;
+    std::vector<char> buffer(chunk);
+    long n;
+    while ((n = dh.read(buffer.data(), chunk)) > 0) {
+        result.append(buffer.data(), n);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Fields are read in listing order, window after window, without knowing the total length") {
+
+    TmpDir tmp;
+    Fields fields(tmp / "data", 5);
+
+    std::vector<fdb5::ListElement> elements;
+    for (size_t i : {3, 0, 4, 1, 2}) {
+        elements.push_back(fields.element(std::to_string(i), i, 0));
+    }
+
+    for (long chunk : {1, 7, 10, 64}) {
+        fdb5::StreamingRetrieveHandle dh(listing(elements), false, 2, false);
+        EXPECT(dh.estimate() == Length(0));
+        EXPECT(dh.openForRead() == Length(fdb5::StreamingRetrieveHandle::unknownLength));
+        AutoClose closer(dh);
+
+        EXPECT(readAll(dh, chunk) == std::string(10, 'd') + std::string(10, 'a') + std::string(10, 'e') +
+                                         std::string(10, 'b') + std::string(10, 'c'));
+    }
+}
+
+CASE("When deduplicating, the newest field of a key wins wherever it is listed") {
+
+    TmpDir tmp;
+    Fields fields(tmp / "data", 5);
+
+    // With windows of 2 fields, the newer 130 comes in the second window and the older 131 in the third
+
+    std::vector<fdb5::ListElement> elements{
+        fields.element("130", 0, 100),
+        fields.element("131", 1, 200),
+        fields.element("130", 2, 300),
+        fields.element("132", 3, 100),
+        fields.element("131", 4, 100),
+    };
+
+    fdb5::StreamingRetrieveHandle dh(listing(elements), false, 2, true);
+    EXPECT(dh.openForRead() == Length(30));
+    EXPECT(dh.estimate() == Length(30));
+    AutoClose closer(dh);
+
+    EXPECT(readAll(dh, 64) == std::string(10, 'c') + std::string(10, 'b') + std::string(10, 'd'));
+}
+
+CASE("An empty listing reads nothing") {
+
+    fdb5::StreamingRetrieveHandle plain(listing({}), true, 4, false);
+    plain.openForRead();
+    char c;
+    EXPECT(plain.read(&c, 1) == 0);
+    plain.close();
+
+    fdb5::StreamingRetrieveHandle deduplicated(listing({}), true, 4, true);
+    EXPECT(deduplicated.openForRead() == Length(0));
+    EXPECT(deduplicated.read(&c, 1) == 0);
+    deduplicated.close();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
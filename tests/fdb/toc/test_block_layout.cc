@@ -0,0 +1,144 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/api/helpers/FDBToolRequest.h"
+#include "fdb5/io/BlockPartFileHandle.h"
+#include "fdb5/toc/TocFieldLocation.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Merged parts are sliced from whole blocks") {
+
+    TmpDir tmp;
+    PathName path = tmp / "blocks.data";
+
+    std::string contents;
+    for (int i = 0; i < 3000; ++i) {
+        contents += char('a' + i % 26);
+    }
+
+    {
+        FileHandle fh(path);
+        fh.openForWrite(0);
+        AutoClose closer(fh);
+        fh.write(contents.data(), contents.size());
+    }
+
+    std::unique_ptr<DataHandle> dh(new fdb5::BlockPartFileHandle(path, 2000, 500, 1024));
+    fdb5::BlockPartFileHandle second(path, 10, 100, 1024);
+
+    EXPECT(dh->merge(&second));
+    EXPECT(!dh->moveable());
+
+    // Parts are returned in request order, unless compressed into file order
+
+    EXPECT(readAll(*dh) == contents.substr(2000, 500) + contents.substr(10, 100));
+
+    EXPECT(dh->compress(true));
+    EXPECT(readAll(*dh) == contents.substr(10, 100) + contents.substr(2000, 500));
+}
+
+CASE("Fields are laid out in blocks, and read with the block size recorded in their location") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+
+    const size_t blockSize = 4096;
+
+    // The block size is only configured for this FDB, not through fdbDataBlockSize
+
+    fdb5::Config config = makeConfig(root, "dataBlockSize: 4096\n");
+
+    std::map<std::string, std::string> fields;
+    fields["138"] = std::string(3000, '1');
+    fields["155"] = std::string(3000, '2');
+    fields["130"] = std::string(10000, '3');
+
+    {
+        fdb5::FDB fdb(config);
+        for (const auto& kv : fields) {
+            fdb.archive(fieldKey("xxxx", kv.first), kv.second.data(), kv.second.size());
+        }
+        fdb.flush();
+    }
+
+    fdb5::FDB fdb(config);
+
+    size_t count = 0;
+    auto it = fdb.list(fdb5::FDBToolRequest::requestsFromString("class=rd,expver=xxxx")[0], true);
+    fdb5::ListElement elem;
+    while (it.next(elem)) {
+        const fdb5::TocFieldLocation* loc = dynamic_cast<const fdb5::TocFieldLocation*>(&elem.location());
+        EXPECT(loc);
+        EXPECT(loc->blockSize() == blockSize);
+
+        unsigned long long offset = static_cast<long long>(loc->offset());
+        unsigned long long length = static_cast<long long>(loc->length());
+        if (length <= blockSize) {
+            // Small fields do not straddle a block boundary
+            EXPECT(offset / blockSize == (offset + length - 1) / blockSize);
+            std::unique_ptr<DataHandle> dh(loc->dataHandle());
+            EXPECT(dynamic_cast<fdb5::BlockPartFileHandle*>(dh.get()));
+        }
+        else {
+            EXPECT(offset % blockSize == 0);
+        }
+        count++;
+    }
+    EXPECT(count == fields.size());
+
+    // Retrieval finds the fields through the indexes, which must give back the block size
+
+    for (const auto& kv : fields) {
+        auto found = fdb.inspect(fieldKey("xxxx", kv.first).request());
+        EXPECT(found.next(elem));
+        const fdb5::TocFieldLocation* loc = dynamic_cast<const fdb5::TocFieldLocation*>(&elem.location());
+        EXPECT(loc);
+        EXPECT(loc->blockSize() == blockSize);
+        if (kv.second.size() <= blockSize) {
+            std::unique_ptr<DataHandle> dh(loc->dataHandle());
+            EXPECT(dynamic_cast<fdb5::BlockPartFileHandle*>(dh.get()));
+        }
+
+        EXPECT(retrieve(fdb, fieldKey("xxxx", kv.first)) == kv.second);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
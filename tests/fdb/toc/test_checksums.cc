@@ -0,0 +1,130 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/LibFdb5.h"
+#include "fdb5/io/ChecksumCheckingHandle.h"
+#include "fdb5/io/Crc32c.h"
+#include "fdb5/toc/TocFieldLocation.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("crc32c matches the reference check value") {
+
+    const char* data = "123456789";
+
+    EXPECT(fdb5::Crc32c::compute(data, ::strlen(data)) == 0xE3069283u);
+    EXPECT(fdb5::Crc32c::compute(data, 0) == 0u);
+}
+
+CASE("crc32c is independent of how the data is split") {
+
+    std::string data;
+    for (int i = 0; i < 1000; ++i) {
+        data += char(i * 7 + 3);
+    }
+
+    fdb5::Crc32c crc;
+    crc.update(data.data(), 1);
+    crc.update(data.data() + 1, 12);
+    crc.update(data.data() + 13, data.size() - 13);
+
+    EXPECT(crc.value() == fdb5::Crc32c::compute(data.data(), data.size()));
+}
+
+CASE("checksum survives encoding the location") {
+
+    fdb5::TocFieldLocation loc(PathName("/a/b/c.data"), 1024, 512, fdb5::Key());
+    loc.checksum(0xDEADBEEF);
+
+    Buffer buffer(4096);
+    MemoryStream out(buffer.data(), buffer.size());
+    out << loc;
+
+    MemoryStream in(buffer.data(), buffer.size());
+    std::unique_ptr<fdb5::FieldLocation> decoded(Reanimator<fdb5::FieldLocation>::reanimate(in));
+
+    uint32_t crc = 0;
+    EXPECT(decoded->recordedChecksum(crc));
+    EXPECT(crc == 0xDEADBEEFu);
+    EXPECT(decoded->offset() == Offset(1024));
+    EXPECT(decoded->length() == Length(512));
+
+    fdb5::TocFieldLocation plain(PathName("/a/b/c.data"), 0, 512, fdb5::Key());
+
+    MemoryStream out2(buffer.data(), buffer.size());
+    out2 << plain;
+
+    MemoryStream in2(buffer.data(), buffer.size());
+    std::unique_ptr<fdb5::FieldLocation> decoded2(Reanimator<fdb5::FieldLocation>::reanimate(in2));
+    EXPECT(!decoded2->recordedChecksum(crc));
+
+    // Not streamed to and from peers of remote protocol version 3
+
+    fdb5::RemoteProtocolVersion::Streamed streamed(3);
+
+    MemoryStream out3(buffer.data(), buffer.size());
+    out3 << loc;
+
+    MemoryStream in3(buffer.data(), buffer.size());
+    std::unique_ptr<fdb5::FieldLocation> decoded3(Reanimator<fdb5::FieldLocation>::reanimate(in3));
+    EXPECT(!decoded3->recordedChecksum(crc));
+    EXPECT(decoded3->offset() == Offset(1024));
+    EXPECT(decoded3->length() == Length(512));
+}
+
+CASE("corrupted data is detected on read") {
+
+    std::string data(4096, 'a');
+    uint32_t crc = fdb5::Crc32c::compute(data.data(), data.size());
+
+    Buffer result(data.size());
+
+    {
+        fdb5::ChecksumCheckingHandle dh(new MemoryHandle(data.data(), data.size()), crc);
+        dh.openForRead();
+        EXPECT(dh.read(result.data(), result.size()) == long(data.size()));
+        dh.close();
+    }
+
+    data[100] = 'b';
+
+    {
+        fdb5::ChecksumCheckingHandle dh(new MemoryHandle(data.data(), data.size()), crc);
+        dh.openForRead();
+        EXPECT_THROWS_AS(dh.read(result.data(), result.size()), ReadError);
+        dh.close();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
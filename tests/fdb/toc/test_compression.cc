@@ -0,0 +1,195 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+#include "eckit/utils/Compressor.h"
+
+#include "metkit/mars/MarsRequest.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/api/helpers/FDBToolRequest.h"
+#include "fdb5/io/CompressedPartFileHandle.h"
+#include "fdb5/toc/TocFieldLocation.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Run-length encoding, so that the tests do not depend on which optional codecs eckit was built with
+
+class RunLengthCompressor : public Compressor {
+public:
+    size_t compress(const void* in, size_t len, Buffer& out) const override {
+        const unsigned char* p = static_cast<const unsigned char*>(in);
+        std::vector<unsigned char> result;
+        for (size_t i = 0; i < len;) {
+            size_t run = 1;
+            while (i + run < len && run < 255 && p[i + run] == p[i]) {
+                run++;
+            }
+            result.push_back(run);
+            result.push_back(p[i]);
+            i += run;
+        }
+        if (out.size() < result.size()) {
+            out.resize(result.size());
+        }
+        ::memcpy(out.data(), result.data(), result.size());
+        return result.size();
+    }
+
+    void uncompress(const void* in, size_t len, Buffer& out, size_t outlen) const override {
+        const unsigned char* p = static_cast<const unsigned char*>(in);
+        if (out.size() < outlen) {
+            out.resize(outlen);
+        }
+        unsigned char* o = static_cast<unsigned char*>(out.data());
+        size_t pos = 0;
+        for (size_t i = 0; i + 1 < len; i += 2) {
+            ::memset(o + pos, p[i + 1], p[i]);
+            pos += p[i];
+        }
+        EXPECT(pos == outlen);
+    }
+};
+
+static CompressorBuilder<RunLengthCompressor> rle("test-rle");
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Compressed and raw parts of one file merge into a single handle") {
+
+    TmpDir tmp;
+    PathName path = tmp / "parts.data.test-rle";
+
+    RunLengthCompressor compressor;
+
+    std::string compressible(1000, 'a');
+    std::string raw = "abcdefgh";
+
+    Buffer out(0);
+    size_t compressedLength;
+    const void* payload1 = fdb5::CompressedPartFileHandle::compress(compressor, compressible.data(), compressible.size(),
+                                                                    out, compressedLength);
+    EXPECT(compressedLength < compressible.size());
+
+    {
+        FileHandle fh(path);
+        fh.openForWrite(0);
+        AutoClose closer(fh);
+        fh.write(payload1, compressedLength);
+
+        Buffer out2(0);
+        size_t rawLength;
+        const void* payload2 = fdb5::CompressedPartFileHandle::compress(compressor, raw.data(), raw.size(), out2, rawLength);
+        // Does not compress, so it is stored as is
+        EXPECT(rawLength == raw.size());
+        EXPECT(payload2 == raw.data());
+        fh.write(payload2, rawLength);
+    }
+
+    std::unique_ptr<DataHandle> dh(
+        new fdb5::CompressedPartFileHandle(path, 0, compressedLength, compressible.size(), "test-rle"));
+    fdb5::CompressedPartFileHandle second(path, compressedLength, raw.size(), raw.size(), "test-rle");
+
+    EXPECT(dh->merge(&second));
+    EXPECT(!dh->moveable());
+    EXPECT(dh->estimate() == Length(compressible.size() + raw.size()));
+
+    EXPECT(readAll(*dh) == compressible + raw);
+
+    // Seek into the second part
+
+    dh->openForRead();
+    AutoClose closer(*dh);
+    dh->seek(compressible.size() + 2);
+    char buf[6];
+    EXPECT(dh->read(buf, sizeof(buf)) == long(sizeof(buf)));
+    EXPECT(std::string(buf, sizeof(buf)) == raw.substr(2));
+}
+
+CASE("Compressed fields are indexed at their own size, and retrieved uncompressed") {
+
+    TmpDir tmp;
+    PathName root = tmp / "root";
+    root.mkdir();
+
+    fdb5::Config config = makeConfig(root, "dataCompression: test-rle\n");
+
+    std::string data1(4096, 'x');
+    std::string data2 = std::string(2048, 'y') + std::string(2048, 'z');
+
+    {
+        fdb5::FDB fdb(config);
+        fdb.archive(fieldKey("xxxx", "138"), data1.data(), data1.size());
+        fdb.archive(fieldKey("xxxx", "155"), data2.data(), data2.size());
+        fdb.flush();
+    }
+
+    fdb5::FDB fdb(config);
+
+    size_t count = 0;
+    auto it = fdb.list(fdb5::FDBToolRequest::requestsFromString("class=rd,expver=xxxx")[0], true);
+    fdb5::ListElement elem;
+    while (it.next(elem)) {
+        const fdb5::TocFieldLocation* loc = dynamic_cast<const fdb5::TocFieldLocation*>(&elem.location());
+        EXPECT(loc);
+        EXPECT(loc->codec() == "test-rle");
+        EXPECT(loc->length() == Length(4096));
+        EXPECT(loc->storedLength() < loc->length());
+        EXPECT(loc->uri().path().size() < Length(data1.size() + data2.size()));
+        count++;
+    }
+    EXPECT(count == 2);
+
+    // Retrieval finds the fields through the indexes, which must give back how they were compressed
+
+    auto found = fdb.inspect(fieldKey("xxxx", "138").request());
+    EXPECT(found.next(elem));
+    const fdb5::TocFieldLocation* loc = dynamic_cast<const fdb5::TocFieldLocation*>(&elem.location());
+    EXPECT(loc);
+    EXPECT(loc->codec() == "test-rle");
+    EXPECT(loc->storedLength() < loc->length());
+
+    EXPECT(retrieve(fdb, fieldKey("xxxx", "138")) == data1);
+    EXPECT(retrieve(fdb, fieldKey("xxxx", "155")) == data2);
+
+    const metkit::mars::MarsRequest both = fdb5::FDBToolRequest::requestsFromString(
+        "class=rd,expver=xxxx,stream=oper,date=20191110,time=0000,domain=g,type=an,levtype=pl,"
+        "step=0,levelist=300,param=138/155")[0].request();
+    std::unique_ptr<DataHandle> dh(fdb.retrieve(both));
+    EXPECT(readAll(*dh) == data1 + data2);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}
@@ -0,0 +1,165 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <vector>
+
+#include "eckit/config/YAMLConfiguration.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/testing/Test.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/api/helpers/FDBToolRequest.h"
+#include "fdb5/config/Config.h"
+
+#include "../LocalFdb.h"
+
+using namespace eckit::testing;
+using namespace eckit;
+
+namespace fdb {
+namespace test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+fdb5::Key typedKey(const std::string& type, const std::string& param) {
+    fdb5::Key key = fieldKey("xxxx", param);
+    key.set("type", type);
+    return key;
+}
+
+size_t countDataFiles(const PathName& root) {
+    size_t count = 0;
+    std::vector<PathName> dbs;
+    std::vector<PathName> files;
+    root.children(files, dbs);
+    for (const PathName& db : dbs) {
+        std::vector<PathName> dataFiles;
+        std::vector<PathName> dirs;
+        db.children(dataFiles, dirs);
+        for (const PathName& f : dataFiles) {
+            if (f.extension() == ".data") {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Data files of one DB are striped over both roots, and wiped from both") {
+
+    TmpDir tmp;
+    PathName root1 = tmp / "root1";
+    PathName root2 = tmp / "root2";
+    root1.mkdir();
+    root2.mkdir();
+
+    fdb5::Config config = makeConfig(std::vector<PathName>{root1, root2}, "dataStriping: round-robin\n");
+
+    const std::string data = "striped field";
+
+    {
+        fdb5::FDB fdb(config);
+        // Each index (type) gets its own data file, placed round-robin
+        for (const char* type : {"an", "fc", "4v", "cf"}) {
+            fdb.archive(typedKey(type, "138"), data.c_str(), data.size());
+            fdb.archive(typedKey(type, "155"), data.c_str(), data.size());
+        }
+        fdb.flush();
+    }
+
+    EXPECT(countDataFiles(root1) > 0);
+    EXPECT(countDataFiles(root2) > 0);
+    EXPECT(countDataFiles(root1) + countDataFiles(root2) == 4);
+
+    {
+        fdb5::FDB fdb(config);
+        auto it = fdb.wipe(fdb5::FDBToolRequest::requestsFromString("class=rd,expver=xxxx")[0], true);
+        fdb5::WipeElement elem;
+        while (it.next(elem)) {
+            Log::info() << elem << std::endl;
+        }
+    }
+
+    // Neither the DB directory nor its stripe directory on the other root is left behind
+
+    std::vector<PathName> files;
+    std::vector<PathName> dirs;
+    root1.children(files, dirs);
+    root2.children(files, dirs);
+    EXPECT(files.empty());
+    EXPECT(dirs.empty());
+}
+
+CASE("A DB of the same name under another root is not taken for a stripe directory, nor wiped") {
+
+    TmpDir tmp;
+    PathName root1 = tmp / "root1";
+    PathName root2 = tmp / "root2";
+    root1.mkdir();
+    root2.mkdir();
+
+    // The second root is known to this FDB, but neither listed nor archived to, so it does not see the copy there
+
+    std::string yaml = "---\n"
+                       "type: local\n"
+                       "engine: toc\n"
+                       "dataStriping: round-robin\n"
+                       "spaces:\n"
+                       "- roots:\n"
+                       "  - path: " + root1.asString() + "\n"
+                       "  - path: " + root2.asString() + "\n"
+                       "    list: false\n"
+                       "    archive: false\n";
+    fdb5::Config config = fdb5::Config(YAMLConfiguration(yaml)).expandConfig();
+    fdb5::Config other = makeConfig(root2);
+
+    const std::string data = "field";
+
+    for (const fdb5::Config& c : {config, other}) {
+        fdb5::FDB fdb(c);
+        fdb.archive(fieldKey("xxxx", "138"), data.c_str(), data.size());
+        fdb.flush();
+    }
+
+    EXPECT(countDataFiles(root1) == 1);
+    EXPECT(countDataFiles(root2) == 1);
+
+    {
+        fdb5::FDB fdb(config);
+        auto it = fdb.wipe(fdb5::FDBToolRequest::requestsFromString("class=rd,expver=xxxx")[0], true);
+        fdb5::WipeElement elem;
+        while (it.next(elem)) {
+            Log::info() << elem << std::endl;
+        }
+    }
+
+    std::vector<PathName> files;
+    std::vector<PathName> dirs;
+    root1.children(files, dirs);
+    EXPECT(dirs.empty());
+
+    EXPECT(countDataFiles(root2) == 1);
+    fdb5::FDB fdb(other);
+    EXPECT(retrieve(fdb, fieldKey("xxxx", "138")) == data);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace fdb
+
+int main(int argc, char **argv)
+{
+    return run_tests ( argc, argv );
+}